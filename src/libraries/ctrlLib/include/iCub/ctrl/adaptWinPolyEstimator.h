@@ -26,6 +26,7 @@
 #define __ADAPTWINPOLYESTIMATOR_H__
 
 #include <deque>
+#include <vector>
 
 #include <yarp/sig/Vector.h>
 #include <iCub/ctrl/math.h>
@@ -69,11 +70,22 @@ typedef std::deque<AWPolyElement> AWPolyList;
 *
 * Adaptive window polynomial fitting. 
 * Abstract class. 
+*  
+* The last N elements are kept in a ring. At each step the 
+* regressor's moments are accumulated from the newest sample 
+* backward, so that every candidate window is fitted by solving 
+* a small normal system instead of computing a pseudo-inverse. 
 */
 class AWPolyEstimator
 {
 protected:
     AWPolyList elemList;
+    std::vector<double> times;
+    std::vector<double> samples;
+    size_t head;
+    size_t count;
+    size_t dim;
+
     unsigned int order;
     unsigned int N;
     double D;
@@ -84,8 +96,25 @@ protected:
     yarp::sig::Vector winLen;
     yarp::sig::Vector mse;
 
+    std::vector<double> basis;
+    std::vector<double> gram;
+    std::vector<double> factors;
+    std::vector<int> factored;
+    std::vector<double> moments;
+    std::vector<double> solution;
+    std::vector<double> scale;
+
     bool firstRun;
 
+    /**
+    * Find the regressor which best fits in least square sense the 
+    * last n samples of the current window, starting from the 
+    * moments accumulated over them. 
+    * @param n the number of samples the moments refer to. 
+    * @return true if the normal system could be solved. 
+    */ 
+    bool fitMoments(const unsigned int n);
+
     /**
     * Find the regressor which best fits in least square sense the 
     * last n data sample couples, or all couples if n==0. 
@@ -93,6 +122,10 @@ protected:
     * @param y vector containing the output data.
     * @param n last n data sample couples to fit.
     * @return the regressor's coefficients.
+    * @note estimate() fits the windows through the moments and 
+    *       resorts to this method only if their normal system 
+    *       cannot be solved: redefining it in a derived class 
+    *       affects only that fallback.
     */ 
     virtual yarp::sig::Vector fit(const yarp::sig::Vector &x,
                                   const yarp::sig::Vector &y, const unsigned int n=0);
@@ -123,9 +156,12 @@ public:
 
     /**
     * Return a reference to internal elements list.
-    * @return reference to internal elements list.
+    * @return reference to internal elements list, the oldest 
+    *         element first.
+    * @note the list is rebuilt from the internal ring at each 
+    *       call, hence it cannot be used to alter the data fed.
     */
-    AWPolyList &getList() { return elemList; }
+    const AWPolyList &getList();
 
     /**
     * Feed data into the algorithm.
@@ -184,13 +220,6 @@ public:
 class AWLinEstimator : public AWPolyEstimator
 {
 protected:
-    /** 
-     * Redefine method to improve computation just for first-order 
-     * estimator. 
-     */
-    virtual yarp::sig::Vector fit(const yarp::sig::Vector &x,
-                                  const yarp::sig::Vector &y, const unsigned int n=0);
-
     virtual double getEsteeme() { return coeff[1]; }
 
 public:
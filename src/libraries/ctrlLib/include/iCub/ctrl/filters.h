@@ -23,6 +23,7 @@
 #define __FILTERS_H__
 
 #include <deque>
+#include <vector>
 
 #include <yarp/sig/Vector.h>
 #include <iCub/ctrl/math.h>
@@ -72,6 +73,12 @@ public:
 * \ingroup Filters
 *
 * IIR and FIR.
+*
+* The past inputs and outputs are kept in circular buffers of 
+* m-1 and n-1 slots, each slot storing all the channels 
+* contiguously: a sample is filtered without any allocation and 
+* the difference equation runs over contiguous arrays of 
+* channels, which the compiler can vectorize.
 */
 class Filter : public IFilter
 {
@@ -80,11 +87,15 @@ protected:
    yarp::sig::Vector a;
    yarp::sig::Vector y;
 
-   std::deque<yarp::sig::Vector> uold;
-   std::deque<yarp::sig::Vector> yold;
+   std::vector<double> ubuf;
+   std::vector<double> ybuf;
+   size_t uhead;
+   size_t yhead;
    size_t n;
    size_t m;
 
+   void resizeStates(const size_t channels);
+
 public:
    /**
    * Creates a filter with specified numerator and denominator 
@@ -314,16 +325,28 @@ public:
 * \ingroup Filters
 *
 * Median Filter
+*
+* The median is taken over the last n+1 input samples. Each 
+* channel keeps its window in a ring, ordered by two heaps of 
+* ring slots (the lower half in a max-heap, the upper half in a 
+* min-heap), so that every new sample replaces the oldest one 
+* in O(log n) without heap allocations.
 */
 class MedianFilter : public IFilter
 {
 protected:
-   std::deque<std::deque<double> > uold;
+   std::vector<double> uwin;
+   std::vector<size_t> heaps;
+   std::vector<size_t> where;
    yarp::sig::Vector y;
+   size_t head;
+   size_t count;
    size_t n;
    size_t m;
 
-   double median(std::deque<double>& v);
+   void buildHeaps(const size_t channel);
+   void replace(const size_t channel, const size_t slot, const double u);
+   double median(const size_t channel) const;
 
 public:
    /**
@@ -25,13 +25,23 @@ using namespace iCub::ctrl;
 
 /***************************************************************************/
 AWPolyEstimator::AWPolyEstimator(unsigned int _order, unsigned int _N, const double _D) : 
-                                 order(_order), N(_N), D(_D)
+                                 head(0), count(0), dim(0), order(_order), N(_N), D(_D)
 {
     order=std::max(order,1U);
     coeff.resize(order+1);
     N=N<=order ? N+1 : N;
     t.resize(N);
     x.resize(N);
+    times.resize(N);
+
+    size_t P=order+1;
+    basis.resize(N*P);
+    gram.resize(N*P*(P+1)/2);
+    factors.resize(N*P*P);
+    factored.resize(N);
+    moments.resize(P);
+    solution.resize(P);
+    scale.resize(P);
 
     firstRun=true;
 }
@@ -41,10 +51,11 @@ AWPolyEstimator::AWPolyEstimator(unsigned int _order, unsigned int _N, const dou
 double AWPolyEstimator::eval(double x)
 {
     double y=coeff[0];
+    double p=x;
     for (unsigned int i=1; i<=order; i++)
     {
-        y+=coeff[i]*x;
-        x*=x;
+        y+=coeff[i]*p;
+        p*=x;
     }
 
     return y;
@@ -70,13 +81,14 @@ Vector AWPolyEstimator::fit(const Vector &x, const Vector &y, const unsigned int
     for (unsigned int i=i1; i<i2; i++)
     {
         double _x=x[i];
+        double p=_x;
 
         R(i-i1,0)=1.0;
 
         for (unsigned int j=1; j<=order; j++)
         {
-            R(i-i1,j)=_x;
-            _x*=_x;
+            R(i-i1,j)=p;
+            p*=_x;
         }
 
         _y[i-i1]=y[i];
@@ -89,19 +101,123 @@ Vector AWPolyEstimator::fit(const Vector &x, const Vector &y, const unsigned int
 }
 
 
+/***************************************************************************/
+bool AWPolyEstimator::fitMoments(const unsigned int n)
+{
+    size_t P=order+1;
+    double *L=&factors[(n-1)*P*P];
+
+    // the normal matrix depends only on the time vector:
+    // it is factorized once per window length and shared
+    if (factored[n-1]==0)
+    {
+        const double *g=&gram[(n-1)*P*(P+1)/2];
+        factored[n-1]=1;
+
+        // Cholesky factorization: L is stored in the lower triangle
+        // with reciprocal diagonal, the upper one holds the normal matrix
+        for (size_t i=0, k=0; i<P; i++)
+            for (size_t j=i; j<P; j++, k++)
+                L[i*P+j]=g[k];
+
+        for (size_t j=0; j<P; j++)
+        {
+            double d=L[j*P+j];
+            for (size_t k=0; k<j; k++)
+                d-=L[j*P+k]*L[j*P+k];
+
+            if (d<=0.0)
+            {
+                factored[n-1]=-1;
+                break;
+            }
+
+            L[j*P+j]=1.0/sqrt(d);
+            for (size_t i=j+1; i<P; i++)
+            {
+                double l=L[j*P+i];
+                for (size_t k=0; k<j; k++)
+                    l-=L[i*P+k]*L[j*P+k];
+                L[i*P+j]=l*L[j*P+j];
+            }
+        }
+    }
+
+    if (factored[n-1]<0)
+        return false;
+
+    double *c=solution.data();
+    for (size_t i=0; i<P; i++)
+    {
+        double z=moments[i];
+        for (size_t k=0; k<i; k++)
+            z-=L[i*P+k]*c[k];
+        c[i]=z*L[i*P+i];
+    }
+
+    for (size_t i=P; i-->0;)
+    {
+        double z=c[i];
+        for (size_t k=i+1; k<P; k++)
+            z-=L[k*P+i]*c[k];
+        c[i]=z*L[i*P+i];
+    }
+
+    // back to the unscaled time
+    for (size_t i=0; i<P; i++)
+        coeff[i]=c[i]*scale[i];
+
+    return true;
+}
+
+
 /***************************************************************************/
 void AWPolyEstimator::feedData(const AWPolyElement &el)
 {
-    elemList.push_back(el);
+    if (count==0)
+    {
+        dim=el.data.length();
+        samples.assign(dim*N,0.0);
+        head=0;
+    }
+
+    yAssert(el.data.length()==dim);
+
+    // the oldest element gets overwritten once the ring is full
+    size_t slot=(head+count)%N;
+    if (count<N)
+        count++;
+    else
+        head=(head+1<N?head+1:0);
+
+    times[slot]=el.time;
+    for (size_t i=0; i<dim; i++)
+        samples[i*N+slot]=el.data[i];
+}
+
+
+/***************************************************************************/
+const AWPolyList &AWPolyEstimator::getList()
+{
+    elemList.clear();
+    for (size_t j=0; j<count; j++)
+    {
+        size_t slot=(head+j)%N;
+        AWPolyElement el(Vector(dim),times[slot]);
+        for (size_t i=0; i<dim; i++)
+            el.data[i]=samples[i*N+slot];
+        elemList.push_back(el);
+    }
+
+    return elemList;
 }
 
 
 /***************************************************************************/
 Vector AWPolyEstimator::estimate()
 {
-    yAssert(elemList.size()>0);
+    yAssert(count>0);
 
-    size_t dim=elemList[0].data.length();
     Vector esteem(dim,0.0);
 
     if (firstRun)
@@ -111,10 +227,7 @@ Vector AWPolyEstimator::estimate()
         firstRun=false;
     }    
 
-    size_t L=elemList.size();
-    int delta=(int)L-(int)N;
-
-    if (delta<0)
+    if (count<N)
         return esteem;
 
     // retrieve the time vector
@@ -122,7 +235,7 @@ Vector AWPolyEstimator::estimate()
     t[0]=0.0;
     for (unsigned int j=1; j<N; j++)
     {
-        t[j]=elemList[delta+j].time-elemList[delta].time;
+        t[j]=times[(head+j)%N]-times[head];
 
         // enforce condition on time vector
         if (t[j]<=0.0)
@@ -132,22 +245,79 @@ Vector AWPolyEstimator::estimate()
         }
     }
 
+    // the regressors are built on the time scaled to [0,1]
+    size_t P=order+1;
+    size_t Q=P*(P+1)/2;
+    double s=1.0/t[N-1];
+    double sc=s;
+    scale[0]=1.0;
+    for (size_t i=1; i<P; i++)
+    {
+        scale[i]=sc;
+        sc*=s;
+    }
+
+    for (unsigned int k=0; k<N; k++)
+    {
+        double *phi=&basis[k*P];
+        double tau=t[k]/t[N-1];
+        double p=tau;
+        phi[0]=1.0;
+        for (size_t i=1; i<P; i++)
+        {
+            phi[i]=p;
+            p*=tau;
+        }
+    }
+
+    // normal matrices of the last n samples, for all n,
+    // shared among the elements and factorized on demand
+    std::fill(factored.begin(),factored.end(),0);
+    for (unsigned int n=1; n<=N; n++)
+    {
+        const double *phi=&basis[(N-n)*P];
+        double *g=&gram[(n-1)*Q];
+        for (size_t i=0, k=0; i<P; i++)
+        {
+            for (size_t j=i; j<P; j++, k++)
+            {
+                g[k]=phi[i]*phi[j];
+                if (n>1)
+                    g[k]+=g[k-Q];
+            }
+        }
+    }
+
     // cycle upon all elements
     for (unsigned int i=0; i<dim; i++)
     {
         // retrieve the data vector
-        for (unsigned int j=0; j<N; j++)
-            x[j]=elemList[delta+j].data[i];
+        const double *data=&samples[i*N];
+        std::copy(data+head,data+N,x.data());
+        std::copy(data,data+head,x.data()+(N-head));
 
         // change the window length of two units, back and forth
         unsigned int n1=(unsigned int)((winLen[i]>(order+1))?(winLen[i]-1):(order+1));
         unsigned int n2=(unsigned int)((winLen[i]<N)?(winLen[i]+1):N);
 
+        // moments of the samples within the window,
+        // extended backward as the window grows
+        std::fill(moments.begin(),moments.end(),0.0);
+        unsigned int first=N;
+
         // cycle upon all possibile window's length
         for (unsigned int n=n1; n<=n2; n++)
         {
+            for (; N-first<n; first--)
+            {
+                const double *phi=&basis[(first-1)*P];
+                for (size_t j=0; j<P; j++)
+                    moments[j]+=phi[j]*x[first-1];
+            }
+
             // find the regressor's coefficients
-            coeff=fit(t,x,n);
+            if (!fitMoments(n))
+                coeff=fit(t,x,n);
             bool _stop=false;            
 
             // test the regressor upon all the elements
@@ -173,10 +343,6 @@ Vector AWPolyEstimator::estimate()
         esteem[i]=getEsteeme();
     }
 
-    int margin=delta-10;
-    if (margin>0)
-        elemList.erase(elemList.begin(),elemList.begin()+margin);
-
     return esteem;
 }
 
@@ -192,52 +358,10 @@ Vector AWPolyEstimator::estimate(const AWPolyElement &el)
 /***************************************************************************/
 void AWPolyEstimator::reset()
 {
-    if (elemList.size()>0)
+    if (count>0)
     {
-        winLen.resize(elemList[0].data.length(),N);
-        elemList.clear();
-    }
-}
-
-
-/***************************************************************************/
-Vector AWLinEstimator::fit(const Vector &x, const Vector &y, const unsigned int n)
-{
-    unsigned int i1=0;
-    unsigned int i2=(unsigned int)std::min(x.length(),y.length());
-    unsigned int M=i2;
-
-    if (n>0)
-    {
-        i1=i2-n;
-        M=n;
-    }
-
-    double sum_xi  =0.0;
-    double sum_xixi=0.0;
-    double sum_yi  =0.0;
-    double sum_xiyi=0.0;
-
-    for (unsigned int i=i1; i<i2; i++)
-    {
-        sum_xi  +=x[i];
-        sum_xixi+=x[i]*x[i];
-        sum_yi  +=y[i];
-        sum_xiyi+=x[i]*y[i];
+        winLen.resize(dim,N);
+        head=count=0;
     }
-
-    double den=M*sum_xixi-sum_xi*sum_xi;
-
-    Vector c(2);
-
-    // the bias
-    c[0]=(sum_yi*sum_xixi-sum_xi*sum_xiyi) / den;
-
-    // the linear coefficient
-    c[1]=(M*sum_xiyi-sum_xi*sum_yi) / den;
-
-    return c;
 }
 
-
-
@@ -31,20 +31,27 @@ Filter::Filter(const Vector &num, const Vector &den, const Vector &y0)
     m=b.length(); n=a.length();
     yAssert((m>0)&&(n>0));
 
-    uold.insert(uold.begin(),m-1,zeros((int)y0.length()));
-    yold.insert(yold.begin(),n-1,zeros((int)y0.length()));
-
+    resizeStates(y0.length());
     init(y0);    
 }
 
 
+/***************************************************************************/
+void Filter::resizeStates(const size_t channels)
+{
+    ubuf.assign((m-1)*channels,0.0);
+    ybuf.assign((n-1)*channels,0.0);
+    uhead=yhead=0;
+}
+
+
 /***************************************************************************/
 void Filter::init(const Vector &y0)
 {
     // take the last input
     // as guess for the next input
-    if (uold.size()>0)
-        init(y0,uold[0]);
+    if ((m>1) && (ubuf.size()==(m-1)*y0.length()))
+        init(y0,Vector(y0.length(),&ubuf[uhead*y0.length()]));
     else    // otherwise use zero
         init(y0,zeros((int)y0.length()));    
 }
@@ -78,12 +85,16 @@ void Filter::init(const Vector &y0, const Vector &u0)
             y_init=a[0]/(a[0]-sum_a)*y;
         // if sum_a==a[0] then the filter can only be initialized to zero
     }
+
+    const size_t channels=y.length();
+    if ((ubuf.size()!=(m-1)*channels) || (ybuf.size()!=(n-1)*channels))
+        resizeStates(channels);
     
-    for (size_t i=0; i<yold.size(); i++)
-        yold[i]=y_init;
+    for (size_t i=0; i<n-1; i++)
+        copy(y_init.data(),y_init.data()+channels,&ybuf[i*channels]);
     
-    for (size_t i=0; i<uold.size(); i++)
-        uold[i]=u_init;
+    for (size_t i=0; i<m-1; i++)
+        copy(u_init.data(),u_init.data()+channels,&ubuf[i*channels]);
 }
 
 
@@ -101,15 +112,10 @@ void Filter::setCoeffs(const Vector &num, const Vector &den)
     b=num;
     a=den;
 
-    uold.clear();
-    yold.clear();
-
     m=b.length(); n=a.length();
     yAssert((m>0)&&(n>0));
 
-    uold.insert(uold.begin(),m-1,zeros((int)y.length()));
-    yold.insert(yold.begin(),n-1,zeros((int)y.length()));
-
+    resizeStates(y.length());
     init(y);
 }
 
@@ -131,8 +137,16 @@ bool Filter::adjustCoeffs(const Vector &num, const Vector &den)
 /***************************************************************************/
 void Filter::getStates(deque<Vector> &u, deque<Vector> &y)
 {
-    u=uold;
-    y=yold;
+    const size_t channels=this->y.length();
+
+    // from the most recent sample backward
+    u.clear();
+    for (size_t i=0; i<m-1; i++)
+        u.push_back(Vector(channels,&ubuf[((uhead+i)%(m-1))*channels]));
+
+    y.clear();
+    for (size_t i=0; i<n-1; i++)
+        y.push_back(Vector(channels,&ybuf[((yhead+i)%(n-1))*channels]));
 }
 
 
@@ -140,26 +154,48 @@ void Filter::getStates(deque<Vector> &u, deque<Vector> &y)
 const Vector& Filter::filt(const Vector &u)
 {
     yAssert(y.length()==u.length());
-    for (size_t j=0; j<y.length(); j++)
-        y[j]=b[0]*u[j];
-    
-    for (size_t i=1; i<m; i++)
-        for (size_t j=0; j<y.length(); j++)
-            y[j]+=b[i]*uold[i-1][j];
-    
-    for (size_t i=1; i<n; i++)
-        for (size_t j=0; j<y.length(); j++)
-            y[j]-=a[i]*yold[i-1][j];
-    
-    for (size_t j=0; j<y.length(); j++)
-        y[j]/=a[0];
-    
-    uold.push_front(u);
-    uold.pop_back();
-    
-    yold.push_front(y);
-    yold.pop_back();
-    
+    const size_t channels=y.length();
+    const double *pu=u.data();
+    double *py=y.data();
+
+    const double b0=b[0];
+    for (size_t j=0; j<channels; j++)
+        py[j]=b0*pu[j];
+
+    // the i-th past sample lies i-1 slots after the head
+    for (size_t i=1, slot=uhead; i<m; i++, slot=(slot+1<m-1?slot+1:0))
+    {
+        const double bi=b[i];
+        const double *pold=&ubuf[slot*channels];
+        for (size_t j=0; j<channels; j++)
+            py[j]+=bi*pold[j];
+    }
+
+    for (size_t i=1, slot=yhead; i<n; i++, slot=(slot+1<n-1?slot+1:0))
+    {
+        const double ai=a[i];
+        const double *pold=&ybuf[slot*channels];
+        for (size_t j=0; j<channels; j++)
+            py[j]-=ai*pold[j];
+    }
+
+    const double a0=a[0];
+    for (size_t j=0; j<channels; j++)
+        py[j]/=a0;
+
+    // the current samples replace the oldest ones
+    if (m>1)
+    {
+        uhead=(uhead>0?uhead:m-1)-1;
+        copy(pu,pu+channels,&ubuf[uhead*channels]);
+    }
+
+    if (n>1)
+    {
+        yhead=(yhead>0?yhead:n-1)-1;
+        copy(py,py+channels,&ybuf[yhead*channels]);
+    }
+
     return y;
 }
 
@@ -306,7 +342,12 @@ void MedianFilter::init(const Vector &y0)
     yAssert(y0.length()>0);
     y=y0;
     m=y.length();
-    uold.assign(m,deque<double>());
+
+    const size_t w=n+1;
+    uwin.assign(m*w,0.0);
+    heaps.assign(m*w,0);
+    where.assign(m*w,0);
+    head=count=0;
 }
 
 
@@ -319,36 +360,164 @@ void MedianFilter::setOrder(const size_t n)
 }
 
 
+namespace
+{
+    // heap of ring slots ordered by their values: max-heap if Max,
+    // min-heap otherwise; "where" records the position of each slot
+    // shifted by "offset", which tells apart the two heaps of a window
+    template<bool Max>
+    inline bool precedes(const double x1, const double x2)
+    {
+        return (Max?(x1>x2):(x1<x2));
+    }
+
+    template<bool Max>
+    void siftUp(const double *val, size_t *heap, size_t *where,
+                const size_t offset, size_t i)
+    {
+        const size_t slot=heap[i];
+        while (i>0)
+        {
+            const size_t parent=(i-1)>>1;
+            if (!precedes<Max>(val[slot],val[heap[parent]]))
+                break;
+
+            heap[i]=heap[parent];
+            where[heap[i]]=offset+i;
+            i=parent;
+        }
+
+        heap[i]=slot;
+        where[slot]=offset+i;
+    }
+
+    template<bool Max>
+    void siftDown(const double *val, size_t *heap, size_t *where,
+                  const size_t offset, const size_t len, size_t i)
+    {
+        const size_t slot=heap[i];
+        while (true)
+        {
+            size_t child=(i<<1)+1;
+            if (child>=len)
+                break;
+
+            if ((child+1<len) && precedes<Max>(val[heap[child+1]],val[heap[child]]))
+                child++;
+
+            if (!precedes<Max>(val[heap[child]],val[slot]))
+                break;
+
+            heap[i]=heap[child];
+            where[heap[i]]=offset+i;
+            i=child;
+        }
+
+        heap[i]=slot;
+        where[slot]=offset+i;
+    }
+}
+
+
 /***************************************************************************/
-double MedianFilter::median(deque<double>& v)
+void MedianFilter::buildHeaps(const size_t channel)
 {
-    size_t L=v.size()>>1;
-    nth_element(v.begin(),v.begin()+L,v.end());
-    if (v.size()&0x01)
-        return v[L];
+    const size_t w=n+1;
+    const size_t lower=(w+1)>>1;
+    const double *val=&uwin[channel*w];
+    size_t *heap=&heaps[channel*w];
+
+    // ascending slots: the upper half is already a min-heap,
+    // the lower half reversed is a max-heap
+    for (size_t i=0; i<w; i++)
+        heap[i]=i;
+    sort(heap,heap+w,[val](const size_t i1, const size_t i2) { return (val[i1]<val[i2]); });
+    reverse(heap,heap+lower);
+
+    for (size_t i=0; i<w; i++)
+        where[channel*w+heap[i]]=i;
+}
+
+
+/***************************************************************************/
+void MedianFilter::replace(const size_t channel, const size_t slot, const double u)
+{
+    const size_t w=n+1;
+    const size_t lower=(w+1)>>1;
+    const size_t upper=w-lower;
+    double *val=&uwin[channel*w];
+    size_t *lo=&heaps[channel*w];
+    size_t *hi=lo+lower;
+    size_t *pos=&where[channel*w];
+
+    val[slot]=u;
+    const size_t i=pos[slot];
+    if (i<lower)
+    {
+        siftUp<true>(val,lo,pos,0,i);
+        siftDown<true>(val,lo,pos,0,lower,pos[slot]);
+    }
     else
     {
-        nth_element(v.begin(),v.begin()+L-1,v.end());
-        return 0.5*(v[L]+v[L-1]);
+        siftUp<false>(val,hi,pos,lower,i-lower);
+        siftDown<false>(val,hi,pos,lower,upper,pos[slot]-lower);
+    }
+
+    // only the replaced value can be on the wrong side:
+    // swapping the two tops restores the ordering
+    if ((upper>0) && (val[lo[0]]>val[hi[0]]))
+    {
+        swap(lo[0],hi[0]);
+        siftDown<true>(val,lo,pos,0,lower,0);
+        siftDown<false>(val,hi,pos,lower,upper,0);
     }
 }
 
 
+/***************************************************************************/
+double MedianFilter::median(const size_t channel) const
+{
+    const size_t w=n+1;
+    const double *val=&uwin[channel*w];
+    const size_t *lo=&heaps[channel*w];
+    if (w&0x01)
+        return val[lo[0]];
+    else
+        return 0.5*(val[lo[(w+1)>>1]]+val[lo[0]]);
+}
+
+
 /***************************************************************************/
 const Vector& MedianFilter::filt(const Vector &u)
 {
     yAssert(y.length()==u.length());
-    for (size_t i=0; i<m; i++)
-        uold[i].push_front(u[i]);
+    const size_t w=n+1;
+
+    // the output is held until the window fills up
+    if (count<w)
+    {
+        for (size_t i=0; i<m; i++)
+            uwin[i*w+head]=u[i];
+        head=(head+1<w?head+1:0);
 
-    if (uold[0].size()>n)
+        if (++count==w)
+        {
+            for (size_t i=0; i<m; i++)
+            {
+                buildHeaps(i);
+                y[i]=median(i);
+            }
+        }
+    }
+    else
     {
+        // the oldest sample lies at the head
         for (size_t i=0; i<m; i++)
         {
-            deque<double> tmp=uold[i];
-            y[i]=median(tmp);
-            uold[i].pop_back();
+            replace(i,head,u[i]);
+            y[i]=median(i);
         }
+        head=(head+1<w?head+1:0);
     }
 
     return y;
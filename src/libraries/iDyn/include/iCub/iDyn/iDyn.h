@@ -118,6 +118,7 @@ class iDynLink : public iKin::iKinLink
 {
     friend class iDynChain;
     friend class OneLinkNewtonEuler;
+    friend class OneChainNewtonEuler;
 
 protected:
     // DH rototranslation matrix (it's the same matrix you get calling iKinLink->getH(true) but it's stored here for performance reason)
@@ -553,6 +554,9 @@ protected:
     ///pointer to OneChainNewtonEuler class, to be used for computing forces and torques
     OneChainNewtonEuler *NE;
 
+    ///if true, the classic Newton-Euler computation uses the fixed-size (allocation-free) path
+    bool fixedSizeNE;
+
     const yarp::sig::Vector zero0;
 
     /**
@@ -854,6 +858,20 @@ public:
     */
     void setModeNewtonEuler(const NewEulMode NewEulMode_s=DYNAMIC);
 
+    /**
+    * Enable/disable the fixed-size path of computeNewtonEuler(). When enabled (default),
+    * the KINFWD_WREBWD computation in STATIC, DYNAMIC and DYNAMIC_CORIOLIS_GRAVITY modes
+    * is carried out on fixed-size 3D quantities without heap allocation; the other
+    * cases always resort to the classic per-link computation.
+    * @param sw true to enable the fixed-size path
+    */
+    void setFixedSizeNewtonEuler(const bool sw=true);
+
+    /**
+    * Returns true if the fixed-size path of computeNewtonEuler() is enabled.
+    */
+    bool getFixedSizeNewtonEuler() const;
+
     /**
     * Returns the links forces as a matrix, where the (i+1)-th col is the i-th force
     * @return a 3x(N+2) matrix with forces, in the form: (i+1)-th col = F_i
@@ -54,6 +54,9 @@
 #include <iCub/iDyn/iDynContact.h>
 #include <deque>
 #include <string>
+#include <vector>
+#include <memory>
+#include <functional>
 
 
 namespace iCub
@@ -75,6 +78,7 @@ namespace iDyn
     class iFB;
     class iDynSensorLeg;
     class iDynSensorArm;
+    class iDynLimbWorkers;
 
 
 
@@ -602,6 +606,20 @@ protected:
     */
     unsigned int howManyKinematicInputs(bool afterAttach=false) const;
 
+    /// pool of persistent workers solving the limbs in parallel (empty if the limbs are solved serially)
+    std::shared_ptr<iDynLimbWorkers> workers;
+
+    /// limbs handled by the current call of forEachLimb()
+    std::vector<unsigned int> limbsToSolve;
+
+    /**
+    * Call job(i) for each limb i in limbsToSolve, using the pool of workers if it is available.
+    * The function returns when all the jobs are done, so that the results can be
+    * combined afterwards in the order of the limbs, independently of the number of threads.
+    * @param job the computation to perform on each limb; it must only touch that limb
+    */
+    void forEachLimb(const std::function<void(unsigned int)> &job);
+
 public:
 
     /**
@@ -636,6 +654,21 @@ public:
     */
     yarp::sig::Matrix getRBT(unsigned int iLimb) const;
 
+    /**
+    * Set the number of threads used to propagate kinematics and wrenches in the limbs
+    * attached to the node. The limbs are independent once the node variables are known, so
+    * they can be solved in parallel; the node wrench is then summed in the order of the limbs,
+    * hence the result does not depend on the number of threads.
+    * @param nThreads the number of threads, including the calling one; 0 or 1 means serial computation
+    */
+    void setParallelLimbs(unsigned int nThreads);
+
+    /**
+    * Return the number of threads used to solve the limbs attached to the node.
+    * @return the number of threads (1 if the limbs are solved serially)
+    */
+    unsigned int getParallelLimbs() const;
+
     /**
     * Main function to manage the exchange of kinematic information among the limbs attached to the node.
     * One single limb with kinematic flow of input type must exist: this limb is initilized with the kinematic variables
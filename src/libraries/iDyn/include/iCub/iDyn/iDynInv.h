@@ -51,6 +51,7 @@
 #include <iCub/skinDynLib/common.h>
 #include <deque>
 #include <string>
+#include <vector>
 
 
 namespace iCub
@@ -490,6 +491,8 @@ public:
 */
 class BaseLinkNewtonEuler : public OneLinkNewtonEuler
 {
+    friend class OneChainNewtonEuler;
+
 protected:
     ///initial angular velocity
     yarp::sig::Vector w;    
@@ -609,6 +612,8 @@ public:
 */
 class FinalLinkNewtonEuler : public OneLinkNewtonEuler
 {
+    friend class OneChainNewtonEuler;
+
 protected:
     ///initial angular velocity
     yarp::sig::Vector w;    
@@ -901,6 +906,24 @@ protected:
     /// verbosity flag
     unsigned int verbose;
 
+    /**
+    * Fixed-size storage of one frame for the allocation-free recursion:
+    * dynamic parameters, current roto-translation and the kinematic and
+    * wrench variables, all expressed in the frame itself. Matrices are
+    * stored row-major.
+    */
+    struct FixedFrame
+    {
+        double m, rc[3], I[9];
+        double R[9], r[3];
+        double dq, ddq;
+        double w[3], dw[3], ddp[3], ddpC[3];
+        double F[3], Mu[3];
+    };
+
+    /// base frame (index 0) and links (1..nLinks) for the fixed-size recursion
+    std::vector<FixedFrame> fixedChain;
+
 public:
 
   /**
@@ -1102,6 +1125,28 @@ public:
      */
     bool BackwardWrenchFromAtoB(unsigned int lA, unsigned int lB);
 
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    //   fixed-size classic computation
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+    /**
+     * [classic] Forward kinematics from the base followed by backward wrench from the 
+     * end-effector, equivalent to ForwardKinematicFromBase() + BackwardWrenchFromEnd() 
+     * but carried out on fixed-size 3D quantities: the link parameters are gathered in 
+     * a contiguous array and no heap allocation takes place. Results are stored in the 
+     * links as in the classic computation. The DYNAMIC_W_ROTOR mode is not handled.
+     * @return true if the operation is successful, false if the mode is not handled
+     */
+    bool ForwardKinematicBackwardWrenchFixed();
+
+    /**
+     * [classic] Same as ForwardKinematicBackwardWrenchFixed(), after initializing the 
+     * base link with w0, dw0, ddp0 and the final link with F, Mu (all 3x1 vectors).
+     * @return true if the operation is successful, false if the mode is not handled
+     */
+    bool ForwardKinematicBackwardWrenchFixed(const yarp::sig::Vector &w0, const yarp::sig::Vector &dw0, const yarp::sig::Vector &ddp0,
+                                             const yarp::sig::Vector &F, const yarp::sig::Vector &Mu);
+
 };
 
 
@@ -477,6 +477,7 @@ iDynChain::iDynChain()
 : iKinChain()
 {
     NE=NULL;
+    fixedSizeNE=true;
     setIterMode(KINFWD_WREBWD);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -488,6 +489,7 @@ void iDynChain::clone(const iDynChain &c)
     iterateMode_kinematics = c.iterateMode_kinematics;
     iterateMode_wrench = c.iterateMode_wrench;
     NE = c.NE;
+    fixedSizeNE = c.fixedSizeNE;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void iDynChain::build()
@@ -940,6 +942,12 @@ bool iDynChain::computeNewtonEuler(const Vector &w0, const Vector &dw0, const Ve
 
     if((w0.length()==3)&&(dw0.length()==3)&&(ddp0.length()==3)&&(F0.length()==3)&&(Mu0.length()==3))
     {
+        if(fixedSizeNE && (iterateMode_kinematics == FORWARD) && (iterateMode_wrench == BACKWARD))
+        {
+            if(NE->ForwardKinematicBackwardWrenchFixed(w0,dw0,ddp0,F0,Mu0))
+                return true;
+        }
+
         if(iterateMode_kinematics == FORWARD)   
             NE->ForwardKinematicFromBase(w0,dw0,ddp0);
         else 
@@ -976,6 +984,12 @@ bool iDynChain::computeNewtonEuler()
         initNewtonEuler();
     }
 
+    if(fixedSizeNE && (iterateMode_kinematics == FORWARD) && (iterateMode_wrench == BACKWARD))
+    {
+        if(NE->ForwardKinematicBackwardWrenchFixed())
+            return true;
+    }
+
     if(iterateMode_kinematics == FORWARD)   
         NE->ForwardKinematicFromBase();
     else 
@@ -1216,6 +1230,16 @@ void iDynChain::setModeNewtonEuler(const NewEulMode mode)
     NE->setMode(mode);
     if(verbose) yInfo("iDynChain: Newton-Euler mode set to %s \n",NewEulMode_s[mode].c_str());
 }
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynChain::setFixedSizeNewtonEuler(const bool sw)
+{
+    fixedSizeNE=sw;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynChain::getFixedSizeNewtonEuler() const
+{
+    return fixedSizeNE;
+}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
             //~~~~~~~~~~~~~~
@@ -20,6 +20,10 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #include <iCub/iDyn/iDyn.h>
 #include <iCub/iDyn/iDynBody.h>
@@ -405,6 +409,112 @@ Matrix RigidBodyTransformation::getHCOM(unsigned int iLink)
 
 
 
+//====================================
+//
+//      i DYN LIMB WORKERS
+//
+//====================================
+
+namespace iCub
+{
+namespace iDyn
+{
+/**
+* Persistent pool of threads used by iDynNode to solve its limbs in parallel.
+* The calling thread takes part in the computation, and run() returns only when
+* all the jobs are done.
+*/
+class iDynLimbWorkers
+{
+    std::vector<std::thread> threads;
+    std::mutex mtx;
+    std::mutex runMtx;
+    std::condition_variable cvStart;
+    std::condition_variable cvDone;
+
+    const std::function<void(unsigned int)> *job;
+    const std::vector<unsigned int> *items;
+    std::atomic<size_t> next;
+    unsigned long long generation;
+    size_t finished;
+    bool quit;
+
+    void work()
+    {
+        for (size_t k=next++; k<items->size(); k=next++)
+            (*job)((*items)[k]);
+    }
+
+    void loop()
+    {
+        unsigned long long seen=0;
+        while (true)
+        {
+            {
+                unique_lock<mutex> lck(mtx);
+                cvStart.wait(lck,[&](){ return quit || (generation!=seen); });
+                if (quit)
+                    return;
+                seen=generation;
+            }
+
+            work();
+
+            lock_guard<mutex> lck(mtx);
+            if (++finished==threads.size())
+                cvDone.notify_one();
+        }
+    }
+
+public:
+    explicit iDynLimbWorkers(unsigned int nThreads) : job(NULL), items(NULL), next(0),
+                                                      generation(0), finished(0), quit(false)
+    {
+        // the calling thread is one of the workers
+        for (unsigned int i=1; i<nThreads; i++)
+            threads.push_back(std::thread(&iDynLimbWorkers::loop,this));
+    }
+
+    unsigned int size() const
+    {
+        return (unsigned int)threads.size()+1;
+    }
+
+    void run(const std::vector<unsigned int> &_items, const std::function<void(unsigned int)> &_job)
+    {
+        lock_guard<mutex> lckRun(runMtx);
+        {
+            lock_guard<mutex> lck(mtx);
+            job=&_job;
+            items=&_items;
+            next=0;
+            finished=0;
+            generation++;
+        }
+        cvStart.notify_all();
+
+        work();
+
+        unique_lock<mutex> lck(mtx);
+        cvDone.wait(lck,[&](){ return finished==threads.size(); });
+    }
+
+    ~iDynLimbWorkers()
+    {
+        {
+            lock_guard<mutex> lck(mtx);
+            quit=true;
+        }
+        cvStart.notify_all();
+        for (size_t i=0; i<threads.size(); i++)
+            threads[i].join();
+    }
+};
+}
+}
+
+
+
 
 //====================================
 //
@@ -458,6 +568,28 @@ Matrix iDynNode::getRBT(unsigned int iLimb) const
         return Matrix(0,0);
     }
 }
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynNode::setParallelLimbs(unsigned int nThreads)
+{
+    if (nThreads>1)
+        workers=std::make_shared<iDynLimbWorkers>(nThreads);
+    else
+        workers.reset();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+unsigned int iDynNode::getParallelLimbs() const
+{
+    return (workers ? workers->size() : 1);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynNode::forEachLimb(const std::function<void(unsigned int)> &job)
+{
+    if (workers && (limbsToSolve.size()>1))
+        workers->run(limbsToSolve,job);
+    else
+        for (size_t k=0; k<limbsToSolve.size(); k++)
+            job(limbsToSolve[k]);
+}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynNode::solveKinematics()
 {
@@ -483,16 +615,19 @@ bool iDynNode::solveKinematics()
     if(inputNode==1)
     {
         //now forward the kinematic input from limbs whose kinematic flow is input type
+        //the limbs only depend on the node kinematics, so they can be solved in parallel
+        limbsToSolve.clear();
         for(unsigned int i=0; i<rbtList.size(); i++)
-        {
             if(rbtList[i].getKinematicFlow()==RBT_NODE_OUT)
-            {
-                //init the kinematics with the node information
-                rbtList[i].setKinematic(w,dw,ddp);
-                //solve kinematics in that limb/chain
-                rbtList[i].computeLimbKinematic();
-            }
-        }
+                limbsToSolve.push_back(i);
+
+        forEachLimb([this](unsigned int i)
+        {
+            //init the kinematics with the node information
+            rbtList[i].setKinematic(w,dw,ddp);
+            //solve kinematics in that limb/chain
+            rbtList[i].computeLimbKinematic();
+        });
         return true;
     
     }
@@ -532,16 +667,19 @@ bool iDynNode::solveKinematics(const Vector &w0, const Vector &dw0, const Vector
     if(inputNode==1)
     {
         //now forward the kinematic input from limbs whose kinematic flow is input type
+        //the limbs only depend on the node kinematics, so they can be solved in parallel
+        limbsToSolve.clear();
         for(unsigned int i=0; i<rbtList.size(); i++)
-        {
             if(rbtList[i].getKinematicFlow()==RBT_NODE_OUT)
-            {
-                //init the kinematics with the node information
-                rbtList[i].setKinematic(w,dw,ddp);
-                //solve kinematics in that limb/chain
-                rbtList[i].computeLimbKinematic();
-            }
-        }
+                limbsToSolve.push_back(i);
+
+        forEachLimb([this](unsigned int i)
+        {
+            //init the kinematics with the node information
+            rbtList[i].setKinematic(w,dw,ddp);
+            //solve kinematics in that limb/chain
+            rbtList[i].computeLimbKinematic();
+        });
         return true;
     
     }
@@ -595,19 +733,26 @@ bool iDynNode::solveWrench()
     //first get the forces/moments from each limb
     //assuming that each limb has been properly set with the outcoming measured
     //forces/moments which are necessary for the wrench computation
+    limbsToSolve.clear();
     for(unsigned int i=0; i<rbtList.size(); i++)
-    {
         if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)         
-        {
-            //compute the wrench pass in that limb
-            rbtList[i].computeLimbWrench();
-            //update the node force/moment with the wrench coming from the limb base/end
-            // note that getWrench sum the result to F,Mu - because they are passed by reference
-            // F = F + F[i], Mu = Mu + Mu[i]
-            rbtList[i].getWrench(F,Mu);
-            //check
-            outputNode++;
-        }
+            limbsToSolve.push_back(i);
+
+    //compute the wrench pass in those limbs, in parallel
+    forEachLimb([this](unsigned int i)
+    {
+        rbtList[i].computeLimbWrench();
+    });
+
+    for(size_t k=0; k<limbsToSolve.size(); k++)
+    {
+        //update the node force/moment with the wrench coming from the limb base/end
+        // note that getWrench sum the result to F,Mu - because they are passed by reference
+        // F = F + F[i], Mu = Mu + Mu[i]
+        // the sum is done serially, in the order of the limbs, so the result is deterministic
+        rbtList[limbsToSolve[k]].getWrench(F,Mu);
+        //check
+        outputNode++;
     }
 
     // node summation: already performed by each RBT
@@ -628,16 +773,18 @@ bool iDynNode::solveWrench()
     }
 
     //now forward the wrench output from the node to limbs whose wrench flow is output type
+    limbsToSolve.clear();
     for(unsigned int i=0; i<rbtList.size(); i++)
-    {
         if(rbtList[i].getWrenchFlow()==RBT_NODE_OUT)
-        {
-            //init the wrench with the node information
-            rbtList[i].setWrench(F,Mu);
-            //solve wrench in that limb/chain
-            rbtList[i].computeLimbWrench();
-        }
-    }
+            limbsToSolve.push_back(i);
+
+    forEachLimb([this](unsigned int i)
+    {
+        //init the wrench with the node information
+        rbtList[i].setWrench(F,Mu);
+        //solve wrench in that limb/chain
+        rbtList[i].computeLimbWrench();
+    });
     return true;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1358,25 +1505,31 @@ bool iDynSensorNode::solveWrench()
     //first get the forces/moments from each limb
     //assuming that each limb has been properly set with the outcoming measured
     //forces/moments which are necessary for the wrench computation
+    limbsToSolve.clear();
     for(unsigned int i=0; i<rbtList.size(); i++)
-    {
         if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)         
-        {
-            //compute the wrench pass in that limb
-            // if there's a sensor, we must use iDynSensor
-            // otherwise we use the limb method as usual
-            if(rbtList[i].isSensorized()==true)
-                sensorList[i]->computeWrenchFromSensorNewtonEuler();
-            else
-                rbtList[i].computeLimbWrench();
+            limbsToSolve.push_back(i);
 
-            //update the node force/moment with the wrench coming from the limb base/end
-            // note that getWrench sum the result to F,Mu - because they are passed by reference
-            // F = F + F[i], Mu = Mu + Mu[i]
-            rbtList[i].getWrench(F,Mu);
-            //check
-            outputNode++;
-        }
+    //compute the wrench pass in those limbs, in parallel
+    forEachLimb([this](unsigned int i)
+    {
+        // if there's a sensor, we must use iDynSensor
+        // otherwise we use the limb method as usual
+        if(rbtList[i].isSensorized()==true)
+            sensorList[i]->computeWrenchFromSensorNewtonEuler();
+        else
+            rbtList[i].computeLimbWrench();
+    });
+
+    for(size_t k=0; k<limbsToSolve.size(); k++)
+    {
+        //update the node force/moment with the wrench coming from the limb base/end
+        // note that getWrench sum the result to F,Mu - because they are passed by reference
+        // F = F + F[i], Mu = Mu + Mu[i]
+        // the sum is done serially, in the order of the limbs, so the result is deterministic
+        rbtList[limbsToSolve[k]].getWrench(F,Mu);
+        //check
+        outputNode++;
     }
 
     // node summation: already performed by each RBT
@@ -1397,16 +1550,18 @@ bool iDynSensorNode::solveWrench()
 
     //now forward the wrench output from the node to limbs whose wrench flow is output type
     // assuming they don't have a FT sensor
+    limbsToSolve.clear();
     for(unsigned int i=0; i<rbtList.size(); i++)
-    {
         if(rbtList[i].getWrenchFlow()==RBT_NODE_OUT)
-        {
-            //init the wrench with the node information
-            rbtList[i].setWrench(F,Mu);
-            //solve wrench in that limb/chain
-            rbtList[i].computeLimbWrench();
-        }
-    }
+            limbsToSolve.push_back(i);
+
+    forEachLimb([this](unsigned int i)
+    {
+        //init the wrench with the node information
+        rbtList[i].setWrench(F,Mu);
+        //solve wrench in that limb/chain
+        rbtList[i].computeLimbWrench();
+    });
     return true;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
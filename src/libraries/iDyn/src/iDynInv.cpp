@@ -1708,6 +1708,8 @@ OneChainNewtonEuler::OneChainNewtonEuler(iDynChain *_c, string _info, const NewE
     //the end effector is the last (nLinks+2-1 because it's an index)
     nEndEff = nLinks+1;
 
+    //storage for the fixed-size recursion: base + links
+    fixedChain.resize(nLinks+1);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 OneChainNewtonEuler::~OneChainNewtonEuler()
@@ -2015,6 +2017,219 @@ bool OneChainNewtonEuler::BackwardWrenchFromAtoB(unsigned int lA, unsigned int l
     }
 }
 
+     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     //   fixed-size classic computation
+     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace
+{
+    // y = R*x, with R 3x3 row-major
+    inline void mul3(const double *R, const double *x, double *y)
+    {
+        y[0]=R[0]*x[0]+R[1]*x[1]+R[2]*x[2];
+        y[1]=R[3]*x[0]+R[4]*x[1]+R[5]*x[2];
+        y[2]=R[6]*x[0]+R[7]*x[1]+R[8]*x[2];
+    }
+
+    // y = R'*x, with R 3x3 row-major
+    inline void mulT3(const double *R, const double *x, double *y)
+    {
+        y[0]=R[0]*x[0]+R[3]*x[1]+R[6]*x[2];
+        y[1]=R[1]*x[0]+R[4]*x[1]+R[7]*x[2];
+        y[2]=R[2]*x[0]+R[5]*x[1]+R[8]*x[2];
+    }
+
+    // y += a x b
+    inline void addCross3(const double *a, const double *b, double *y)
+    {
+        y[0]+=a[1]*b[2]-a[2]*b[1];
+        y[1]+=a[2]*b[0]-a[0]*b[2];
+        y[2]+=a[0]*b[1]-a[1]*b[0];
+    }
+
+    // y += w x (w x r)
+    inline void addCentripetal3(const double *w, const double *r, double *y)
+    {
+        double t[3]={0.0,0.0,0.0};
+        addCross3(w,r,t);
+        addCross3(w,t,y);
+    }
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool OneChainNewtonEuler::ForwardKinematicBackwardWrenchFixed()
+{
+    if(mode==DYNAMIC_W_ROTOR)
+        return false;
+
+    BaseLinkNewtonEuler *base=static_cast<BaseLinkNewtonEuler*>(neChain[0]);
+    FinalLinkNewtonEuler *finalLink=static_cast<FinalLinkNewtonEuler*>(neChain[nEndEff]);
+    const bool dynamic=(mode!=STATIC);
+
+    // gather the base kinematics, the link parameters and the current roto-translations
+    FixedFrame &b=fixedChain[0];
+    for(int j=0; j<3; j++)
+    {
+        b.w[j]=base->w[j];
+        b.dw[j]=base->dw[j];
+        b.ddp[j]=base->ddp[j];
+    }
+
+    iKinHMatrix H;
+    for(unsigned int i=1; i<=nLinks; i++)
+    {
+        FixedFrame &c=fixedChain[i];
+        iDynLink *l=chain->refLink(i-1);
+        l->iKinLink::getH(H,true);
+        for(int r=0; r<3; r++)
+        {
+            c.R[3*r]=H(r,0); c.R[3*r+1]=H(r,1); c.R[3*r+2]=H(r,2);
+        }
+        const double p[3]={H(0,3),H(1,3),H(2,3)};
+        mulT3(c.R,p,c.r);
+
+        c.m=l->m;
+        for(int j=0; j<3; j++)
+        {
+            c.rc[j]=l->rc[j];
+            c.I[3*j]=l->I(j,0); c.I[3*j+1]=l->I(j,1); c.I[3*j+2]=l->I(j,2);
+        }
+        c.dq=l->dq;
+        c.ddq=l->ddq;
+    }
+
+    // forward kinematics from the base
+    for(unsigned int i=1; i<=nLinks; i++)
+    {
+        const FixedFrame &p=fixedChain[i-1];
+        FixedFrame &c=fixedChain[i];
+
+        if(dynamic)
+        {
+            double v[3]={p.w[0],p.w[1],p.w[2]+c.dq};
+            mulT3(c.R,v,c.w);
+
+            v[0]=p.dw[0]+c.dq*p.w[1];
+            v[1]=p.dw[1]-c.dq*p.w[0];
+            v[2]=(mode==DYNAMIC_CORIOLIS_GRAVITY) ? p.dw[2] : p.dw[2]+c.ddq;
+            mulT3(c.R,v,c.dw);
+
+            mulT3(c.R,p.ddp,c.ddp);
+            addCross3(c.dw,c.r,c.ddp);
+            addCentripetal3(c.w,c.r,c.ddp);
+
+            c.ddpC[0]=c.ddp[0]; c.ddpC[1]=c.ddp[1]; c.ddpC[2]=c.ddp[2];
+            addCross3(c.dw,c.rc,c.ddpC);
+            addCentripetal3(c.w,c.rc,c.ddpC);
+        }
+        else
+        {
+            c.w[0]=c.w[1]=c.w[2]=0.0;
+            c.dw[0]=c.dw[1]=c.dw[2]=0.0;
+            mulT3(c.R,p.ddp,c.ddp);
+            c.ddpC[0]=c.ddp[0]; c.ddpC[1]=c.ddp[1]; c.ddpC[2]=c.ddp[2];
+        }
+    }
+
+    // backward wrench from the end-effector: the last link takes the final wrench
+    FixedFrame &e=fixedChain[nLinks];
+    for(int j=0; j<3; j++)
+    {
+        e.F[j]=finalLink->F[j];
+        e.Mu[j]=finalLink->Mu[j];
+    }
+
+    // each frame (base included) is computed in the frame of its successor and rotated
+    for(int i=nLinks-1; i>=0; i--)
+    {
+        const FixedFrame &n=fixedChain[i+1];
+        FixedFrame &c=fixedChain[i];
+
+        const double mddpC[3]={n.m*n.ddpC[0],n.m*n.ddpC[1],n.m*n.ddpC[2]};
+        double f[3]={mddpC[0]+n.F[0],mddpC[1]+n.F[1],mddpC[2]+n.F[2]};
+        mul3(n.R,f,c.F);
+
+        double mu[3]={0.0,0.0,0.0};
+        const double rrc[3]={n.r[0]+n.rc[0],n.r[1]+n.rc[1],n.r[2]+n.rc[2]};
+        addCross3(n.r,n.F,mu);
+        addCross3(rrc,mddpC,mu);
+        mu[0]+=n.Mu[0]; mu[1]+=n.Mu[1]; mu[2]+=n.Mu[2];
+        if(dynamic)
+        {
+            double Iw[3];
+            mul3(n.I,n.dw,Iw);
+            mu[0]+=Iw[0]; mu[1]+=Iw[1]; mu[2]+=Iw[2];
+            mul3(n.I,n.w,Iw);
+            addCross3(n.w,Iw,mu);
+        }
+        mul3(n.R,mu,c.Mu);
+    }
+
+    // store the results: links, then the base wrench expressed through H0
+    for(unsigned int i=1; i<=nLinks; i++)
+    {
+        const FixedFrame &c=fixedChain[i];
+        iDynLink *l=chain->refLink(i-1);
+        for(int j=0; j<3; j++)
+        {
+            l->w[j]=c.w[j];
+            l->dw[j]=c.dw[j];
+            l->ddp[j]=c.ddp[j];
+            l->ddpC[j]=c.ddpC[j];
+            l->F[j]=c.F[j];
+            l->Mu[j]=c.Mu[j];
+        }
+        // the torque is the z-component of the moment of the previous frame
+        l->Tau=fixedChain[i-1].Mu[2];
+    }
+
+    for(int r=0; r<3; r++)
+    {
+        base->F[r]=base->H0(r,0)*b.F[0]+base->H0(r,1)*b.F[1]+base->H0(r,2)*b.F[2];
+        base->Mu[r]=base->H0(r,0)*b.Mu[0]+base->H0(r,1)*b.Mu[1]+base->H0(r,2)*b.Mu[2];
+    }
+    if(base->Mu0.length()!=3)
+        base->Mu0.resize(3);
+    for(int j=0; j<3; j++)
+        base->Mu0[j]=b.Mu[j];
+
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool OneChainNewtonEuler::ForwardKinematicBackwardWrenchFixed(const Vector &w0, const Vector &dw0, const Vector &ddp0,
+                                                              const Vector &F, const Vector &Mu)
+{
+    if(mode==DYNAMIC_W_ROTOR)
+        return false;
+
+    if((w0.length()!=3)||(dw0.length()!=3)||(ddp0.length()!=3)||(F.length()!=3)||(Mu.length()!=3))
+    {
+        if(verbose)
+            fprintf(stderr,"OneChainNewtonEuler error: could not perform the fixed-size computation due to wrong sized vectors: (%d,%d,%d,%d,%d) instead of (3,3,3,3,3). \n",
+                    (int)w0.length(),(int)dw0.length(),(int)ddp0.length(),(int)F.length(),(int)Mu.length());
+        return false;
+    }
+
+    // same as setAsBase(): the base kinematics is rotated by H0'
+    BaseLinkNewtonEuler *base=static_cast<BaseLinkNewtonEuler*>(neChain[0]);
+    const Matrix &H0=base->H0;
+    for(int c=0; c<3; c++)
+    {
+        base->w[c]=H0(0,c)*w0[0]+H0(1,c)*w0[1]+H0(2,c)*w0[2];
+        base->dw[c]=H0(0,c)*dw0[0]+H0(1,c)*dw0[1]+H0(2,c)*dw0[2];
+        base->ddp[c]=H0(0,c)*ddp0[0]+H0(1,c)*ddp0[1]+H0(2,c)*ddp0[2];
+    }
+
+    FinalLinkNewtonEuler *finalLink=static_cast<FinalLinkNewtonEuler*>(neChain[nEndEff]);
+    for(int j=0; j<3; j++)
+    {
+        finalLink->F[j]=F[j];
+        finalLink->Mu[j]=Mu[j];
+    }
+
+    return ForwardKinematicBackwardWrenchFixed();
+}
+
 //======================================
 //
 //            iDYN INV SENSOR
@@ -54,6 +54,7 @@
 
 #include <string>
 #include <deque>
+#include <vector>
 
 #include <yarp/os/Property.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
@@ -72,6 +73,121 @@ namespace iKin
 
 void notImplemented(const unsigned int verbose);
 
+/**
+* \ingroup iKinFwd
+*
+* A fixed-size 4x4 homogeneous transformation stored row-major
+* on the stack. It is the building block of the allocation-free
+* kinematics path of iKinChain.
+*
+* \note The last row is assumed to be [0 0 0 x], with x=1 for
+*       transformations and x=0 for their derivatives, thus
+*       products are carried out on the upper 3x4 block only.
+*/
+struct iKinHMatrix
+{
+    double data[16];
+
+    /**
+    * Default constructor: the identity transformation.
+    */
+    iKinHMatrix() { eye(); }
+
+    /**
+    * Constructor from a 4x4 yarp matrix.
+    * @param H is the matrix to be copied.
+    */
+    explicit iKinHMatrix(const yarp::sig::Matrix &H) { fromMatrix(H); }
+
+    /**
+    * Element access.
+    * @param r is the row index.
+    * @param c is the column index.
+    * @return a reference to the (r,c) element.
+    */
+    double &operator()(const int r, const int c)       { return data[(r<<2)+c]; }
+    double  operator()(const int r, const int c) const { return data[(r<<2)+c]; }
+
+    /**
+    * Sets the transformation to the identity.
+    */
+    void eye()
+    {
+        for (int i=0; i<16; i++)
+            data[i]=0.0;
+        data[0]=data[5]=data[10]=data[15]=1.0;
+    }
+
+    /**
+    * Copies the content of a 4x4 yarp matrix.
+    * @param H is the matrix to be copied.
+    */
+    void fromMatrix(const yarp::sig::Matrix &H)
+    {
+        const double *src=H.data();
+        for (int i=0; i<16; i++)
+            data[i]=src[i];
+    }
+
+    /**
+    * Copies the transformation into a yarp matrix. No allocation
+    * takes place if H is already 4x4.
+    * @param H is the destination matrix.
+    */
+    void toMatrix(yarp::sig::Matrix &H) const
+    {
+        H.resize(4,4);
+        double *dst=H.data();
+        for (int i=0; i<16; i++)
+            dst[i]=data[i];
+    }
+
+    /**
+    * Returns the transformation as a yarp matrix.
+    * @return the 4x4 matrix.
+    */
+    yarp::sig::Matrix getMatrix() const
+    {
+        yarp::sig::Matrix H(4,4);
+        toMatrix(H);
+        return H;
+    }
+
+    /**
+    * Computes C=A*B.
+    * @param A is the first operand.
+    * @param B is the second operand.
+    * @param C is the result (must not alias A or B).
+    */
+    static void mul(const iKinHMatrix &A, const iKinHMatrix &B, iKinHMatrix &C)
+    {
+        const double *a=A.data;
+        const double *b=B.data;
+        double *c=C.data;
+        for (int r=0; r<12; r+=4)
+        {
+            c[r]  =a[r]*b[0]+a[r+1]*b[4]+a[r+2]*b[8];
+            c[r+1]=a[r]*b[1]+a[r+1]*b[5]+a[r+2]*b[9];
+            c[r+2]=a[r]*b[2]+a[r+1]*b[6]+a[r+2]*b[10];
+            c[r+3]=a[r]*b[3]+a[r+1]*b[7]+a[r+2]*b[11]+a[r+3]*b[15];
+        }
+        c[12]=c[13]=c[14]=0.0;
+        c[15]=a[15]*b[15];
+    }
+
+    /**
+    * Returns the product with another transformation.
+    * @param B is the right operand.
+    * @return (*this)*B.
+    */
+    iKinHMatrix operator*(const iKinHMatrix &B) const
+    {
+        iKinHMatrix C;
+        mul(*this,B,C);
+        return C;
+    }
+};
+
 /**
 * \ingroup iKinFwd
 *
@@ -98,9 +214,13 @@ protected:
     bool         constrained;
     unsigned int verbose;
 
+    // incremented whenever the link transformation changes
+    unsigned long stamp;
+
     yarp::sig::Matrix H;
     yarp::sig::Matrix cumH;
     yarp::sig::Matrix DnH;
+    iKinHMatrix       fast_cumH;
 
     const yarp::sig::Matrix zeros1x1;
     const yarp::sig::Vector zeros1;
@@ -190,7 +310,7 @@ public:
     * Sets the Link length A. 
     * @param new Link length _A. 
     */
-    void setA(const double _A) { A=_A; }
+    void setA(const double _A) { A=_A; stamp++; }
 
     /**
     * Returns the Link offset D.
@@ -226,7 +346,7 @@ public:
     * Sets the joint angle offset. 
     * @param new joint angle offset _Offset. 
     */
-    void setOffset(const double _Offset) { Offset=_Offset; }
+    void setOffset(const double _Offset) { Offset=_Offset; stamp++; }
 
     /**
     * Returns the joint angle lower bound.
@@ -294,6 +414,29 @@ public:
     */
     yarp::sig::Matrix getDnH(unsigned int n=1, bool c_override=false);
 
+    /**
+    * Computes the homogeneous transformation matrix H of the Link 
+    * without resorting to heap allocation. 
+    * @param h is the fixed-size matrix filled with the result. 
+    * @param c_override if true avoid accumulating the computation 
+    *                   of previous links in the chain (false by
+    *                   default).
+    * @see getH 
+    */
+    void getH(iKinHMatrix &h, bool c_override=false) const;
+
+    /**
+    * Computes the derivative of order n of the homogeneous 
+    * transformation matrix H without resorting to heap allocation.
+    * @param dh is the fixed-size matrix filled with the result. 
+    * @param n is the order of the derivative (1 by default)
+    * @param c_override if true avoid accumulating the computation 
+    *                   of previous links in the chain (false by
+    *                   default).
+    * @see getDnH 
+    */
+    void getDnH(iKinHMatrix &dh, unsigned int n=1, bool c_override=false) const;
+
     /**
     * Default destructor. 
     */
@@ -369,10 +512,26 @@ protected:
     yarp::sig::Matrix hess_J;
     yarp::sig::Matrix hess_Jlnk;
 
+    // workspace of the allocation-free path:
+    // fast_intH[i] is the roto-translation from the root to the
+    // ith frame computed over the full set of links, while
+    // fast_stamp[i] is the stamp of the ith link used to compute
+    // fast_intH[i+1]
+    iKinHMatrix                fast_H0;
+    iKinHMatrix                fast_HN;
+    std::vector<iKinHMatrix>   fast_intH;
+    std::vector<unsigned long> fast_stamp;
+    bool                       fast_valid;
+
     virtual void clone(const iKinChain &c);
     virtual void build();
     virtual void dispose();
 
+    void updateIntH();
+    bool computeBatch(const yarp::sig::Matrix &Q, yarp::sig::Matrix &P,
+                      yarp::sig::Matrix *J, const bool axisRep,
+                      const unsigned int nThreads);
+
     yarp::sig::Vector RotAng(const yarp::sig::Matrix &R);
     yarp::sig::Vector dRotAng(const yarp::sig::Matrix &R, const yarp::sig::Matrix &dR);
     yarp::sig::Vector d2RotAng(const yarp::sig::Matrix &R, const yarp::sig::Matrix &dRi,
@@ -593,6 +752,14 @@ public:
     */
     yarp::sig::Vector setAng(const yarp::sig::Vector &q);
 
+    /**
+    * Sets the free joint angles to values of q[i] without
+    * returning them, so that no allocation takes place. 
+    * @param q is a vector containing values for DOF.
+    * @see setAng
+    */
+    void fastSetAng(const yarp::sig::Vector &q);
+
     /**
     * Returns the current free joint angles values.
     * @return the actual DOF values.
@@ -644,6 +811,14 @@ public:
     */
     yarp::sig::Matrix getH(const yarp::sig::Vector &q);
 
+    /**
+    * Computes the rigid roto-translation matrix from the root 
+    * reference frame to the end-effector frame without resorting 
+    * to heap allocation. 
+    * @param H is the fixed-size matrix filled with H(N-1)*HN.
+    */
+    void getH(iKinHMatrix &H);
+
     /**
     * Returns the coordinates of ith Link. Two notations are
     * provided: the first with Euler Angles (XYZ form=>6x1 output 
@@ -696,6 +871,48 @@ public:
     */
     yarp::sig::Vector EndEffPosition(const yarp::sig::Vector &q);
 
+    /**
+    * Computes the end-effector pose for a batch of joint 
+    * configurations at once. The configurations are processed in 
+    * blocks laid out as structure-of-arrays, so that the compiler 
+    * can vectorize the computation across them, and can be 
+    * optionally split among several threads. 
+    * @param Q is the NxDOF matrix whose rows are the joint 
+    *          configurations (angles constraints are evaluated).
+    * @param P is filled with the 7xN (axis/angle notation) or 6xN
+    *          (Euler Angles notation) matrix whose ith column is
+    *          the pose computed in the ith configuration.
+    * @param axisRep if true returns the axis/angle notation. 
+    * @param nThreads is the number of threads the batch is split 
+    *                 into (1 by default).
+    * @return true if succeed, false otherwise. 
+    * @note The current joint angles of the chain are not 
+    *       modified.
+    */
+    bool EndEffPoseBatch(const yarp::sig::Matrix &Q, yarp::sig::Matrix &P,
+                         const bool axisRep=true, const unsigned int nThreads=1);
+
+    /**
+    * Computes the end-effector pose and the geometric Jacobian for
+    * a batch of joint configurations at once. 
+    * @param Q is the NxDOF matrix whose rows are the joint 
+    *          configurations (angles constraints are evaluated).
+    * @param P is filled with the 7xN or 6xN matrix of poses.
+    * @param J is filled with the (6*DOF)xN matrix whose row 
+    *          (r*DOF+c) contains the (r,c) element of the
+    *          geometric Jacobian across the configurations.
+    * @param axisRep if true returns the axis/angle notation. 
+    * @param nThreads is the number of threads the batch is split 
+    *                 into (1 by default).
+    * @return true if succeed, false otherwise. 
+    * @note The current joint angles of the chain are not 
+    *       modified.
+    * @see EndEffPoseBatch
+    */
+    bool EndEffPoseBatch(const yarp::sig::Matrix &Q, yarp::sig::Matrix &P,
+                         yarp::sig::Matrix &J, const bool axisRep=true,
+                         const unsigned int nThreads=1);
+
     /**
     * Returns the analitical Jacobian of the ith link.
     * @param i is the Link number. 
@@ -750,6 +967,23 @@ public:
     */
     yarp::sig::Matrix GeoJacobian(const yarp::sig::Vector &q);
 
+    /**
+    * Computes the geometric Jacobian of the ith link without 
+    * resorting to heap allocation once J has the right size. 
+    * @param i is the Link number.
+    * @param J is filled with the 6x(i-1) geometric Jacobian.
+    * @note All the links are considered.
+    */
+    void GeoJacobian(const unsigned int i, yarp::sig::Matrix &J);
+
+    /**
+    * Computes the geometric Jacobian of the end-effector without 
+    * resorting to heap allocation once J has the right size. 
+    * @param J is filled with the 6xDOF geometric Jacobian.
+    * @note The blocked links are not considered.
+    */
+    void GeoJacobian(yarp::sig::Matrix &J);
+
     /**
     * Returns the 6x1 vector \f$ 
     * \partial{^2}F\left(q\right)/\partial q_i \partial q_j, \f$
@@ -788,6 +1022,17 @@ public:
     */
     yarp::sig::Vector fastHessian_ij(const unsigned int i, const unsigned int j);
 
+    /**
+    * Same as fastHessian_ij(i,j) but the result is stored in h, 
+    * so that no allocation takes place once h has the right size.
+    * @param i is the index of the first DOF. 
+    * @param j is the index of the second DOF.
+    * @param h is filled with the 6x1 Hessian vector.
+    * @see prepareForHessian
+    */
+    void fastHessian_ij(const unsigned int i, const unsigned int j,
+                        yarp::sig::Vector &h);
+
     /**
     * Returns the 6x1 vector \f$ 
     * \partial{^2}F\left(q\right)/\partial q_i \partial q_j, \f$
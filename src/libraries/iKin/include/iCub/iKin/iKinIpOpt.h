@@ -206,6 +206,7 @@ private:
 
 protected:
     void *App;
+    void *NLP;
 
     iKinChain &chain;
     iKinChain chain2ndTask;
@@ -221,6 +222,10 @@ protected:
     double lowerBoundInf;
     double upperBoundInf;
     std::string posePriority;
+    bool warmStart;
+    bool reOptimize;
+
+    void initializeApp();
 
 public:
     /**
@@ -410,6 +415,32 @@ public:
     */
     void setBoundsInf(const double lower, const double upper);
 
+    /**
+    * Enables/disables the warm start of the solver (disabled at 
+    * start-up by default). When enabled, the bound multipliers and 
+    * the constraints multipliers found at the end of the previous 
+    * successful call to solve are used as initial guess for the 
+    * dual variables, which speeds up convergence when the target 
+    * moves smoothly. 
+    * @param enable true to enable the warm start. 
+    */
+    void setWarmStart(const bool enable);
+
+    /**
+    * Returns the warm start status.
+    * @return true if the warm start is enabled.
+    */
+    bool getWarmStart() const { return warmStart; }
+
+    /**
+    * Discards the multipliers kept for the warm start, so that the 
+    * next call to solve starts from the default dual guess. 
+    * @note Useful when the next target is unrelated to the last 
+    *       one, e.g. for one-shot requests in between a stream of
+    *       targets.
+    */
+    void discardWarmStart();
+
     /**
     * Executes the IpOpt algorithm trying to converge on target. 
     * @param q0 is the vector of initial joint angles values. 
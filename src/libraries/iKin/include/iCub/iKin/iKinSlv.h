@@ -520,6 +520,11 @@ public:
     *    all intermediate points of optimization instance; allowed
     *    values are [on] or [off].
     *  
+    * \b warmStart <vocab>: example (warmStart off), selects 
+    *    whether to warm start each optimization instance of the
+    *    streamed targets from the multipliers of the previous one;
+    *    allowed values are [on] (default) or [off].
+    *  
     * \b ping_robot_tmo <double>: example (ping_robot_tmo 2.0), 
     *    specifies a timeout in seconds during which robot state
     *    ports are pinged prior to connecting; a timeout equal to
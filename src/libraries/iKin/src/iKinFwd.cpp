@@ -13,6 +13,8 @@
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <functional>
+#include <thread>
 
 #include <yarp/os/Log.h>
 
@@ -26,6 +28,243 @@ using namespace yarp::math;
 using namespace iCub::ctrl;
 using namespace iCub::iKin;
 
+namespace
+{
+    /********************************************************************/
+    template<class T>
+    inline void dRotAngOf(const T &R, const T &dR, double *dr)
+    {
+        dr[0]=(R(2,1)*dR(2,2) - R(2,2)*dR(2,1)) / (R(2,1)*R(2,1) + R(2,2)*R(2,2));
+        dr[1]=dR(2,0)/sqrt(fabs(1-R(2,0)*R(2,0)));
+        dr[2]=(R(1,0)*dR(0,0) - R(0,0)*dR(1,0)) / (R(1,0)*R(1,0) + R(0,0)*R(0,0));
+    }
+
+    /********************************************************************/
+    inline void fillGeoJacobianCol(const iKinHMatrix &Z, const iKinHMatrix &PN,
+                                   Matrix &J, const unsigned int col)
+    {
+        double dx=PN(0,3)-Z(0,3);
+        double dy=PN(1,3)-Z(1,3);
+        double dz=PN(2,3)-Z(2,3);
+
+        J(0,col)=Z(1,2)*dz-Z(2,2)*dy;
+        J(1,col)=Z(2,2)*dx-Z(0,2)*dz;
+        J(2,col)=Z(0,2)*dy-Z(1,2)*dx;
+        J(3,col)=Z(0,2);
+        J(4,col)=Z(1,2);
+        J(5,col)=Z(2,2);
+    }
+
+    // number of configurations processed together by the batch kernel
+    const size_t BATCH_LANES=8;
+
+    /********************************************************************/
+    struct BatchLink
+    {
+        double A,D,c_alpha,s_alpha,Offset;
+        double Min,Max,Ang;
+        bool   constrained;
+        int    dof;     // column of the configurations matrix, -1 if blocked
+    };
+
+    /********************************************************************/
+    struct BatchProblem
+    {
+        vector<BatchLink> links;
+        double H0[16];
+        double HN[16];
+        const double *Q;
+        size_t        dof;
+        size_t        n;
+        double       *P;
+        double       *J;
+        bool          axisRep;
+    };
+
+    /********************************************************************/
+    void batchKernel(const BatchProblem &pb, const size_t begin, const size_t end)
+    {
+        const size_t L=BATCH_LANES;
+        const size_t n=pb.n;
+        const size_t dof=pb.dof;
+
+        // T holds the upper 3x4 block of the running transformation,
+        // one row of L lanes for each element
+        double T[12][BATCH_LANES];
+        double c[BATCH_LANES],s[BATCH_LANES];
+
+        // origins and z-axes of the frames preceding the free joints
+        vector<double> zp(pb.J!=NULL ? 6*dof*L : 0);
+
+        for (size_t base=begin; base<end; base+=L)
+        {
+            size_t m=std::min(L,end-base);
+
+            for (int r=0; r<12; r++)
+                for (size_t l=0; l<L; l++)
+                    T[r][l]=pb.H0[r];
+
+            for (size_t k=0; k<pb.links.size(); k++)
+            {
+                const BatchLink &lnk=pb.links[k];
+                if (lnk.dof>=0)
+                {
+                    const double *q=pb.Q+base*dof+lnk.dof;
+                    for (size_t l=0; l<L; l++)
+                    {
+                        double ang=(l<m) ? q[l*dof] : lnk.Ang;
+                        if (lnk.constrained)
+                            ang=(ang<lnk.Min) ? lnk.Min : ((ang>lnk.Max) ? lnk.Max : ang);
+
+                        c[l]=cos(ang+lnk.Offset);
+                        s[l]=sin(ang+lnk.Offset);
+                    }
+
+                    if (pb.J!=NULL)
+                    {
+                        double *z=&zp[6*L*lnk.dof];
+                        for (int r=0; r<3; r++)
+                        {
+                            for (size_t l=0; l<L; l++)
+                            {
+                                z[r*L+l]    =T[(r<<2)+2][l];
+                                z[(r+3)*L+l]=T[(r<<2)+3][l];
+                            }
+                        }
+                    }
+                }
+                else
+                {
+                    double c_theta=cos(lnk.Ang+lnk.Offset);
+                    double s_theta=sin(lnk.Ang+lnk.Offset);
+                    for (size_t l=0; l<L; l++)
+                    {
+                        c[l]=c_theta;
+                        s[l]=s_theta;
+                    }
+                }
+
+                const double ca=lnk.c_alpha;
+                const double sa=lnk.s_alpha;
+                const double a=lnk.A;
+                const double d=lnk.D;
+
+                for (int r=0; r<12; r+=4)
+                {
+                    double *t0=T[r];
+                    double *t1=T[r+1];
+                    double *t2=T[r+2];
+                    double *t3=T[r+3];
+                    for (size_t l=0; l<L; l++)
+                    {
+                        double x=t0[l]*c[l]+t1[l]*s[l];
+                        double y=t1[l]*c[l]-t0[l]*s[l];
+                        double z=t2[l];
+                        t0[l]=x;
+                        t1[l]=y*ca+z*sa;
+                        t2[l]=z*ca-y*sa;
+                        t3[l]+=x*a+z*d;
+                    }
+                }
+            }
+
+            // T=T*HN
+            const double *HN=pb.HN;
+            for (int r=0; r<12; r+=4)
+            {
+                double *t0=T[r];
+                double *t1=T[r+1];
+                double *t2=T[r+2];
+                double *t3=T[r+3];
+                for (size_t l=0; l<L; l++)
+                {
+                    double x=t0[l],y=t1[l],z=t2[l];
+                    t0[l]=x*HN[0]+y*HN[4]+z*HN[8];
+                    t1[l]=x*HN[1]+y*HN[5]+z*HN[9];
+                    t2[l]=x*HN[2]+y*HN[6]+z*HN[10];
+                    t3[l]+=x*HN[3]+y*HN[7]+z*HN[11];
+                }
+            }
+
+            double *P=pb.P+base;
+            for (size_t l=0; l<m; l++)
+            {
+                P[l]    =T[3][l];
+                P[n+l]  =T[7][l];
+                P[2*n+l]=T[11][l];
+            }
+
+            if (pb.axisRep)
+            {
+                for (size_t l=0; l<m; l++)
+                {
+                    double v0=T[9][l]-T[6][l];
+                    double v1=T[2][l]-T[8][l];
+                    double v2=T[4][l]-T[1][l];
+                    double r=sqrt(v0*v0+v1*v1+v2*v2);
+                    double theta=atan2(0.5*r,0.5*(T[0][l]+T[5][l]+T[10][l]-1.0));
+
+                    if (r<1e-9)
+                    {
+                        // symmetric rotation: rely on the general method
+                        Matrix R=eye(4,4);
+                        for (int i=0; i<3; i++)
+                            for (int j=0; j<4; j++)
+                                R(i,j)=T[(i<<2)+j][l];
+
+                        Vector v=dcm2axis(R);
+                        P[3*n+l]=v[0];
+                        P[4*n+l]=v[1];
+                        P[5*n+l]=v[2];
+                        P[6*n+l]=v[3];
+                    }
+                    else
+                    {
+                        P[3*n+l]=v0/r;
+                        P[4*n+l]=v1/r;
+                        P[5*n+l]=v2/r;
+                        P[6*n+l]=theta;
+                    }
+                }
+            }
+            else
+            {
+                for (size_t l=0; l<m; l++)
+                {
+                    // Euler Angles as XYZ (see iKinChain::RotAng)
+                    P[3*n+l]=atan2(-T[9][l],T[10][l]);
+                    P[4*n+l]=asin(T[8][l]);
+                    P[5*n+l]=atan2(-T[4][l],T[0][l]);
+                }
+            }
+
+            if (pb.J!=NULL)
+            {
+                double *J=pb.J+base;
+                for (size_t i=0; i<dof; i++)
+                {
+                    const double *z=&zp[6*L*i];
+                    for (size_t l=0; l<m; l++)
+                    {
+                        double zx=z[l],zy=z[L+l],zz=z[2*L+l];
+                        double dx=T[3][l]-z[3*L+l];
+                        double dy=T[7][l]-z[4*L+l];
+                        double dz=T[11][l]-z[5*L+l];
+
+                        J[i*n+l]        =zy*dz-zz*dy;
+                        J[(dof+i)*n+l]  =zz*dx-zx*dz;
+                        J[(2*dof+i)*n+l]=zx*dy-zy*dx;
+                        J[(3*dof+i)*n+l]=zx;
+                        J[(4*dof+i)*n+l]=zy;
+                        J[(5*dof+i)*n+l]=zz;
+                    }
+                }
+            }
+        }
+    }
+
+}
+
 
 /************************************************************************/
 void iCub::iKin::notImplemented(const unsigned int verbose)
@@ -55,6 +294,7 @@ iKinLink::iKinLink(double _A, double _D, double _Alpha, double _Offset,
     cumulative =false;
     constrained=true;
     verbose    =0;
+    stamp      =0;
 
     H.resize(4,4);
     H.zero();
@@ -92,11 +332,16 @@ void iKinLink::clone(const iKinLink &l)
     H   =l.H;
     cumH=l.cumH;
     DnH =l.DnH;
+
+    fast_cumH=l.fast_cumH;
+
+    // the stamp is not copied: the link content has changed anyhow
+    stamp++;
 }
 
 
 /************************************************************************/
-iKinLink::iKinLink(const iKinLink &l)
+iKinLink::iKinLink(const iKinLink &l) : stamp(0)
 {
     clone(l);
 }
@@ -117,7 +362,10 @@ void iKinLink::setMin(const double _Min)
     Min=_Min;
 
     if (Ang<Min)
+    {
         Ang=Min;
+        stamp++;
+    }
 }
 
 
@@ -127,7 +375,10 @@ void iKinLink::setMax(const double _Max)
     Max=_Max;
 
     if (Ang>Max)
+    {
         Ang=Max;
+        stamp++;
+    }
 }
 
 
@@ -135,6 +386,7 @@ void iKinLink::setMax(const double _Max)
 void iKinLink::setD(const double _D)
 {
     H(2,3)=D=_D;
+    stamp++;
 }
 
 
@@ -145,6 +397,7 @@ void iKinLink::setAlpha(const double _Alpha)
 
     H(2,2)=c_alpha=cos(Alpha);
     H(2,1)=s_alpha=sin(Alpha);
+    stamp++;
 }
 
 
@@ -153,10 +406,15 @@ double iKinLink::setAng(double _Ang)
 {
     if (!blocked)
     {
+        double prevAng=Ang;
+
         if (constrained)
             Ang=(_Ang<Min) ? Min : ((_Ang>Max) ? Max : _Ang);
         else
             Ang=_Ang;
+
+        if (Ang!=prevAng)
+            stamp++;
     }
     else if (verbose)
         yWarning("Attempt to set joint angle to %g while blocked",_Ang);
@@ -166,21 +424,44 @@ double iKinLink::setAng(double _Ang)
 
 
 /************************************************************************/
-Matrix iKinLink::getH(bool c_override)
+void iKinLink::getH(iKinHMatrix &h, bool c_override) const
 {
     double theta=Ang+Offset;
     double c_theta=cos(theta);
     double s_theta=sin(theta);
 
-    H(0,0)=c_theta;
-    H(0,1)=-s_theta*c_alpha;
-    H(0,2)=s_theta*s_alpha;
-    H(0,3)=c_theta*A;
+    iKinHMatrix _h;
+    iKinHMatrix &dst=(cumulative && !c_override) ? _h : h;
+
+    dst(0,0)=c_theta;
+    dst(0,1)=-s_theta*c_alpha;
+    dst(0,2)=s_theta*s_alpha;
+    dst(0,3)=c_theta*A;
+
+    dst(1,0)=s_theta;
+    dst(1,1)=c_theta*c_alpha;
+    dst(1,2)=-c_theta*s_alpha;
+    dst(1,3)=s_theta*A;
+
+    dst(2,0)=0.0;
+    dst(2,1)=s_alpha;
+    dst(2,2)=c_alpha;
+    dst(2,3)=D;
 
-    H(1,0)=s_theta;
-    H(1,1)=c_theta*c_alpha;
-    H(1,2)=-c_theta*s_alpha;
-    H(1,3)=s_theta*A;
+    dst(3,0)=dst(3,1)=dst(3,2)=0.0;
+    dst(3,3)=1.0;
+
+    if (cumulative && !c_override)
+        iKinHMatrix::mul(fast_cumH,_h,h);
+}
+
+
+/************************************************************************/
+Matrix iKinLink::getH(bool c_override)
+{
+    iKinHMatrix h;
+    getH(h,true);
+    h.toMatrix(H);
 
     if (cumulative && !c_override)
         return cumH*H;
@@ -199,10 +480,10 @@ Matrix iKinLink::getH(double _Ang, bool c_override)
 
 
 /************************************************************************/
-Matrix iKinLink::getDnH(unsigned int n, bool c_override)
+void iKinLink::getDnH(iKinHMatrix &dh, unsigned int n, bool c_override) const
 {
     if (n==0)
-        return getH(c_override);
+        getH(dh,c_override);
     else
     {
         double theta=Ang+Offset;
@@ -211,31 +492,55 @@ Matrix iKinLink::getDnH(unsigned int n, bool c_override)
 
         int    C=(n>>1)&1 ? -1 : 1;
 
+        iKinHMatrix _dh;
+        iKinHMatrix &dst=(cumulative && !c_override) ? _dh : dh;
+
         if (n&1)
         {
-            DnH(0,0)=-C*s_theta;
-            DnH(0,1)=-C*c_theta*c_alpha;
-            DnH(0,2)=C*c_theta*s_alpha;
-            DnH(0,3)=-C*s_theta*A;
-
-            DnH(1,0)=C*c_theta;
-            DnH(1,1)=-C*s_theta*c_alpha;
-            DnH(1,2)=C*s_theta*s_alpha;
-            DnH(1,3)=C*c_theta*A;
+            dst(0,0)=-C*s_theta;
+            dst(0,1)=-C*c_theta*c_alpha;
+            dst(0,2)=C*c_theta*s_alpha;
+            dst(0,3)=-C*s_theta*A;
+
+            dst(1,0)=C*c_theta;
+            dst(1,1)=-C*s_theta*c_alpha;
+            dst(1,2)=C*s_theta*s_alpha;
+            dst(1,3)=C*c_theta*A;
         }
         else
         {
-            DnH(0,0)=C*c_theta;
-            DnH(0,1)=-C*s_theta*c_alpha;
-            DnH(0,2)=C*s_theta*s_alpha;
-            DnH(0,3)=C*c_theta*A;
-
-            DnH(1,0)=C*s_theta;
-            DnH(1,1)=C*c_theta*c_alpha;
-            DnH(1,2)=-C*c_theta*s_alpha;
-            DnH(1,3)=C*s_theta*A;
+            dst(0,0)=C*c_theta;
+            dst(0,1)=-C*s_theta*c_alpha;
+            dst(0,2)=C*s_theta*s_alpha;
+            dst(0,3)=C*c_theta*A;
+
+            dst(1,0)=C*s_theta;
+            dst(1,1)=C*c_theta*c_alpha;
+            dst(1,2)=-C*c_theta*s_alpha;
+            dst(1,3)=C*s_theta*A;
         }
 
+        // the last two rows are constant, hence their derivatives vanish
+        for (int i=8; i<16; i++)
+            dst.data[i]=0.0;
+
+        if (cumulative && !c_override)
+            iKinHMatrix::mul(fast_cumH,_dh,dh);
+    }
+}
+
+
+/************************************************************************/
+Matrix iKinLink::getDnH(unsigned int n, bool c_override)
+{
+    if (n==0)
+        return getH(c_override);
+    else
+    {
+        iKinHMatrix dh;
+        getDnH(dh,n,true);
+        dh.toMatrix(DnH);
+
         if (cumulative && !c_override)
             return cumH*DnH;
         else
@@ -249,6 +554,7 @@ void iKinLink::addCumH(const Matrix &_cumH)
 {
     cumulative=true;
     cumH=_cumH;
+    fast_cumH.fromMatrix(cumH);
 }
 
 
@@ -257,6 +563,8 @@ iKinChain::iKinChain()
 {
     N=DOF=verbose=0;
     H0=HN=eye(4,4);
+    fast_intH.resize(1);
+    fast_valid=false;
 }
 
 
@@ -271,6 +579,11 @@ void iKinChain::clone(const iKinChain &c)
     verbose  =c.verbose;
     hess_J   =c.hess_J;
     hess_Jlnk=c.hess_Jlnk;
+    fast_H0  =c.fast_H0;
+    fast_HN  =c.fast_HN;
+    fast_intH=c.fast_intH;
+    fast_stamp.assign(c.fast_stamp.begin(),c.fast_stamp.end());
+    fast_valid=c.fast_valid;
 
     allList.assign(c.allList.begin(),c.allList.end());
     quickList.assign(c.quickList.begin(),c.quickList.end());
@@ -359,6 +672,9 @@ void iKinChain::clear()
 
     N=DOF=0;
     H0=HN=eye(4,4);
+    fast_intH.resize(1);
+    fast_stamp.clear();
+    fast_valid=false;
 }
 
 
@@ -554,7 +870,14 @@ void iKinChain::build()
     }
 
     if (DOF>0)
+    {
         curr_q.resize(DOF,0);
+        hess_J.resize(6,DOF);
+    }
+
+    fast_intH.resize(N+1);
+    fast_stamp.assign(N,0);
+    fast_valid=false;
 }
 
 
@@ -595,14 +918,20 @@ bool iKinChain::setHN(const Matrix &_HN)
 
 
 /************************************************************************/
-Vector iKinChain::setAng(const Vector &q)
+void iKinChain::fastSetAng(const Vector &q)
 {
     yAssert(DOF>0);
 
     size_t sz=std::min(q.length(),(size_t)DOF);
     for (size_t i=0; i<sz; i++)
         curr_q[i]=quickList[hash_dof[i]]->setAng(q[i]);
+}
+
 
+/************************************************************************/
+Vector iKinChain::setAng(const Vector &q)
+{
+    fastSetAng(q);
     return curr_q;
 }
 
@@ -673,10 +1002,7 @@ Vector iKinChain::RotAng(const Matrix &R)
 Vector iKinChain::dRotAng(const Matrix &R, const Matrix &dR)
 {
     Vector dr(3);
-
-    dr[0]=(R(2,1)*dR(2,2) - R(2,2)*dR(2,1)) / (R(2,1)*R(2,1) + R(2,2)*R(2,2));
-    dr[1]=dR(2,0)/sqrt(fabs(1-R(2,0)*R(2,0)));
-    dr[2]=(R(1,0)*dR(0,0) - R(0,0)*dR(1,0)) / (R(1,0)*R(1,0) + R(0,0)*R(0,0));
+    dRotAngOf(R,dR,dr.data());
 
     return dr;
 }
@@ -728,30 +1054,58 @@ Vector iKinChain::d2RotAng(const Matrix &R, const Matrix &dRi,
 }
 
 
+/************************************************************************/
+void iKinChain::updateIntH()
+{
+    // H0 and HN can be directly modified by derived classes
+    iKinHMatrix _H0(H0);
+    fast_HN.fromMatrix(HN);
+
+    // the cumulative transforms are recomputed only from the first
+    // link whose content has changed since the last update onward
+    unsigned int i=0;
+    if (fast_valid && std::equal(_H0.data,_H0.data+16,fast_H0.data))
+    {
+        while ((i<N) && (allList[i]->stamp==fast_stamp[i]))
+            i++;
+    }
+    else
+    {
+        fast_H0=_H0;
+        fast_intH[0]=fast_H0;
+    }
+
+    iKinHMatrix A;
+    for (; i<N; i++)
+    {
+        allList[i]->getH(A,true);
+        iKinHMatrix::mul(fast_intH[i],A,fast_intH[i+1]);
+        fast_stamp[i]=allList[i]->stamp;
+    }
+
+    fast_valid=true;
+}
+
+
 /************************************************************************/
 Matrix iKinChain::getH(const unsigned int i, const bool allLink)
 {
-    Matrix H=H0;
-    unsigned int _i,n;
-    deque<iKinLink*> *l;
-    bool cumulHN=false;
-    bool c_override;
+    iKinHMatrix H;
 
     if (allLink)
     {
-        n=N;
-        l=&allList;
-        c_override=true;
+        yAssert(i<N);
+        updateIntH();
 
-        _i=i;
-        if (_i>=N-1)
-            cumulHN=true;
+        if (i>=N-1)
+            iKinHMatrix::mul(fast_intH[i+1],fast_HN,H);
+        else
+            H=fast_intH[i+1];
     }
     else
     {
-        n=DOF;
-        l=&quickList;
-        c_override=false;
+        unsigned int _i;
+        bool cumulHN=false;
 
         if (i==DOF)
             _i=(unsigned int)quickList.size();
@@ -760,32 +1114,48 @@ Matrix iKinChain::getH(const unsigned int i, const bool allLink)
 
         if (hash[_i]>=N-1)
             cumulHN=true;
-    }
 
-    yAssert(i<n);
+        yAssert(i<DOF);
+
+        iKinHMatrix A,tmp;
+        fast_HN.fromMatrix(HN);
+
+        H.fromMatrix(H0);
+        for (unsigned int j=0; j<=_i; j++)
+        {
+            quickList[j]->getH(A);
+            iKinHMatrix::mul(H,A,tmp);
+            H=tmp;
+        }
+
+        if (cumulHN)
+        {
+            iKinHMatrix::mul(H,fast_HN,tmp);
+            H=tmp;
+        }
+    }
 
-    for (unsigned int j=0; j<=_i; j++)
-        H*=((*l)[j]->getH(c_override));
+    return H.getMatrix();
+}
 
-    if (cumulHN)
-        H*=HN;
 
-    return H;
+/************************************************************************/
+void iKinChain::getH(iKinHMatrix &H)
+{
+    // spanning all the links is equivalent to spanning the quick list,
+    // since blocked links are accumulated within the following ones
+    updateIntH();
+    iKinHMatrix::mul(fast_intH[N],fast_HN,H);
 }
 
 
 /************************************************************************/
 Matrix iKinChain::getH()
 {
-    // may be different from DOF since one blocked link may lie
-    // at the end of the chain.
-    unsigned int n=(unsigned int)quickList.size();
-    Matrix H=H0;
-
-    for (unsigned int i=0; i<n; i++)
-        H*=quickList[i]->getH();
+    iKinHMatrix H;
+    getH(H);
 
-    return H*HN;
+    return H.getMatrix();
 }
 
 
@@ -908,38 +1278,120 @@ Vector iKinChain::EndEffPosition(const Vector &q)
 
 
 /************************************************************************/
-Matrix iKinChain::AnaJacobian(const unsigned int i, unsigned int col)
+bool iKinChain::computeBatch(const Matrix &Q, Matrix &P, Matrix *J,
+                             const bool axisRep, const unsigned int nThreads)
 {
-    yAssert(i<N);
+    if ((DOF==0) || (Q.cols()!=DOF))
+    {
+        if (verbose)
+            yError("EndEffPoseBatch() failed due to wrong configurations size: %d!=%d",
+                   (int)Q.cols(),DOF);
 
-    col=col>3 ? 3 : col;
+        return false;
+    }
 
-    Matrix J(6,i+1);
-    Matrix H,dH,_H;
-    Vector dr;
+    BatchProblem pb;
+    pb.links.resize(N);
+    for (unsigned int i=0; i<N; i++)
+    {
+        const iKinLink &l=*allList[i];
+        BatchLink &lnk=pb.links[i];
 
-    for (unsigned int j=0; j<=i; j++)
+        lnk.A=l.getA();
+        lnk.D=l.getD();
+        lnk.c_alpha=cos(l.getAlpha());
+        lnk.s_alpha=sin(l.getAlpha());
+        lnk.Offset=l.getOffset();
+        lnk.Min=l.getMin();
+        lnk.Max=l.getMax();
+        lnk.Ang=l.getAng();
+        lnk.constrained=l.getConstraint();
+        lnk.dof=-1;
+    }
+
+    for (unsigned int i=0; i<DOF; i++)
+        pb.links[hash[i]].dof=(int)i;
+
+    std::copy(H0.data(),H0.data()+16,pb.H0);
+    std::copy(HN.data(),HN.data()+16,pb.HN);
+
+    pb.n=Q.rows();
+    pb.dof=DOF;
+    pb.axisRep=axisRep;
+
+    P.resize(axisRep ? 7 : 6,pb.n);
+    if (J!=NULL)
+        J->resize(6*DOF,pb.n);
+
+    if (pb.n==0)
+        return true;
+
+    pb.Q=Q.data();
+    pb.P=P.data();
+    pb.J=(J!=NULL) ? J->data() : NULL;
+
+    // split the batch in chunks made of whole blocks of lanes
+    size_t nBlocks=(pb.n+BATCH_LANES-1)/BATCH_LANES;
+    size_t nWorkers=std::max((size_t)1,std::min((size_t)nThreads,nBlocks));
+    size_t chunk=((nBlocks+nWorkers-1)/nWorkers)*BATCH_LANES;
+
+    vector<thread> workers;
+    for (size_t w=1; w<nWorkers; w++)
     {
-        H=dH=H0;
+        size_t begin=w*chunk;
+        if (begin<pb.n)
+            workers.push_back(thread(batchKernel,std::cref(pb),begin,
+                                     std::min(begin+chunk,pb.n)));
+    }
 
-        for (unsigned int k=0; k<=i; k++)
-        {
-            _H=allList[k]->getH(true);
-            H*=_H;
+    batchKernel(pb,0,std::min(chunk,pb.n));
 
-            if (j==k)
-                dH*=allList[k]->getDnH(1,true);
-            else
-                dH*=_H;
-        }
+    for (size_t w=0; w<workers.size(); w++)
+        workers[w].join();
 
-        if (i>=N-1)
-        {
-            H*=HN;
-            dH*=HN;
-        }
+    return true;
+}
+
+
+/************************************************************************/
+bool iKinChain::EndEffPoseBatch(const Matrix &Q, Matrix &P, const bool axisRep,
+                                const unsigned int nThreads)
+{
+    return computeBatch(Q,P,NULL,axisRep,nThreads);
+}
+
+
+/************************************************************************/
+bool iKinChain::EndEffPoseBatch(const Matrix &Q, Matrix &P, Matrix &J,
+                                const bool axisRep, const unsigned int nThreads)
+{
+    return computeBatch(Q,P,&J,axisRep,nThreads);
+}
 
-        dr=dRotAng(H,dH);
+
+/************************************************************************/
+Matrix iKinChain::AnaJacobian(const unsigned int i, unsigned int col)
+{
+    yAssert(i<N);
+
+    col=col>3 ? 3 : col;
+    updateIntH();
+
+    Matrix J(6,i+1);
+    iKinHMatrix H,dH,S,A,tmp;
+    double dr[3];
+
+    // S spans the links which follow the current one
+    if (i>=N-1)
+        S=fast_HN;
+    iKinHMatrix::mul(fast_intH[i+1],S,H);
+
+    for (int j=(int)i; j>=0; j--)
+    {
+        allList[j]->getDnH(A,1,true);
+        iKinHMatrix::mul(fast_intH[j],A,tmp);
+        iKinHMatrix::mul(tmp,S,dH);
+        dRotAngOf(H,dH,dr);
 
         J(0,j)=dH(0,col);
         J(1,j)=dH(1,col);
@@ -947,6 +1399,10 @@ Matrix iKinChain::AnaJacobian(const unsigned int i, unsigned int col)
         J(3,j)=dr[0];
         J(4,j)=dr[1];
         J(5,j)=dr[2];
+
+        allList[j]->getH(A,true);
+        iKinHMatrix::mul(A,S,tmp);
+        S=tmp;
     }
 
     return J;
@@ -959,32 +1415,31 @@ Matrix iKinChain::AnaJacobian(unsigned int col)
     yAssert(DOF>0);
 
     col=col>3 ? 3 : col;
+    updateIntH();
 
-    // may be different from DOF since one blocked link may lie
-    // at the end of the chain.
-    unsigned int n=(unsigned int)quickList.size();
     Matrix J(6,DOF);
-    Matrix H,dH,_H;
-    Vector dr;
+    iKinHMatrix H,dH,S=fast_HN,A,tmp;
+    double dr[3];
 
-    for (unsigned int i=0; i<DOF; i++)
-    {
-        H=dH=H0;
+    iKinHMatrix::mul(fast_intH[N],fast_HN,H);
 
-        for (unsigned int j=0; j<n; j++)
+    // blocked links are accounted for by accumulating them in S
+    // while moving backward from the end-effector
+    int k=(int)N-1;
+    for (int i=(int)DOF-1; i>=0; i--)
+    {
+        int j=(int)hash[i];
+        for (; k>j; k--)
         {
-            _H=quickList[j]->getH();
-            H*=_H;
-
-            if (hash_dof[i]==j)
-                dH*=quickList[j]->getDnH();
-            else
-                dH*=_H;
+            allList[k]->getH(A,true);
+            iKinHMatrix::mul(A,S,tmp);
+            S=tmp;
         }
 
-        H*=HN;
-        dH*=HN;
-        dr=dRotAng(H,dH);
+        allList[j]->getDnH(A,1,true);
+        iKinHMatrix::mul(fast_intH[j],A,tmp);
+        iKinHMatrix::mul(tmp,S,dH);
+        dRotAngOf(H,dH,dr);
 
         J(0,i)=dH(0,col);
         J(1,i)=dH(1,col);
@@ -1009,72 +1464,55 @@ Matrix iKinChain::AnaJacobian(const Vector &q, unsigned int col)
 
 
 /************************************************************************/
-Matrix iKinChain::GeoJacobian(const unsigned int i)
+void iKinChain::GeoJacobian(const unsigned int i, Matrix &J)
 {
     yAssert(i<N);
 
-    Matrix J(6,i+1);
-    Matrix PN,Z;
-    Vector w;
+    updateIntH();
 
-    deque<Matrix> intH;
-    intH.push_back(H0);
-
-    for (unsigned int j=0; j<=i; j++)
-        intH.push_back(intH[j]*allList[j]->getH(true));
-
-    PN=intH[i+1];
+    iKinHMatrix PN;
     if (i>=N-1)
-        PN=PN*HN;
+        iKinHMatrix::mul(fast_intH[i+1],fast_HN,PN);
+    else
+        PN=fast_intH[i+1];
 
+    J.resize(6,i+1);
     for (unsigned int j=0; j<=i; j++)
-    {
-        Z=intH[j];
-        w=cross(Z,2,PN-Z,3);
+        fillGeoJacobianCol(fast_intH[j],PN,J,j);
+}
 
-        J(0,j)=w[0];
-        J(1,j)=w[1];
-        J(2,j)=w[2];
-        J(3,j)=Z(0,2);
-        J(4,j)=Z(1,2);
-        J(5,j)=Z(2,2);
-    }
+
+/************************************************************************/
+Matrix iKinChain::GeoJacobian(const unsigned int i)
+{
+    Matrix J(6,i+1);
+    GeoJacobian(i,J);
 
     return J;
 }
 
 
 /************************************************************************/
-Matrix iKinChain::GeoJacobian()
+void iKinChain::GeoJacobian(Matrix &J)
 {
     yAssert(DOF>0);
 
-    Matrix J(6,DOF);
-    Matrix PN,Z;
-    Vector w;
-
-    deque<Matrix> intH;
-    intH.push_back(H0);
-
-    for (unsigned int i=0; i<N; i++)
-        intH.push_back(intH[i]*allList[i]->getH(true));
+    updateIntH();
 
-    PN=intH[N]*HN;
+    iKinHMatrix PN;
+    iKinHMatrix::mul(fast_intH[N],fast_HN,PN);
 
+    J.resize(6,DOF);
     for (unsigned int i=0; i<DOF; i++)
-    {
-        unsigned int j=hash[i];
+        fillGeoJacobianCol(fast_intH[hash[i]],PN,J,i);
+}
 
-        Z=intH[j];
-        w=cross(Z,2,PN-Z,3);
 
-        J(0,i)=w[0];
-        J(1,i)=w[1];
-        J(2,i)=w[2];
-        J(3,i)=Z(0,2);
-        J(4,i)=Z(1,2);
-        J(5,i)=Z(2,2);
-    }
+/************************************************************************/
+Matrix iKinChain::GeoJacobian()
+{
+    Matrix J(6,DOF);
+    GeoJacobian(J);
 
     return J;
 }
@@ -1109,18 +1547,19 @@ void iKinChain::prepareForHessian()
         return;
     }
 
-    hess_J=GeoJacobian();
+    GeoJacobian(hess_J);
 }
 
 
 /************************************************************************/
-Vector iKinChain::fastHessian_ij(const unsigned int i, const unsigned int j)
+void iKinChain::fastHessian_ij(const unsigned int i, const unsigned int j,
+                               Vector &h)
 {
     yAssert((i<DOF) && (j<DOF));
 
     // ref. E.D. Pohl, H. Lipkin, "A New Method of Robotic Motion Control Near Singularities",
     // Advanced Robotics, 1991
-    Vector h(6,0.0);
+    h.resize(6);
     if(i<j)
     {
         //h.setSubvector(0,cross(hess_Jo,i,hess_Jl,j));
@@ -1140,6 +1579,14 @@ Vector iKinChain::fastHessian_ij(const unsigned int i, const unsigned int j)
         h[2] = hess_J(3,j)*hess_J(1,i) - hess_J(4,j)*hess_J(0,i);
         h[3]=h[4]=h[5]=0.0;
     }
+}
+
+
+/************************************************************************/
+Vector iKinChain::fastHessian_ij(const unsigned int i, const unsigned int j)
+{
+    Vector h(6);
+    fastHessian_ij(i,j,h);
 
     return h;
 }
@@ -1165,7 +1612,7 @@ void iKinChain::prepareForHessian(const unsigned int lnk)
         return;
     }
 
-    hess_Jlnk=GeoJacobian(lnk);
+    GeoJacobian(lnk,hess_Jlnk);
 }
 
 
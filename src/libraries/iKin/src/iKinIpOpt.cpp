@@ -18,6 +18,7 @@
 #include <iCub/iKin/iKinIpOpt.h>
 
 #define CAST_IPOPTAPP(x)                    (static_cast<IpoptApplication*>(x))
+#define CAST_IKINNLP(x)                     (static_cast<SmartPtr<iKin_NLP>*>(x))
 #define IKINIPOPT_SHOULDER_MAXABDUCTION     (100.0*CTRL_DEG2RAD)
 
 using namespace std;
@@ -240,17 +241,17 @@ protected:
     iKinChain &chain;
     iKinChain &chain2ndTask;
 
-    iKinLinIneqConstr &LIC;
+    iKinLinIneqConstr *LIC;
 
     unsigned int dim;
     unsigned int dim_2nd;
     unsigned int ctrlPose;
 
-    yarp::sig::Vector &xd;
-    yarp::sig::Vector &xd_2nd;
-    yarp::sig::Vector &w_2nd;
-    yarp::sig::Vector &qd_3rd;
-    yarp::sig::Vector &w_3rd;
+    yarp::sig::Vector  xd;
+    yarp::sig::Vector  xd_2nd;
+    yarp::sig::Vector  w_2nd;
+    yarp::sig::Vector  qd_3rd;
+    yarp::sig::Vector  w_3rd;
     yarp::sig::Vector  qd;
     yarp::sig::Vector  q0;
     yarp::sig::Vector  q;
@@ -266,6 +267,18 @@ protected:
     yarp::sig::Matrix  J_xyz;
     yarp::sig::Matrix  J_ang;
     yarp::sig::Matrix  J_2nd;
+    yarp::sig::Matrix  J1;
+    yarp::sig::Matrix  J2;
+    yarp::sig::Vector  h;
+    yarp::sig::Vector  h2;
+
+    // structure of the last problem handed over to IpOpt and
+    // multipliers of the last solution used to warm start
+    Index last_n;
+    Index last_m;
+    yarp::sig::Vector  z_L_prev;
+    yarp::sig::Vector  z_U_prev;
+    yarp::sig::Vector  lambda_prev;
 
     yarp::sig::Vector *e_1st;
     yarp::sig::Matrix *J_1st;
@@ -289,14 +302,15 @@ protected:
     /************************************************************************/
     virtual void computeQuantities(const Number *x)
     {
-        yarp::sig::Vector new_q(dim);
-        for (Index i=0; i<(int)dim; i++)
-            new_q[i]=x[i];
+        bool new_q=firstGo;
+        for (Index i=0; (i<(int)dim) && !new_q; i++)
+            new_q=(q[i]!=x[i]);
 
-        if (!(q==new_q) || firstGo)
+        if (new_q)
         {
             firstGo=false;
-            q=new_q;
+            for (Index i=0; i<(int)dim; i++)
+                q[i]=x[i];
 
             yarp::sig::Vector v(4,0.0);
             if (xd.length()>=7)
@@ -319,7 +333,7 @@ protected:
             e_ang[1]=v[3]*v[1];
             e_ang[2]=v[3]*v[2];
 
-            yarp::sig::Matrix J1=chain.GeoJacobian();
+            chain.GeoJacobian(J1);
             submatrix(J1,J_xyz,0,2,0,dim-1);
             submatrix(J1,J_ang,3,5,0,dim-1);
 
@@ -330,7 +344,7 @@ protected:
                 e_2nd[1]=w_2nd[1]*(xd_2nd[1]-H_2nd(1,3));
                 e_2nd[2]=w_2nd[2]*(xd_2nd[2]-H_2nd(2,3));
 
-                yarp::sig::Matrix J2=chain2ndTask.GeoJacobian();
+                chain2ndTask.GeoJacobian(J2);
 
                 for (unsigned int i=0; i<dim_2nd; i++)
                 {
@@ -344,25 +358,71 @@ protected:
                 for (unsigned int i=0; i<dim; i++)
                     e_3rd[i]=w_3rd[i]*(qd_3rd[i]-q[i]);
 
-            if (LIC.isActive())
-                linC=LIC.getC()*q;
+            if (LIC->isActive())
+                linC=LIC->getC()*q;
+        }
+    }
+
+    /************************************************************************/
+    void computeStructure(Index &n, Index &m)
+    {
+        n=dim;
+        m=1;
+
+        if (LIC->isActive())
+        {
+            int lenLower=(int)LIC->getlB().length();
+            int lenUpper=(int)LIC->getuB().length();
+
+            if (lenLower && (lenLower==lenUpper) && (LIC->getC().cols()==dim))
+                m+=lenLower;
+            else
+                LIC->setActive(false);
         }
     }
 
 
 public:
     /************************************************************************/
-    iKin_NLP(iKinChain &c, unsigned int _ctrlPose, const yarp::sig::Vector &_q0,
-             yarp::sig::Vector &_xd, double _weight2ndTask, iKinChain &_chain2ndTask,
-             yarp::sig::Vector &_xd_2nd, yarp::sig::Vector &_w_2nd, double _weight3rdTask,
-             yarp::sig::Vector &_qd_3rd, yarp::sig::Vector &_w_3rd, iKinLinIneqConstr &_LIC,
-             bool *_exhalt=NULL) :
-             chain(c), q0(_q0), xd(_xd),
-             chain2ndTask(_chain2ndTask),   xd_2nd(_xd_2nd), w_2nd(_w_2nd),
-             weight3rdTask(_weight3rdTask), qd_3rd(_qd_3rd), w_3rd(_w_3rd),
-             LIC(_LIC), 
-             exhalt(_exhalt)
+    iKin_NLP(iKinChain &c, iKinChain &_chain2ndTask) :
+             chain(c), chain2ndTask(_chain2ndTask)
+    {
+        LIC=NULL;
+        exhalt=NULL;
+        callback=NULL;
+
+        dim=dim_2nd=0;
+        ctrlPose=IKINCTRL_POSE_FULL;
+        weight2ndTask=weight3rdTask=0.0;
+
+        last_n=last_m=-1;
+
+        __obj_scaling=1.0;
+        __x_scaling  =1.0;
+        __g_scaling  =1.0;
+
+        lowerBoundInf=-std::numeric_limits<double>::max();
+        upperBoundInf=std::numeric_limits<double>::max();
+    }
+
+    /************************************************************************/
+    void setup(unsigned int _ctrlPose, const yarp::sig::Vector &_q0,
+               const yarp::sig::Vector &_xd, double _weight2ndTask,
+               const yarp::sig::Vector &_xd_2nd, const yarp::sig::Vector &_w_2nd,
+               double _weight3rdTask, const yarp::sig::Vector &_qd_3rd,
+               const yarp::sig::Vector &_w_3rd, iKinLinIneqConstr &_LIC,
+               bool *_exhalt=NULL)
     {
+        q0=_q0;
+        xd=_xd;
+        xd_2nd=_xd_2nd;
+        w_2nd=_w_2nd;
+        weight3rdTask=_weight3rdTask;
+        qd_3rd=_qd_3rd;
+        w_3rd=_w_3rd;
+        LIC=&_LIC;
+        exhalt=_exhalt;
+
         dim=chain.getDOF();
         dim_2nd=chain2ndTask.getDOF();
 
@@ -413,15 +473,23 @@ public:
         J_cst=&J_xyz;
 
         firstGo=true;
+        callback=NULL;
+    }
 
-        __obj_scaling=1.0;
-        __x_scaling  =1.0;
-        __g_scaling  =1.0;
-
-        lowerBoundInf=-std::numeric_limits<double>::max();
-        upperBoundInf=std::numeric_limits<double>::max();
+    /************************************************************************/
+    bool isStructureUnchanged()
+    {
+        Index n,m;
+        computeStructure(n,m);
+        return ((n==last_n) && (m==last_m));
+    }
 
-        callback=NULL;
+    /************************************************************************/
+    void resetWarmStart()
+    {
+        z_L_prev.clear();
+        z_U_prev.clear();
+        lambda_prev.clear();
     }
 
     /************************************************************************/
@@ -490,25 +558,15 @@ public:
     bool get_nlp_info(Index& n, Index& m, Index& nnz_jac_g, Index& nnz_h_lag,
                       IndexStyleEnum& index_style)
     {
-        n=dim;
-        m=1;
-        nnz_jac_g=dim;
+        computeStructure(n,m);
+        nnz_jac_g=m*dim;
+        nnz_h_lag=(dim*(dim+1))>>1;
 
-        if (LIC.isActive())
-        {
-            int lenLower=(int)LIC.getlB().length();
-            int lenUpper=(int)LIC.getuB().length();
+        if ((n!=last_n) || (m!=last_m))
+            resetWarmStart();
 
-            if (lenLower && (lenLower==lenUpper) && (LIC.getC().cols()==dim))
-            {
-                m+=lenLower;
-                nnz_jac_g+=lenLower*dim;
-            }
-            else
-                LIC.setActive(false);
-        }
-        
-        nnz_h_lag=(dim*(dim+1))>>1;
+        last_n=n;
+        last_m=m;
         index_style=TNLP::C_STYLE;
         
         return true;
@@ -535,8 +593,8 @@ public:
             }
             else
             {
-                g_l[i]=LIC.getlB()[i-offs];
-                g_u[i]=LIC.getuB()[i-offs];
+                g_l[i]=LIC->getlB()[i-offs];
+                g_u[i]=LIC->getuB()[i-offs];
             }
         }
 
@@ -551,6 +609,24 @@ public:
         for (Index i=0; i<n; i++)
             x[i]=q0[i];
 
+        // multipliers are requested only when warm start is enabled
+        if (init_z)
+        {
+            bool avail=((int)z_L_prev.length()==n);
+            for (Index i=0; i<n; i++)
+            {
+                z_L[i]=avail ? z_L_prev[i] : 1.0;
+                z_U[i]=avail ? z_U_prev[i] : 1.0;
+            }
+        }
+
+        if (init_lambda)
+        {
+            bool avail=((int)lambda_prev.length()==m);
+            for (Index i=0; i<m; i++)
+                lambda[i]=avail ? lambda_prev[i] : 0.0;
+        }
+
         return true;
     }
     
@@ -649,7 +725,7 @@ public:
                             offs=1;
                         }
                         else
-                            values[idx]=LIC.getC()(row-offs,col);
+                            values[idx]=LIC->getC()(row-offs,col);
                     
                         idx++;
                     }
@@ -696,7 +772,7 @@ public:
                 {
                     // warning: row and col are swapped due to asymmetry
                     // of orientation part within the hessian 
-                    yarp::sig::Vector h=chain.fastHessian_ij(col,row);
+                    chain.fastHessian_ij(col,row,h);
                     yarp::sig::Vector h_xyz(3), h_ang(3), h_zero(3,0.0);
                     h_xyz[0]=h[0];
                     h_xyz[1]=h[1];
@@ -724,7 +800,7 @@ public:
                     {    
                         // warning: row and col are swapped due to asymmetry
                         // of orientation part within the hessian 
-                        yarp::sig::Vector h2=chain2ndTask.fastHessian_ij(col,row);
+                        chain2ndTask.fastHessian_ij(col,row,h2);
                         yarp::sig::Vector h_2nd(3);
                         h_2nd[0]=(w_2nd[0]*w_2nd[0])*h2[0];
                         h_2nd[1]=(w_2nd[1]*w_2nd[1])*h2[1];
@@ -785,6 +861,25 @@ public:
             qd[i]=x[i];
 
         qd=chain.setAng(qd);
+
+        // keep the multipliers for warm starting the next solve
+        if ((status!=SUCCESS) && (status!=STOP_AT_ACCEPTABLE_POINT))
+        {
+            resetWarmStart();
+            return;
+        }
+
+        z_L_prev.resize(n);
+        z_U_prev.resize(n);
+        for (Index i=0; i<n; i++)
+        {
+            z_L_prev[i]=z_L[i];
+            z_U_prev[i]=z_U[i];
+        }
+
+        lambda_prev.resize(m);
+        for (Index i=0; i<m; i++)
+            lambda_prev[i]=lambda[i];
     }
 
     /************************************************************************/
@@ -809,6 +904,11 @@ iKinIpOptMin::iKinIpOptMin(iKinChain &c, const unsigned int _ctrlPose, const dou
 
     App=new IpoptApplication();
 
+    // the NLP is kept alive across calls to solve() so that IpOpt
+    // can re-optimize it without rebuilding its internal structures
+    NLP=new SmartPtr<iKin_NLP>(new iKin_NLP(chain,chain2ndTask));
+    warmStart=false;
+
     CAST_IPOPTAPP(App)->Options()->SetNumericValue("tol",tol);
     CAST_IPOPTAPP(App)->Options()->SetNumericValue("constr_viol_tol",constr_tol);
     CAST_IPOPTAPP(App)->Options()->SetIntegerValue("acceptable_iter",0);
@@ -825,7 +925,18 @@ iKinIpOptMin::iKinIpOptMin(iKinChain &c, const unsigned int _ctrlPose, const dou
     if (!useHessian)
         CAST_IPOPTAPP(App)->Options()->SetStringValue("hessian_approximation","limited-memory");
 
+    initializeApp();
+}
+
+
+/************************************************************************/
+void iKinIpOptMin::initializeApp()
+{
     CAST_IPOPTAPP(App)->Initialize();
+
+    // options have changed: the next solve has to go through
+    // the whole optimization setup
+    reOptimize=false;
 }
 
 
@@ -884,7 +995,7 @@ void iKinIpOptMin::setMaxIter(const int max_iter)
     else
         CAST_IPOPTAPP(App)->Options()->SetIntegerValue("max_iter",std::numeric_limits<int>::max());
 
-    CAST_IPOPTAPP(App)->Initialize();
+    initializeApp();
 }
 
 
@@ -901,7 +1012,7 @@ int iKinIpOptMin::getMaxIter() const
 void iKinIpOptMin::setMaxCpuTime(const double max_cpu_time)
 {
     CAST_IPOPTAPP(App)->Options()->SetNumericValue("max_cpu_time",max_cpu_time);
-    CAST_IPOPTAPP(App)->Initialize();
+    initializeApp();
 }
 
 
@@ -918,7 +1029,7 @@ double iKinIpOptMin::getMaxCpuTime() const
 void iKinIpOptMin::setTol(const double tol)
 {
     CAST_IPOPTAPP(App)->Options()->SetNumericValue("tol",tol);
-    CAST_IPOPTAPP(App)->Initialize();
+    initializeApp();
 }
 
 
@@ -935,7 +1046,7 @@ double iKinIpOptMin::getTol() const
 void iKinIpOptMin::setConstrTol(const double constr_tol)
 {
     CAST_IPOPTAPP(App)->Options()->SetNumericValue("constr_viol_tol",constr_tol);
-    CAST_IPOPTAPP(App)->Initialize();
+    initializeApp();
 }
 
 
@@ -953,7 +1064,7 @@ void iKinIpOptMin::setVerbosity(const unsigned int verbose)
 {
     CAST_IPOPTAPP(App)->Options()->SetIntegerValue("print_level",verbose);
 
-    CAST_IPOPTAPP(App)->Initialize();
+    initializeApp();
 }
 
 
@@ -965,7 +1076,7 @@ void iKinIpOptMin::setHessianOpt(const bool useHessian)
     else
         CAST_IPOPTAPP(App)->Options()->SetStringValue("hessian_approximation","limited-memory");
 
-    CAST_IPOPTAPP(App)->Initialize();
+    initializeApp();
 }
 
 
@@ -984,7 +1095,7 @@ void iKinIpOptMin::setUserScaling(const bool useUserScaling, const double _obj_s
     else
         CAST_IPOPTAPP(App)->Options()->SetStringValue("nlp_scaling_method","gradient-based");
 
-    CAST_IPOPTAPP(App)->Initialize();
+    initializeApp();
 }
 
 
@@ -1003,7 +1114,7 @@ void iKinIpOptMin::setDerivativeTest(const bool enableTest, const bool enable2nd
     else
         CAST_IPOPTAPP(App)->Options()->SetStringValue("derivative_test","none");
 
-    CAST_IPOPTAPP(App)->Initialize();
+    initializeApp();
 }
 
 
@@ -1023,6 +1134,31 @@ void iKinIpOptMin::setBoundsInf(const double lower, const double upper)
 
     lowerBoundInf=lower;
     upperBoundInf=upper;
+    reOptimize=false;
+}
+
+
+/************************************************************************/
+void iKinIpOptMin::setWarmStart(const bool enable)
+{
+    warmStart=enable;
+    if (warmStart)
+    {
+        CAST_IPOPTAPP(App)->Options()->SetStringValue("warm_start_init_point","yes");
+        CAST_IPOPTAPP(App)->Options()->SetNumericValue("warm_start_bound_push",1e-6);
+        CAST_IPOPTAPP(App)->Options()->SetNumericValue("warm_start_mult_bound_push",1e-6);
+    }
+    else
+        CAST_IPOPTAPP(App)->Options()->SetStringValue("warm_start_init_point","no");
+
+    initializeApp();
+}
+
+
+/************************************************************************/
+void iKinIpOptMin::discardWarmStart()
+{
+    (*CAST_IKINNLP(NLP))->resetWarmStart();
 }
 
 
@@ -1033,17 +1169,25 @@ yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Ve
                                       yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
                                       int *exit_code, bool *exhalt, iKinIterateCallback *iterate)
 {
-    SmartPtr<iKin_NLP> nlp=new iKin_NLP(chain,ctrlPose,q0,xd,
-                                        weight2ndTask,chain2ndTask,xd_2nd,w_2nd,
-                                        weight3rdTask,qd_3rd,w_3rd,
-                                        *pLIC,exhalt);
-    
+    SmartPtr<iKin_NLP> &nlp=*CAST_IKINNLP(NLP);
+    nlp->setup(ctrlPose,q0,xd,weight2ndTask,xd_2nd,w_2nd,
+               weight3rdTask,qd_3rd,w_3rd,*pLIC,exhalt);
+
     nlp->set_scaling(obj_scaling,x_scaling,g_scaling);
     nlp->set_bound_inf(lowerBoundInf,upperBoundInf);
     nlp->set_posePriority(posePriority);
     nlp->set_callback(iterate);
 
-    ApplicationReturnStatus status=CAST_IPOPTAPP(App)->OptimizeTNLP(GetRawPtr(nlp));
+    // re-optimization spares IpOpt from rebuilding the algorithm objects
+    // as well as from querying again the problem sizes and the sparsity
+    // structures of the Jacobian and the Hessian
+    ApplicationReturnStatus status;
+    if (reOptimize && nlp->isStructureUnchanged())
+        status=CAST_IPOPTAPP(App)->ReOptimizeTNLP(GetRawPtr(nlp));
+    else
+        status=CAST_IPOPTAPP(App)->OptimizeTNLP(GetRawPtr(nlp));
+
+    reOptimize=true;
 
     if (exit_code!=NULL)
         *exit_code=status;
@@ -1073,6 +1217,7 @@ yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Ve
 /************************************************************************/
 iKinIpOptMin::~iKinIpOptMin()
 {
+    delete CAST_IKINNLP(NLP);
     delete CAST_IPOPTAPP(App);
 }
 
@@ -987,10 +987,16 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
                     if (idx_3rdTask[i]!=0.0)
                         qd_3rdTask[i]=(*prt->chn)(i).getAng();
             
+                // the requested target is unrelated to the streamed ones:
+                // neither use nor leave multipliers for the warm start
+                slv->discardWarmStart();
+
                 // call the solver to converge
                 double t0=Time::now();
                 Vector q=solve(xd);
                 double t1=Time::now();
+
+                slv->discardWarmStart();
             
                 Vector x=prt->chn->EndEffPose(q);
             
@@ -1406,6 +1412,12 @@ bool CartesianSolver::open(Searchable &options)
     // enable scaling
     slv->setUserScaling(true,100.0,100.0,100.0);
 
+    // warm start the streamed targets from the previous solution
+    bool warmStart=true;
+    if (options.check("warmStart"))
+        warmStart=(options.find("warmStart").asVocab32()==IKINSLV_VOCAB_VAL_ON);
+    slv->setWarmStart(warmStart);
+
     // enforce linear inequalities constraints, if any
     if (prt->cns!=NULL)
     {
@@ -81,8 +81,7 @@ using namespace eth;
 // marco.accame: std::mutex is in unlocked state after the constructor completes
 //               that is the same behaviour of the former yarp::os::Semaphore initted w/ value 1
 std::mutex TheEthManager::managerSem {}; 
-std::mutex TheEthManager::txSem {};
-std::mutex TheEthManager::rxSem {};
+std::shared_timed_mutex TheEthManager::boardsSem {};
 
 TheEthManager* TheEthManager::handle {nullptr};
 
@@ -222,6 +221,9 @@ void ethEvalTXropframe(eth::AbstractEthResource *r, void* p)
 
     TheEthManager *ethman = reinterpret_cast<TheEthManager*>(p);
 
+    eOipv4addr_t ipv4 = r->getProperties().ipv4addr;
+    ethman->lockTX(ipv4, true);
+
 #if 0
     uint16_t numofbytes = 0;
     uint16_t numofrops = 0;
@@ -247,6 +249,8 @@ void ethEvalTXropframe(eth::AbstractEthResource *r, void* p)
     }
 
 #endif
+
+    ethman->lockTX(ipv4, false);
 }
 
 
@@ -667,10 +671,45 @@ bool TheEthManager::Reception(eOipv4addr_t from, uint64_t* data, ssize_t size)
 {
     lockRX(true);
 
+    parseRXpacket(from, data, size);
+
+    lockRX(false);
+
+
+    return(true);
+}
+
+
+bool TheEthManager::Reception(const eth::EthRXpacket* packets, size_t numofpackets)
+{
+    if(NULL == packets)
+    {
+        return false;
+    }
+
+    lockRX(true);
+
+    for(size_t i=0; i<numofpackets; i++)
+    {
+        parseRXpacket(packets[i].from, packets[i].data, packets[i].size);
+    }
+
+    lockRX(false);
+
+
+    return(true);
+}
+
+
+void TheEthManager::parseRXpacket(eOipv4addr_t from, uint64_t* data, ssize_t size)
+{
     eth::AbstractEthResource* r = ethBoards->get_resource(from);
 
     if((size >=0) && (NULL != r) && (!r->isFake()))
     {
+        // only the rx of this board is stopped, the other boards can be parsed in the meantime
+        lockRX(from, true);
+
         r->Tick();
 
         if(false == r->processRXpacket(data, size))
@@ -678,17 +717,13 @@ bool TheEthManager::Reception(eOipv4addr_t from, uint64_t* data, ssize_t size)
             yError() << "TheEthManager::Reception() cannot give a received packet of size" << size << "to EthResource because EthResource::processRXpacket() returns false.";
         }
 
+        lockRX(from, false);
     }
     else
     {
     //    adr.addr_to_string(address, sizeof(address));
     //    yError() << "TheEthManager::Reception cannot get a ethres associated to address" << address;
     }
-
-    lockRX(false);
-
-
-    return(true);
 }
 
 
@@ -730,11 +765,11 @@ bool TheEthManager::lockTX(bool on)
 {
     if(on)
     {
-        txSem.lock();
+        boardsSem.lock_shared();
     }
     else
     {
-        txSem.unlock();
+        boardsSem.unlock_shared();
     }
 
     return true;
@@ -745,11 +780,11 @@ bool TheEthManager::lockRX(bool on)
 {
     if(on)
     {
-        rxSem.lock();
+        boardsSem.lock_shared();
     }
     else
     {
-        rxSem.unlock();
+        boardsSem.unlock_shared();
     }
 
     return true;
@@ -759,13 +794,63 @@ bool TheEthManager::lockTXRX(bool on)
 {
     if(on)
     {
-        txSem.lock();
-        rxSem.lock();
+        boardsSem.lock();
+    }
+    else
+    {
+        boardsSem.unlock();
+    }
+
+    return true;
+}
+
+
+uint8_t TheEthManager::boardindex(eOipv4addr_t ipv4)
+{
+    // the same mapping used by class EthBoards
+    uint8_t index = 0;
+    eo_common_ipv4addr_to_decimal(ipv4, NULL, NULL, NULL, &index);
+    index --;
+    return (index < maxBoards) ? index : static_cast<uint8_t>(maxBoards);
+}
+
+
+bool TheEthManager::lockTX(eOipv4addr_t ipv4, bool on)
+{
+    uint8_t index = boardindex(ipv4);
+    if(index >= maxBoards)
+    {
+        return false;
+    }
+
+    if(on)
+    {
+        txBoardSem[index].lock();
+    }
+    else
+    {
+        txBoardSem[index].unlock();
+    }
+
+    return true;
+}
+
+
+bool TheEthManager::lockRX(eOipv4addr_t ipv4, bool on)
+{
+    uint8_t index = boardindex(ipv4);
+    if(index >= maxBoards)
+    {
+        return false;
+    }
+
+    if(on)
+    {
+        rxBoardSem[index].lock();
     }
     else
     {
-        rxSem.unlock();
-        txSem.unlock();
+        rxBoardSem[index].unlock();
     }
 
     return true;
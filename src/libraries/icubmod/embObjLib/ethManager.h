@@ -30,6 +30,7 @@
 #include <string>
 #include <stdio.h>
 #include <mutex>
+#include <shared_mutex>
 //#include <map>
 
 
@@ -89,7 +90,7 @@ namespace eth {
 
         enum { maxRXpacketsize = 1496, maxTXpacketsize = 1496 };
 
-        // these are the boards, their use is protected by txSem or rxSem or both of them.
+        // these are the boards, their use is protected by boardsSem: shared by tx and rx, exclusive when they are changed.
         eth::EthBoards* ethBoards;
 
     private:
@@ -125,6 +126,13 @@ namespace eth {
 
         bool Reception(eOipv4addr_t from, uint64_t* data, ssize_t size);
 
+        // it parses a batch of packets with a single acquisition of the reception lock
+        bool Reception(const eth::EthRXpacket* packets, size_t numofpackets);
+
+        // they serialise the tx or the rx of a single board. they must be called with tx or rx locked
+        bool lockTX(eOipv4addr_t ipv4, bool on);
+        bool lockRX(eOipv4addr_t ipv4, bool on);
+
         eth::AbstractEthResource* getEthResource(eOipv4addr_t ipv4);
 
         IethResource* getInterface(eOipv4addr_t ipv4, eOprotID32_t id32);
@@ -158,6 +166,12 @@ namespace eth {
         bool lockRX(bool on);
         bool lockTXRX(bool on);
 
+        // it gives the packet to the ethresource. it must be called with rx locked
+        void parseRXpacket(eOipv4addr_t from, uint64_t* data, ssize_t size);
+
+        // it returns the index of the per-board semaphores or maxBoards if the address is not valid
+        static uint8_t boardindex(eOipv4addr_t ipv4);
+
 
     private:
 
@@ -165,9 +179,13 @@ namespace eth {
 
         // this semaphore is used to ....
         static std::mutex managerSem;
-        // the following two semaphore are used separately or together to stop tx and rx if a change is done on ethboards (in startup and shutdown phases)
-        static std::mutex txSem;
-        static std::mutex rxSem;
+        // this semaphore is taken in shared mode by tx and by rx, and in exclusive mode to stop both of them if a change is done
+        // on ethboards (in startup and shutdown phases). boards are never added or removed while a packet is being parsed.
+        static std::shared_timed_mutex boardsSem;
+        // the following per-board semaphores serialise the tx or the rx of a single board, so that packets of different
+        // boards can be formed or parsed in parallel by several threads.
+        std::mutex txBoardSem[maxBoards];
+        std::mutex rxBoardSem[maxBoards];
 
         static eth::TheEthManager* handle;
 
@@ -32,8 +32,12 @@
 // - external dependencies
 // --------------------------------------------------------------------------------------------------------------------
 
+#include <algorithm>
+#include <cstring>
+
 #include <yarp/os/Network.h>
 #include <yarp/os/NetType.h>
+#include <yarp/os/Time.h>
 #include <yarp/conf/environment.h>
 
 //#include <yarp/os/SystemClock.h>
@@ -65,18 +69,36 @@ using namespace eth;
 EthReceiver::EthReceiver(int raterx): PeriodicThread((double)raterx/1000.0, yarp::os::ShouldUseSystemClock::Yes, yarp::os::PeriodicThreadClock::Absolute)
 {
     rateofthread = raterx;
+    recv_socket = nullptr;
+    ethManager = nullptr;
     yDebug() << "EthReceiver is a PeriodicThread with rxrate =" << rateofthread << "ms";
-    // ok, and now i get it from xml file ... if i find it.
-
-//    std::string tmp = yarp::conf::environment::get_string("ETHSTAT_PRINT_INTERVAL");
-//    if (tmp != "")
-//    {
-//        statPrintInterval = (double)yarp::conf::numeric::from_string(tmp, 0.);
-//    }
-//    else
-//    {
-//        statPrintInterval = 0.0;
-//    }
+
+    // the user can enable the periodic print of the reception statistics [sec] by environment variable ETHSTAT_PRINT_INTERVAL
+    std::string tmp = yarp::conf::environment::get_string("ETHSTAT_PRINT_INTERVAL");
+    if (tmp != "")
+    {
+        statPrintInterval = yarp::conf::numeric::from_string(tmp, 0.0);
+    }
+    else
+    {
+        statPrintInterval = 0.0;
+    }
+    statLastPrint = 0.0;
+    statNumOfPackets = 0;
+    statNumOfSyscalls = 0;
+
+    // the user can change the number of packets retrieved by a single syscall by environment variable ETHRECEIVER_BATCH_SIZE
+#if defined(__linux__)
+    batchsize = EthReceiverDefaultBatchSize;
+#else
+    batchsize = 1;
+#endif
+    std::string _batch_size = yarp::conf::environment::get_string("ETHRECEIVER_BATCH_SIZE");
+    if (_batch_size != "")
+    {
+        batchsize = yarp::conf::numeric::from_string(_batch_size, 1);
+        batchsize = std::max(1, std::min(batchsize, static_cast<int>(EthReceiverMaxBatchSize)));
+    }
 #ifdef NETWORK_PERFORMANCE_BENCHMARK 
     /* We would like to verify if the receiver thread is ticked(running) every 5 millisecond, with a tollerance of 0.05 millisec.
        the m_perEvtVerifier object after 1 second, prints an istogram with values from 4 to 6 millisec with a step of 0.1 millisec
@@ -138,6 +160,35 @@ bool EthReceiver::config(ACE_SOCK_Dgram *pSocket, TheEthManager* _ethManager)
     recv_socket->enable(ACE_NONBLOCK);
 #endif
 
+#if defined(__linux__)
+    // the ring of buffers is allocated once in here, and the message headers point to it for the whole life of the thread
+    if (batchsize > 1)
+    {
+        const size_t slotsize = TheEthManager::maxRXpacketsize/8;   // in uint64_t units: every slot stays 8-byte aligned
+        rxBuffers.resize(batchsize*slotsize);
+        rxMessages.resize(batchsize);
+        rxIOvectors.resize(batchsize);
+        rxAddresses.resize(batchsize);
+        rxPackets.resize(batchsize);
+
+        for (int i=0; i<batchsize; i++)
+        {
+            rxIOvectors[i].iov_base = &rxBuffers[i*slotsize];
+            rxIOvectors[i].iov_len  = TheEthManager::maxRXpacketsize;
+
+            std::memset(&rxMessages[i], 0, sizeof(rxMessages[i]));
+            rxMessages[i].msg_hdr.msg_iov     = &rxIOvectors[i];
+            rxMessages[i].msg_hdr.msg_iovlen  = 1;
+            rxMessages[i].msg_hdr.msg_name    = &rxAddresses[i];
+            rxMessages[i].msg_hdr.msg_namelen = sizeof(rxAddresses[i]);
+
+            rxPackets[i].data = &rxBuffers[i*slotsize];
+        }
+    }
+#endif
+
+    yDebug() << "EthReceiver retrieves up to" << batchsize << "packets per syscall";
+
     return true;
 }
 
@@ -170,20 +221,9 @@ uint64_t getRopFrameAge(char *pck)
 
 void EthReceiver::run()
 {
-    ssize_t       incoming_msg_size = 0;
-    ACE_INET_Addr sender_addr;
-    uint64_t      incoming_msg_data[TheEthManager::maxRXpacketsize/8];   // 8-byte aligned local buffer for incoming packet: it must be able to accomodate max size of packet
-    const ssize_t incoming_msg_capacity = TheEthManager::maxRXpacketsize;
-
 #ifdef NETWORK_PERFORMANCE_BENCHMARK
     m_perEvtVerifier.tick(yarp::os::Time::now());
 #endif
-    
-    
-    int flags = 0;
-#ifndef WIN32
-    flags |= MSG_DONTWAIT;
-#endif
 
     static uint8_t earlyexit_prev = 0;
     static uint8_t earlyexit_prevprev = 0;
@@ -201,22 +241,129 @@ void EthReceiver::run()
     earlyexit_prevprev = earlyexit_prev;    // save previous early exit
     earlyexit_prev = 0;                     // consider no early exit this time
 
+    bool earlyexit = false;
+#if defined(__linux__)
+    if(batchsize > 1)
+    {
+        earlyexit = receiveBatch(maxUDPpackets);
+    }
+    else
+#endif
+    {
+        earlyexit = receiveSingle(maxUDPpackets);
+    }
+
+    if(earlyexit)
+    {
+        earlyexit_prev = 1; // yes, we have an early exit
+    }
+
+    if(statPrintInterval > 0)
+    {
+        printStatistics();
+    }
+
+    // execute the check on presence of all eth boards.
+    ethManager->CheckPresence();
+}
+
+
+bool EthReceiver::receiveSingle(int maxUDPpackets)
+{
+    ssize_t       incoming_msg_size = 0;
+    ACE_INET_Addr sender_addr;
+    uint64_t      incoming_msg_data[TheEthManager::maxRXpacketsize/8];   // 8-byte aligned local buffer for incoming packet: it must be able to accomodate max size of packet
+    const ssize_t incoming_msg_capacity = TheEthManager::maxRXpacketsize;
+
+    int flags = 0;
+#ifndef WIN32
+    flags |= MSG_DONTWAIT;
+#endif
+
     for(int i=0; i<maxUDPpackets; i++)
     {
         incoming_msg_size = recv_socket->recv((void *) incoming_msg_data, incoming_msg_capacity, sender_addr, flags);
+        statNumOfSyscalls++;
         if(incoming_msg_size <= 0)
         { // marco.accame: i prefer using <= 0.
-            earlyexit_prev = 1; // yes, we have an early exit
-            break; // we break and do not return because we want to be sure to execute what is after the for() loop
+            return true; // yes, we have an early exit
         }
 
         // we have a packet ... we give it to the ethmanager for it parsing
-        //bool collectStatistics = (statPrintInterval > 0) ? true : false;
+        statNumOfPackets++;
         ethManager->Reception(ethManager->toipv4addr(sender_addr), incoming_msg_data, incoming_msg_size);
     }
 
-    // execute the check on presence of all eth boards.
-    ethManager->CheckPresence();
+    return false;
+}
+
+
+#if defined(__linux__)
+bool EthReceiver::receiveBatch(int maxUDPpackets)
+{
+    ACE_HANDLE sockfd = recv_socket->get_handle();
+
+    int remaining = maxUDPpackets;
+    while(remaining > 0)
+    {
+        unsigned int vlen = std::min(remaining, batchsize);
+
+        // the kernel overwrites the length of the sender address, thus we restore it before every call
+        for(unsigned int i=0; i<vlen; i++)
+        {
+            rxMessages[i].msg_hdr.msg_namelen = sizeof(rxAddresses[i]);
+        }
+
+        int n = recvmmsg(sockfd, rxMessages.data(), vlen, MSG_DONTWAIT, nullptr);
+        statNumOfSyscalls++;
+        if(n <= 0)
+        {
+            return true; // early exit: the socket is empty
+        }
+
+        statNumOfPackets += n;
+
+        for(int i=0; i<n; i++)
+        {
+            uint32_t a32 = ntohl(rxAddresses[i].sin_addr.s_addr);
+            rxPackets[i].from = eo_common_ipv4addr((a32 >> 24) & 0xff, (a32 >> 16) & 0xff, (a32 >> 8) & 0xff, a32 & 0xff);
+            rxPackets[i].size = rxMessages[i].msg_len;
+        }
+
+        // the whole batch is parsed with a single acquisition of the reception lock
+        ethManager->Reception(rxPackets.data(), n);
+
+        remaining -= n;
+        if(n < static_cast<int>(vlen))
+        {
+            return true; // early exit: the socket has been drained
+        }
+    }
+
+    return false;
+}
+#endif
+
+
+void EthReceiver::printStatistics(void)
+{
+    double now = yarp::os::Time::now();
+    if(0.0 == statLastPrint)
+    {
+        statLastPrint = now;
+        return;
+    }
+
+    if((now - statLastPrint) >= statPrintInterval)
+    {
+        double ratio = (statNumOfSyscalls > 0) ? (double)statNumOfPackets / (double)statNumOfSyscalls : 0.0;
+        yDebug() << "EthReceiver: in the last" << (now - statLastPrint) << "sec it has received" << statNumOfPackets
+                 << "packets with" << statNumOfSyscalls << "syscalls, i.e.," << ratio << "packets per syscall";
+
+        statLastPrint = now;
+        statNumOfPackets = 0;
+        statNumOfSyscalls = 0;
+    }
 }
 
 
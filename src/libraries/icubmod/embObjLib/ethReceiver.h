@@ -33,6 +33,15 @@
 
 #include <yarp/os/PeriodicThread.h>
 
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+#include "EoCommon.h"
+
 
 #ifdef NETWORK_PERFORMANCE_BENCHMARK 
 #include <./tools/include/PeriodicEventsVerifier.h>
@@ -43,6 +52,16 @@ namespace eth {
 
     class TheEthManager;
 
+    // -- struct EthRXpacket
+    // -- it describes a received UDP packet in the form used by TheEthManager::Reception()
+
+    struct EthRXpacket
+    {
+        eOipv4addr_t    from;
+        uint64_t*       data;
+        ssize_t         size;
+    };
+
     class EthReceiver : public yarp::os::PeriodicThread
     {
     private:
@@ -51,13 +70,32 @@ namespace eth {
         ACE_SOCK_Dgram *recv_socket;
         eth::TheEthManager *ethManager;
         double statPrintInterval;
+        double statLastPrint;
+        uint64_t statNumOfPackets;
+        uint64_t statNumOfSyscalls;
 #ifdef NETWORK_PERFORMANCE_BENCHMARK 
         Tools::Emb_PeriodicEventVerifier m_perEvtVerifier;
 #endif
 
+        // batched reception: up to batchsize packets are retrieved by a single recvmmsg() into a ring of
+        // preallocated buffers and are then given to TheEthManager all together. batchsize = 1 uses recv() instead.
+        int batchsize;
+#if defined(__linux__)
+        std::vector<uint64_t> rxBuffers;
+        std::vector<struct mmsghdr> rxMessages;
+        std::vector<struct iovec> rxIOvectors;
+        std::vector<struct sockaddr_in> rxAddresses;
+        std::vector<eth::EthRXpacket> rxPackets;
+
+        bool receiveBatch(int maxUDPpackets);
+#endif
+        bool receiveSingle(int maxUDPpackets);
+        void printStatistics(void);
+
     public:
 
         enum { EthReceiverDefaultRate = 5, EthReceiverMaxRate = 20 };
+        enum { EthReceiverDefaultBatchSize = 32, EthReceiverMaxBatchSize = 128 };
 
         EthReceiver(int rxrate);
         ~EthReceiver();
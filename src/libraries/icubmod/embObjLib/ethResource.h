@@ -71,9 +71,15 @@ namespace eth {
         // FAKE: it just returns true.
         bool setcheckRemoteValue(const eOprotID32_t id32, void *value, const unsigned int retries = 10, const double waitbeforecheck = 0.001, const double timeout = 0.050);
 
+        // it sets and verifies many values with a pipelined transaction: a single wait for all of them
+        bool setcheckRemoteValues(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries = 10, const double waitbeforecheck = 0.001, const double timeout = 0.500);
+
         // FAKE: it just returns true.
         bool getLocalValue(const eOprotID32_t id32, void *value);
 
+        // it copies many values of the same endpoint under a single lock. the i-th value goes at offset i*itemsize of values
+        bool getLocalValues(const std::vector<eOprotID32_t> &id32s, void *values, const size_t itemsize);
+
         // FAKE: it just returns true.
         bool setLocalValue(eOprotID32_t id32, const void *value, bool overrideROprotection = false);
 
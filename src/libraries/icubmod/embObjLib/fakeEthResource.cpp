@@ -249,6 +249,11 @@ bool FakeEthResource::setcheckRemoteValue(const eOprotID32_t id32, void *value,
     return true;
 }
 
+bool FakeEthResource::setcheckRemoteValues(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries, const double waitbeforecheck, const double timeout)
+{
+    return true;
+}
+
 
 
 bool FakeEthResource::CANPrintHandler(eOmn_info_basic_t *infobasic)
@@ -298,6 +303,11 @@ bool FakeEthResource::getLocalValue(const eOprotID32_t id32, void *data)
     return ret;
 }
 
+bool FakeEthResource::getLocalValues(const std::vector<eOprotID32_t> &id32s, void *values, const size_t itemsize)
+{
+    return transceiver.read(id32s, values, itemsize);
+}
+
 bool FakeEthResource::setLocalValue(eOprotID32_t id32, const void *value, bool overrideROprotection)
 {
     return transceiver.write(id32, value, overrideROprotection);
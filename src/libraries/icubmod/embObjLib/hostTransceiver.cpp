@@ -31,6 +31,7 @@ using namespace std;
 #include "FeatureInterface.h"
 
 #include "EOYmutex.h"
+#include "EOVmutex.h"
 #include "EOYtheSystem.h"
 #include "EOtheErrorManager.h"
 #include "EoCommon.h"
@@ -523,6 +524,91 @@ bool HostTransceiver::read(const eOprotID32_t id32, void *data)
 
 
 
+bool HostTransceiver::read(const std::vector<eOprotID32_t> &id32s, void *data, const size_t itemsize)
+{
+    if(NULL == data)
+    {
+        yError() << "HostTransceiver::read() called w/ NULL data";
+        return false;
+    }
+
+    if(true == id32s.empty())
+    {
+        return true;
+    }
+
+    // all the variables must belong to the same endpoint: with eo_nvset_protection_one_per_endpoint they share the same mutex
+    const eOprot_endpoint_t ep = eoprot_ID2endpoint(id32s[0]);
+    for(size_t i=0; i<id32s.size(); i++)
+    {
+        if((eobool_false == eoprot_id_isvalid(protboardnumber, id32s[i])) || (ep != eoprot_ID2endpoint(id32s[i])))
+        {
+            char nvinfo[128];
+            eoprot_ID2information(id32s[i], nvinfo, sizeof(nvinfo));
+            yError() << "HostTransceiver::read() called w/ invalid protid or w/ mixed endpoints: BOARD w/ IP" << remoteipstring <<
+                        "with id: " << nvinfo;
+            return false;
+        }
+    }
+
+    EOnv nv;
+    if(NULL == getnvhandler(id32s[0], &nv))
+    {
+        return false;
+    }
+
+    // we take the protection only once and we copy directly from the ram of the nvs, rather than
+    // calling eo_nv_Get() which would take and release the same mutex for every variable.
+    EOVmutexDerived *mtx = nv.mtx;
+
+    bool ret = true;
+    size_t failed = 0;
+    uint8_t *dest = reinterpret_cast<uint8_t *>(data);
+
+    lock_nvs(true);
+    if(NULL != mtx)
+    {
+        eov_mutex_Take(mtx, eok_reltimeINFINITE);
+    }
+
+    for(size_t i=0; i<id32s.size(); i++)
+    {
+        if((i > 0) && (eores_OK != eo_nvset_NV_Get(nvset, id32s[i], &nv)))
+        {
+            ret = false;
+            failed = i;
+            break;
+        }
+
+        const uint16_t size = eo_nv_Size(&nv);
+        if(size > itemsize)
+        {
+            ret = false;
+            failed = i;
+            break;
+        }
+
+        memcpy(dest + i*itemsize, eo_nv_RAM(&nv), size);
+    }
+
+    if(NULL != mtx)
+    {
+        eov_mutex_Release(mtx);
+    }
+    lock_nvs(false);
+
+    if(false == ret)
+    {
+        char nvinfo[128];
+        eoprot_ID2information(id32s[failed], nvinfo, sizeof(nvinfo));
+        yError() << "HostTransceiver::read() cannot read in bulk: BOARD w/ IP" << remoteipstring << "with id: " << nvinfo << "and itemsize" << itemsize;
+    }
+
+    return ret;
+}
+
+
+
 // somebody passes the received packet - this is used just as an interface
 bool HostTransceiver::parseUDP(const void *data, const uint16_t size)
 {
@@ -46,6 +46,7 @@
 #include "EoProtocol.h"
 
 #include <mutex>
+#include <vector>
 
 #include <yarp/os/Searchable.h>
 
@@ -82,6 +83,10 @@ namespace eth {
         // reads locally.
         bool read(const eOprotID32_t id32, void *data);
 
+        // reads locally many variables of the same endpoint with a single lock, so that they are a coherent snapshot.
+        // the i-th value is copied at offset i*itemsize inside data, which must have room for id32s.size() items.
+        bool read(const std::vector<eOprotID32_t> &id32s, void *data, const size_t itemsize);
+
         // writes locally
         bool write(const eOprotID32_t id32, const void* data, bool forcewriteOfReadOnly);
 
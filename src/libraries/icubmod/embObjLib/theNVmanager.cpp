@@ -39,6 +39,7 @@
 #include <chrono>
 #include <map>
 #include <cstring>
+#include <numeric>
 
 #include "EoProtocol.h"
 #include "EoProtocolMN.h"
@@ -109,13 +110,16 @@ struct eth::theNVmanager::Impl
             timeofwait = SystemClock::nowSystem();
             const int timeout_millis = static_cast<int>(1000.0 * timeout);
             std::unique_lock<std::mutex> lck(mtx_semaphore);
-            bool r = (cv_semaphore.wait_for(lck, std::chrono::milliseconds(timeout_millis)) == cv_status::no_timeout);
+            // the predicate makes sure we dont miss the replies which arrive before we start to wait. it is likely to happen
+            // when many ROPs are loaded in the same transaction, because the first ones are transmitted while we load the others.
+            bool r = cv_semaphore.wait_for(lck, std::chrono::milliseconds(timeout_millis), [this]() { return receivedrops >= expectedrops; });
             numofrxrops = receivedrops;
             return r;
         }
 
         bool post()
         {
+            std::lock_guard<std::mutex> lck(mtx_semaphore);
             receivedrops++;
             if(receivedrops == expectedrops)
             {
@@ -289,6 +293,7 @@ struct eth::theNVmanager::Impl
 
     bool set(eth::HostTransceiver *t, const eOprotID32_t id32, const void *value);
     bool setcheck(eth::HostTransceiver *t, const eOprotID32_t id32, const void *value, const unsigned int retries, double waitbeforecheck, double timeout);
+    bool setcheck(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries, double waitbeforecheck, double timeout);
     
 
     //size_t maxSizeOfNV(const eOprotIP_t ipv4);
@@ -586,6 +591,107 @@ bool eth::theNVmanager::Impl::setcheck(eth::HostTransceiver *t, const eOprotID32
 }
 
 
+bool eth::theNVmanager::Impl::setcheck(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries, double waitbeforecheck, double timeout)
+{
+    if(false == validparameters(t, id32s, values))
+    {
+        return false;
+    }
+
+    // the values read back are stored in a single buffer where each variable has its own slot
+    std::vector<size_t> offsets(id32s.size());
+    size_t totalsize = 0;
+    for(size_t i=0; i<id32s.size(); i++)
+    {
+        offsets[i] = totalsize;
+        totalsize += sizeofnv(id32s[i]);
+    }
+    std::vector<std::uint8_t> readback(totalsize);
+
+    // the indices of the variables not verified yet
+    std::vector<size_t> pending(id32s.size());
+    std::iota(pending.begin(), pending.end(), 0);
+
+    std::vector<eOprotID32_t> askids;
+    std::vector<void*> askvalues;
+    std::vector<size_t> mismatched;
+
+    int maxattempts = retries + 1;
+    int attempt = 0;
+
+    for(attempt=0; (attempt<maxattempts) && (false == pending.empty()); attempt++)
+    {
+        // 1. we load all the set<> ROPs before waiting, so that they travel together in the same UDP frames
+        bool loaded = true;
+        for(size_t i : pending)
+        {
+            if(false == set(t, id32s[i], values[i]))
+            {
+                loaded = false;
+                break;
+            }
+        }
+
+        if(false == loaded)
+        {
+            const AbstractEthResource::Properties & props = getboardproperties(t);
+            yWarning() << "theNVmanager::Impl::setcheck(vector<>) had an error while calling set() in BOARD" << props.boardnameString << "with IP" << props.ipv4addrString << "at attempt #" << attempt+1;
+            continue;
+        }
+
+        // 2. we wait only once for all of them and then we ask them back with a single transaction
+        SystemClock::delaySystem(waitbeforecheck);
+
+        askids.clear();
+        askvalues.clear();
+        for(size_t i : pending)
+        {
+            askids.push_back(id32s[i]);
+            askvalues.push_back(&readback[offsets[i]]);
+        }
+
+        if(false == ask(t, askids, askvalues, timeout))
+        {
+            const AbstractEthResource::Properties & props = getboardproperties(t);
+            yWarning() << "theNVmanager::Impl::setcheck(vector<>) had an error while calling ask() in BOARD" << props.boardnameString << "with IP" << props.ipv4addrString << "at attempt #" << attempt+1;
+            continue;
+        }
+
+        // 3. only the variables which differ are sent again
+        mismatched.clear();
+        for(size_t i : pending)
+        {
+            if(0 != std::memcmp(values[i], &readback[offsets[i]], sizeofnv(id32s[i])))
+            {
+                mismatched.push_back(i);
+            }
+        }
+        pending.swap(mismatched);
+    }
+
+
+    if(pending.empty())
+    {
+        if(attempt > 1)
+        {
+            const AbstractEthResource::Properties & props = getboardproperties(t);
+            yWarning() << "theNVmanager::Impl::setcheck(vector<>) has set and verified" << id32s.size() << "IDs in BOARD" << props.boardnameString << "with IP" << props.ipv4addrString << "at attempt #" << attempt;
+        }
+    }
+    else
+    {
+        const AbstractEthResource::Properties & props = getboardproperties(t);
+        for(size_t i : pending)
+        {
+            yError() << "FATAL: theNVmanager::Impl::setcheck(vector<>) could not set and verify ID" << getid32string(id32s[i]) << "in BOARD" << props.boardnameString << "with IP" << props.ipv4addrString << " even after " << attempt << "attempts";
+        }
+    }
+
+
+    return(pending.empty());
+}
+
+
 bool eth::theNVmanager::Impl::check(eth::HostTransceiver *t, const eOprotID32_t id32, const void *value, const double timeout, const unsigned int retries)
 {    
     if(false == validparameters(t, id32, value))
@@ -952,7 +1058,7 @@ bool eth::theNVmanager::Impl::ask(eth::HostTransceiver *t, const std::vector<eOp
     // 4. must wait now and manage a possible timeout
     std::uint16_t numberOfReceivedROPs = 0;
 
-    if(false == transaction->wait(numberOfReceivedROPs))
+    if(false == transaction->wait(numberOfReceivedROPs, timeout))
     {
         // a timeout occurred .... manage it.
 
@@ -1218,6 +1324,17 @@ bool eth::theNVmanager::setcheck(eth::HostTransceiver *t, const eOprotID32_t id3
     return pImpl->setcheck(t, id32, value, retries, waitbeforecheck, timeout);
 }
 
+bool eth::theNVmanager::setcheck(const eOprotIP_t ipv4, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries, double waitbeforecheck, double timeout)
+{
+    eth::HostTransceiver *t = pImpl->transceiver(ipv4);
+    return pImpl->setcheck(t, id32s, values, retries, waitbeforecheck, timeout);
+}
+
+bool eth::theNVmanager::setcheck(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries, double waitbeforecheck, double timeout)
+{
+    return pImpl->setcheck(t, id32s, values, retries, waitbeforecheck, timeout);
+}
+
 bool eth::theNVmanager::onarrival(const ropCode ropcode, const eOprotIP_t ipv4, const eOprotID32_t id32, const std::uint32_t signature)
 {
     return pImpl->onarrival(ropcode, ipv4, id32, signature);
@@ -97,6 +97,13 @@ namespace eth {
         bool ask(const eOprotIP_t ipv4, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout = 0.5);
         bool ask(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout = 0.5);
 
+        // pipelined version of setcheck() for many network variables of the same ip address. all the set<> ROPs are loaded
+        // one after the other so that they share the UDP frames, then a single parallel ask() reads them back and waits all
+        // the replies together. only the variables which are not verified are sent again, at most retries + 1 times.
+        // different threads can call it at the same time on different boards, as every call uses its own signature.
+        bool setcheck(const eOprotIP_t ipv4, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries = 10, double waitbeforecheck = 0.001, double timeout = 0.5);
+        bool setcheck(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries = 10, double waitbeforecheck = 0.001, double timeout = 0.5);
+
 
         // tobedone: i want to group several requests before i start to wait.
         // i need:
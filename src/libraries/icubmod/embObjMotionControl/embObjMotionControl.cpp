@@ -134,6 +134,16 @@ bool embObjMotionControl::alloc(int nj)
     _temperatureExceededLimitWatchdog.resize(nj);
     _temperatureSensorErrorWatchdog.resize(nj); 
     _temperatureSpikesFilter.resize(nj);
+
+    _jointStatusCoreID32s.resize(nj);
+    _motorStatusBasicID32s.resize(nj);
+    _jointStatusCoreSnapshot.resize(nj);
+    _motorStatusBasicSnapshot.resize(nj);
+    for(int i = 0; i < nj; ++i)
+    {
+        _jointStatusCoreID32s[i] = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, i, eoprot_tag_mc_joint_status_core);
+        _motorStatusBasicID32s[i] = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, i, eoprot_tag_mc_motor_status_basic);
+    }
     
     // update threshold for watchdog parametrized on the ROP transmission rate (by default is 2ms)
     uint8_t txrate = res->getProperties().txROPratedivider;
@@ -1378,15 +1388,21 @@ bool embObjMotionControl::init()
 
 
 
+    // the configurations of all joints, of all motors and of the controller are sent in this order with a single
+    // pipelined transaction: the set<> ROPs share the same UDP frames and the replies of the verification are waited all together
+    std::vector<eOprotID32_t> id32s;
+    std::vector<void*> values;
+
     //////////////////////////////////////////
     // invia la configurazione dei GIUNTI   //
     //////////////////////////////////////////
+    std::vector<eOmc_joint_config_t> jconfigs(_njoints);
     for(int logico=0; logico< _njoints; logico++)
     {
         int fisico = _axisMap[logico];
         protid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, fisico, eoprot_tag_mc_joint_config);
 
-        eOmc_joint_config_t jconfig = {0};
+        eOmc_joint_config_t &jconfig = jconfigs[logico];
         memset(&jconfig, 0, sizeof(eOmc_joint_config_t));
         yarp::dev::Pid tmp; 
         tmp = _measureConverter->convert_pid_to_machine(yarp::dev::VOCAB_PIDTYPE_POSITION,_trj_pids[logico].pid, fisico);
@@ -1445,18 +1461,8 @@ bool embObjMotionControl::init()
         jconfig.kalman_params.R = _kalman_params[logico].R;
         jconfig.kalman_params.P0 = _kalman_params[logico].P0;
 
-        if(false == res->setcheckRemoteValue(protid, &jconfig, 10, 0.010, 0.050))
-        {
-            yError() << "FATAL: embObjMotionControl::init() had an error while calling setcheckRemoteValue() for joint config fisico #" << fisico << "in "<< getBoardInfo();
-            return false;
-        }
-        else
-        {
-            if(behFlags.verbosewhenok)
-            {
-                yDebug() << "embObjMotionControl::init() correctly configured joint config fisico #" << fisico << "in "<< getBoardInfo();
-            }
-        }
+        id32s.push_back(protid);
+        values.push_back(&jconfig);
     }
 
 
@@ -1465,12 +1471,14 @@ bool embObjMotionControl::init()
     //////////////////////////////////////////
 
 
+    std::vector<eOmc_motor_config_t> motor_cfgs(_njoints);
     for(int logico=0; logico<_njoints; logico++)
     {
         int fisico = _axisMap[logico];
 
         protid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, fisico, eoprot_tag_mc_motor_config);
-        eOmc_motor_config_t motor_cfg = {0};
+        eOmc_motor_config_t &motor_cfg = motor_cfgs[logico];
+        memset(&motor_cfg, 0, sizeof(eOmc_motor_config_t));
         motor_cfg.maxvelocityofmotor = 0;//_maxMotorVelocity[logico]; //unused yet!
         motor_cfg.currentLimits.nominalCurrent = _currentLimits[logico].nominalCurrent;
         motor_cfg.currentLimits.overloadCurrent = _currentLimits[logico].overloadCurrent;
@@ -1509,18 +1517,8 @@ bool embObjMotionControl::init()
         tmp = _measureConverter->convert_pid_to_machine(yarp::dev::VOCAB_PIDTYPE_VELOCITY, _spd_pids[logico].pid, fisico);
         copyPid_iCub2eo(&tmp, &motor_cfg.pidspeed);
 
-        if (false == res->setcheckRemoteValue(protid, &motor_cfg, 10, 0.010, 0.050))
-        {
-            yError() << "FATAL: embObjMotionControl::init() had an error while calling setcheckRemoteValue() for motor config fisico #" << fisico << "in "<< getBoardInfo();
-            return false;
-        }
-        else
-        {
-            if (behFlags.verbosewhenok)
-            {
-                yDebug() << "embObjMotionControl::init() correctly configured motor config fisico #" << fisico << "in "<< getBoardInfo();
-            }
-        }
+        id32s.push_back(protid);
+        values.push_back(&motor_cfg);
     }
 
     /////////////////////////////////////////////
@@ -1534,16 +1532,19 @@ bool embObjMotionControl::init()
     controller_cfg.durationofctrlloop = (uint32_t)bdata.settings.txconfig.cycletime;
     controller_cfg.enableskiprecalibration = _maintenanceModeCfg.enableSkipRecalibration;
 
-    if(false == res->setcheckRemoteValue(protid, &controller_cfg, 10, 0.010, 0.050))
+    id32s.push_back(protid);
+    values.push_back(&controller_cfg);
+
+    if(false == res->setcheckRemoteValues(id32s, values, 10, 0.010, 0.500))
     {
-        yError() << "FATAL: embObjMotionControl::init() had an error while calling setcheckRemoteValue() for the controller " << "in "<< getBoardInfo();
+        yError() << "FATAL: embObjMotionControl::init() had an error while calling setcheckRemoteValues() for joint, motor and controller config in "<< getBoardInfo();
         return false;
     }
     else
     {
         if(behFlags.verbosewhenok)
         {
-            yDebug() << "embObjMotionControl::init() correctly configured controller config " << "in "<< getBoardInfo();
+            yDebug() << "embObjMotionControl::init() correctly configured" << _njoints << "joint and motor configs and the controller config in "<< getBoardInfo();
         }
     }
 
@@ -3057,15 +3058,32 @@ bool embObjMotionControl::getEncoderRaw(int j, double *value)
     return ret;
 }
 
+bool embObjMotionControl::readJointStatusSnapshot(void)
+{
+    return res->getLocalValues(_jointStatusCoreID32s, _jointStatusCoreSnapshot.data(), sizeof(eOmc_joint_status_core_t));
+}
+
+bool embObjMotionControl::readMotorStatusSnapshot(void)
+{
+    return res->getLocalValues(_motorStatusBasicID32s, _motorStatusBasicSnapshot.data(), sizeof(eOmc_motor_status_basic_t));
+}
+
 bool embObjMotionControl::getEncodersRaw(double *encs)
 {
-    bool ret = true;
-    for(int j=0; j< _njoints; j++)
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    if(false == readJointStatusSnapshot())
     {
-        ret &= getEncoderRaw(j, &encs[j]);
+        yError() << "embObjMotionControl while reading encoders";
+        for(int j=0; j< _njoints; j++)
+            encs[j] = 0;
+        return false;
+    }
 
+    for(int j=0; j< _njoints; j++)
+    {
+        encs[j] = (double) _jointStatusCoreSnapshot[j].measures.meas_position;
     }
-    return ret;
+    return true;
 }
 
 bool embObjMotionControl::getEncoderSpeedRaw(int j, double *sp)
@@ -3084,12 +3102,19 @@ bool embObjMotionControl::getEncoderSpeedRaw(int j, double *sp)
 
 bool embObjMotionControl::getEncoderSpeedsRaw(double *spds)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    if(false == readJointStatusSnapshot())
+    {
+        for(int j=0; j< _njoints; j++)
+            spds[j] = 0;
+        return false;
+    }
+
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getEncoderSpeedRaw(j, &spds[j]);
+        spds[j] = (double) _jointStatusCoreSnapshot[j].measures.meas_velocity;
     }
-    return ret;
+    return true;
 }
 
 bool embObjMotionControl::getEncoderAccelerationRaw(int j, double *acc)
@@ -3107,12 +3132,19 @@ bool embObjMotionControl::getEncoderAccelerationRaw(int j, double *acc)
 
 bool embObjMotionControl::getEncoderAccelerationsRaw(double *accs)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    if(false == readJointStatusSnapshot())
+    {
+        for(int j=0; j< _njoints; j++)
+            accs[j] = 0;
+        return false;
+    }
+
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getEncoderAccelerationRaw(j, &accs[j]);
+        accs[j] = (double) _jointStatusCoreSnapshot[j].measures.meas_acceleration;
     }
-    return ret;
+    return true;
 }
 
 ///////////////////////// END Encoder Interface
@@ -3193,13 +3225,20 @@ bool embObjMotionControl::getMotorEncoderRaw(int m, double *value)
 
 bool embObjMotionControl::getMotorEncodersRaw(double *encs)
 {
-    bool ret = true;
-    for(int j=0; j< _njoints; j++)
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    if(false == readMotorStatusSnapshot())
     {
-        ret &= getMotorEncoderRaw(j, &encs[j]);
+        yError() << "embObjMotionControl while reading motor encoder positions";
+        for(int j=0; j< _njoints; j++)
+            encs[j] = 0;
+        return false;
+    }
 
+    for(int j=0; j< _njoints; j++)
+    {
+        encs[j] = (double) _motorStatusBasicSnapshot[j].mot_position;
     }
-    return ret;
+    return true;
 }
 
 bool embObjMotionControl::getMotorEncoderSpeedRaw(int m, double *sp)
@@ -3221,12 +3260,20 @@ bool embObjMotionControl::getMotorEncoderSpeedRaw(int m, double *sp)
 
 bool embObjMotionControl::getMotorEncoderSpeedsRaw(double *spds)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    if(false == readMotorStatusSnapshot())
+    {
+        yError() << "embObjMotionControl while reading motor encoder speeds";
+        for(int j=0; j< _njoints; j++)
+            spds[j] = 0;
+        return true;
+    }
+
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getMotorEncoderSpeedRaw(j, &spds[j]);
+        spds[j] = (double) _motorStatusBasicSnapshot[j].mot_velocity;
     }
-    return ret;
+    return true;
 }
 
 bool embObjMotionControl::getMotorEncoderAccelerationRaw(int m, double *acc)
@@ -3248,12 +3295,20 @@ bool embObjMotionControl::getMotorEncoderAccelerationRaw(int m, double *acc)
 
 bool embObjMotionControl::getMotorEncoderAccelerationsRaw(double *accs)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    if(false == readMotorStatusSnapshot())
+    {
+        yError() << "embObjMotionControl while reading motor encoder accelerations";
+        for(int j=0; j< _njoints; j++)
+            accs[j] = 0;
+        return true;
+    }
+
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getMotorEncoderAccelerationRaw(j, &accs[j]);
+        accs[j] = (double) _motorStatusBasicSnapshot[j].mot_acceleration;
     }
-    return ret;
+    return true;
 }
 
 bool embObjMotionControl::getMotorEncodersTimedRaw(double *encs, double *stamps)
@@ -3298,12 +3353,19 @@ bool embObjMotionControl::getCurrentRaw(int j, double *value)
 
 bool embObjMotionControl::getCurrentsRaw(double *vals)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    if(false == readMotorStatusSnapshot())
+    {
+        for(int j=0; j< _njoints; j++)
+            vals[j] = 0;
+        return true;
+    }
+
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getCurrentRaw(j, &vals[j]);
+        vals[j] = (double) _motorStatusBasicSnapshot[j].mot_current;
     }
-    return ret;
+    return true;
 }
 
 bool embObjMotionControl::setMaxCurrentRaw(int j, double val)
@@ -4135,9 +4197,16 @@ bool embObjMotionControl::getTorqueRaw(int j, double *t)
 
 bool embObjMotionControl::getTorquesRaw(double *t)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    if(false == readJointStatusSnapshot())
+    {
+        for(int j=0; j<_njoints; j++)
+            t[j] = 0;
+        return true;
+    }
+
     for(int j=0; j<_njoints; j++)
-        ret = ret && getTorqueRaw(j, &t[j]);
+        t[j] = (double) _measureConverter->trqS2N(_jointStatusCoreSnapshot[j].measures.meas_torque, j);
     return true;
 }
 
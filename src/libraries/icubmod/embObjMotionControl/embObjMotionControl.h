@@ -363,6 +363,13 @@ private:
     std::map<std::string, rawValuesKeyMetadata> _rawValuesMetadataMap;
     std::vector<std::int32_t> _rawDataAuxVector;
 
+    // snapshots of the status of all joints and motors of the board. each one is read with a single lock of the transceiver
+    std::vector<eOprotID32_t>               _jointStatusCoreID32s;
+    std::vector<eOprotID32_t>               _motorStatusBasicID32s;
+    std::vector<eOmc_joint_status_core_t>   _jointStatusCoreSnapshot;
+    std::vector<eOmc_motor_status_basic_t>  _motorStatusBasicSnapshot;
+    std::mutex                              _snapshotMutex;
+
 #ifdef NETWORK_PERFORMANCE_BENCHMARK 
     Tools:Emb_RensponseTimingVerifier m_responseTimingVerifier;
 #endif
@@ -399,6 +406,10 @@ private:
     void updateDeadZoneWithDefaultValues(void);
     bool getJointDeadZoneRaw(int j, double &jntDeadZone);
 
+    // they fill _jointStatusCoreSnapshot / _motorStatusBasicSnapshot. they must be called with _snapshotMutex locked
+    bool readJointStatusSnapshot(void);
+    bool readMotorStatusSnapshot(void);
+
 private:
     
     //functions used in init this object
@@ -34,6 +34,8 @@ public:
         reqIdsUnion=new char[0x800];
 
         for (int i=0; i<0x800; ++i) reqIdsUnion[i]=UNREQ;
+
+        dispatchStart.assign(0x801,0);
     }
 
     ~SharedCanBus()
@@ -107,6 +109,8 @@ public:
                 
                 accessPoints.pop_back();
 
+                rebuildDispatchUnsafe();
+
                 break;
             }
         }
@@ -130,18 +134,7 @@ public:
         {
             for (unsigned int i=0; i<msgsNum; ++i)
             {
-                unsigned int id=readBufferUnion[i].getId();
-
-                for (unsigned int p=0; p<accessPoints.size(); ++p)
-                {
-                    if (accessPoints[p]->hasId(id))
-                    {
-                        if (accessPoints[p]->pushReadMsg(readBufferUnion[i])==false)
-                        {
-                            yError("run()-pushReadMsg() failed on CAN bus %d", mCanDeviceNum);
-                        }
-                    }
-                }
+                dispatchUnsafe(readBufferUnion[i],NULL,"run()");
             }
         } 
     }
@@ -151,24 +144,14 @@ public:
         std::lock_guard<std::mutex> lck(writeMutex);
         bool ret=theCanBus->canWrite(msgs,size,sent,wait);
 
-        //this allows other istances to read back the sent message (echo)
-        yarp::dev::CanBuffer buff=msgs;
+        //this allows other istances to read back the sent message (echo):
+        //the messages are delivered straight from the caller's buffer
+        yarp::dev::CanBuffer &buff=const_cast<yarp::dev::CanBuffer&>(msgs);
+
+        std::lock_guard<std::mutex> lckConfig(configMutex);
         for (unsigned int m=0; m<size; ++m)
         {
-            unsigned int id=buff[m].getId();
-            if (reqIdsUnion[id])
-            {
-                for (unsigned int p=0; p<accessPoints.size(); ++p)
-                {
-                    if (accessPoints[p]!=pFrom && accessPoints[p]->hasId(id))
-                    {
-                        if (accessPoints[p]->pushReadMsg(buff[m])==false)
-                        {
-                            yError("canWrite()-pushReadMsg() failed on CAN bus %d", mCanDeviceNum);
-                        }
-                    }
-                }
-            }
+            dispatchUnsafe(buff[m],pFrom,"canWrite()");
         }
 
         return ret;
@@ -182,12 +165,14 @@ public:
             reqIdsUnion[id]=REQST;
             theCanBus->canIdAdd(id);
         }
+        rebuildDispatchUnsafe();
     }
 
     void canIdDelete(unsigned int id)
     {
         std::lock_guard<std::mutex> lck(configMutex);
         canIdDeleteUnsafe(id);
+        rebuildDispatchUnsafe();
     }
     
     yarp::dev::ICanBus* getCanBus()
@@ -281,6 +266,44 @@ public:
     }
 
 private:
+    // rebuilds the id -> access points table, to be called with configMutex held
+    // whenever the set of ids requested by the access points changes
+    void rebuildDispatchUnsafe()
+    {
+        dispatchAps.clear();
+
+        for (int id=0; id<0x800; ++id)
+        {
+            dispatchStart[id]=(int)dispatchAps.size();
+
+            if (reqIdsUnion[id]==REQST)
+            {
+                for (unsigned int p=0; p<accessPoints.size(); ++p)
+                {
+                    if (accessPoints[p]->hasId(id)) dispatchAps.push_back(accessPoints[p]);
+                }
+            }
+        }
+
+        dispatchStart[0x800]=(int)dispatchAps.size();
+    }
+
+    // delivers a message to the access points subscribed to its id, but pFrom
+    void dispatchUnsafe(yarp::dev::CanMessage &msg, yarp::dev::CanBusAccessPoint* pFrom, const char *caller)
+    {
+        unsigned int id=msg.getId();
+
+        if (id>=0x800) return;
+
+        for (int k=dispatchStart[id]; k<dispatchStart[id+1]; ++k)
+        {
+            if (dispatchAps[k]!=pFrom && dispatchAps[k]->pushReadMsg(msg)==false)
+            {
+                yError("%s-pushReadMsg() failed on CAN bus %d", caller, mCanDeviceNum);
+            }
+        }
+    }
+
     void canIdDeleteUnsafe(unsigned int id)
     {
         if (reqIdsUnion[id]==REQST)
@@ -318,6 +341,11 @@ private:
     yarp::dev::CanBuffer readBufferUnion;
 
     char *reqIdsUnion; //[0x800];
+
+    // access points subscribed to each id, in CSR form:
+    // dispatchAps[dispatchStart[id] .. dispatchStart[id+1]-1]
+    std::vector<int> dispatchStart; //[0x801]
+    std::vector<yarp::dev::CanBusAccessPoint*> dispatchAps;
 };
 
 class SharedCanBusManager // singleton
@@ -395,7 +423,11 @@ bool yarp::dev::CanBusAccessPoint::open(yarp::os::Searchable& config)
 
     mBufferSize=(unsigned int)(mSharedPhysDevice->getBufferSize());
 
-    readBuffer=createBuffer(mBufferSize);
+    unsigned int ringSize=1;
+    while (ringSize<mBufferSize) ringSize<<=1;
+    mRingMask=ringSize-1;
+
+    readBuffer=createBuffer(ringSize);
 
     mSharedPhysDevice->attachAccessPoint(this);
 
@@ -16,6 +16,7 @@
 #define __SHARED_CAN_BUS_H__
 
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 
 #include <yarp/os/Time.h>
@@ -64,8 +65,10 @@ public:
         waitingOnRead=false;
 
         mBufferSize=0;
+        mRingMask=0;
 
-        nRecv=0;
+        ringHead=0;
+        ringTail=0;
     }
 
     ~CanBusAccessPoint()
@@ -80,21 +83,25 @@ public:
         return reqIds[id]==REQST;
     }
 
+    // producer side of the receive ring: called by the SharedCanBus with its
+    // configuration lock held, hence by one thread at a time
     bool pushReadMsg(CanMessage& msg)
     {
-        std::lock_guard<std::mutex> lck(synchroMutex);
+        unsigned int tail=ringTail.load(std::memory_order_relaxed);
+        unsigned int head=ringHead.load(std::memory_order_acquire);
 
-        if (nRecv>=mBufferSize)
+        if (tail-head>=mBufferSize)
         {
-            yError("recv buffer overrun (%4d >= %4d)", nRecv, mBufferSize);
+            yError("recv buffer overrun (%4d >= %4d)", tail-head, mBufferSize);
             return false;
         }
 
-        readBuffer[nRecv++]=msg;
-        
-        if (waitingOnRead)
+        readBuffer[tail & mRingMask]=msg;
+        ringTail.store(tail+1);
+
+        if (waitingOnRead.exchange(false))
         {
-            waitingOnRead=false;
+            std::lock_guard<std::mutex> lck(mtx_waitRead);
             cv_waitRead.notify_one();
         }
         
@@ -113,37 +120,33 @@ public:
     virtual bool canIdAdd(unsigned int id);
     virtual bool canIdDelete(unsigned int id);
 
+    // consumer side of the receive ring: messages not fitting in msgs
+    // are kept for the next call
     virtual bool canRead(CanBuffer &msgs, unsigned int size, unsigned int *nmsg, bool wait=false)
     {
-        synchroMutex.lock();
-
-        if (wait && !nRecv)
+        if (wait && (ringTail.load()==ringHead.load(std::memory_order_relaxed)))
         {
-            waitingOnRead=true;
-            synchroMutex.unlock();
             std::unique_lock<std::mutex> lck(mtx_waitRead);
-            cv_waitRead.wait(lck);
-            synchroMutex.lock();
+            waitingOnRead=true;
+            cv_waitRead.wait(lck,[this]{ return ringTail.load()!=ringHead.load(std::memory_order_relaxed); });
+            waitingOnRead=false;
         }
 
-        if (nRecv)
-        {
-            for (unsigned int i=0; i<nRecv && i<size; ++i)
-            {
-                msgs[i]=readBuffer[i];
-            }
-
-            *nmsg=nRecv;
-            nRecv=0;
-            synchroMutex.unlock();
-            return true;
-        }
-        else
+        unsigned int head=ringHead.load(std::memory_order_relaxed);
+        unsigned int tail=ringTail.load(std::memory_order_acquire);
+
+        unsigned int n=tail-head;
+        if (n>size) n=size;
+
+        for (unsigned int i=0; i<n; ++i)
         {
-            *nmsg=0;
-            synchroMutex.unlock();
-            return true;
+            msgs[i]=readBuffer[(head+i) & mRingMask];
         }
+
+        ringHead.store(head+n,std::memory_order_release);
+
+        *nmsg=n;
+        return true;
     }
 
     virtual bool canWrite(const CanBuffer &msgs, unsigned int size, unsigned int *sent, bool wait=false);
@@ -167,12 +170,15 @@ public:
 protected:
     std::mutex mtx_waitRead;
     std::condition_variable cv_waitRead;
-    std::mutex synchroMutex;
     
-    bool waitingOnRead;
+    std::atomic<bool> waitingOnRead;
 
-    unsigned int nRecv;
+    // single-producer/single-consumer receive ring over readBuffer,
+    // whose size is a power of two (mRingMask+1) not smaller than mBufferSize
+    std::atomic<unsigned int> ringHead;
+    std::atomic<unsigned int> ringTail;
     CanBuffer readBuffer;
+    unsigned int mRingMask;
     
     char *reqIds; //[0x800];
 
@@ -39,6 +39,8 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <algorithm>
+#include <string>
 
 
 /* At time of writing, these constants are not defined in the headers */
@@ -58,9 +60,21 @@ using namespace yarp::os;
 const int TX_QUEUE_SIZE=2047;
 const int RX_QUEUE_SIZE=2047;
 
+// max number of frames exchanged with the kernel by a single recvmmsg()/sendmmsg()
+const int MMSG_BATCH_SIZE=256;
+
 SocketCan::SocketCan()
 {
     skt = 0;
+    timestamps = false;
+    filtersPending = false;
+    filtersWarned = false;
+
+    rxHdrs.resize(MMSG_BATCH_SIZE);
+    rxIovs.resize(MMSG_BATCH_SIZE);
+    txHdrs.resize(MMSG_BATCH_SIZE);
+    txIovs.resize(MMSG_BATCH_SIZE);
+    rxCtrl.resize(MMSG_BATCH_SIZE*CMSG_SPACE(sizeof(struct timeval)));
 }
 
 SocketCan::~SocketCan()
@@ -80,96 +94,174 @@ bool SocketCan::canGetBaudRate(unsigned int *rate)
     return true;
 }
 
+// Runs of consecutive ids are split into aligned power-of-two blocks, each
+// one matched by a single mask filter, so that the wide ranges registered by
+// the motion control fit within the kernel limit.
+static void buildFilters(const std::set<unsigned int> &ids, std::vector<struct can_filter> &filters)
+{
+    filters.clear();
+    std::set<unsigned int>::const_iterator it=ids.begin();
+    while (it!=ids.end())
+    {
+        unsigned int flag=*it & CAN_EFF_FLAG;
+        unsigned int idMask=(flag ? CAN_EFF_MASK : CAN_SFF_MASK);
+        unsigned int lo=*it & idMask;
+        unsigned int hi=lo;
+        for (++it; (it!=ids.end()) && ((*it & CAN_EFF_FLAG)==flag) && ((*it & idMask)==hi+1); ++it)
+            hi++;
+
+        while (lo<=hi)
+        {
+            unsigned int block=1;
+            while (((lo & ((block<<1)-1))==0) && (lo+(block<<1)-1<=hi))
+                block<<=1;
+
+            struct can_filter f;
+            f.can_id=flag|lo;
+            f.can_mask=CAN_EFF_FLAG|(idMask & ~(block-1));
+            filters.push_back(f);
+            lo+=block;
+        }
+    }
+}
+
+bool SocketCan::applyFilters()
+{
+    if (skt<=0)
+        return true;
+
+    filtersPending=false;
+
+    std::vector<struct can_filter> filters;
+    buildFilters(ids, filters);
+
+    // no registered ids (or more blocks than the kernel can hold): accept everything
+    if (filters.empty() || (filters.size()>(size_t)CAN_RAW_FILTER_MAX))
+    {
+        struct can_filter all;
+        all.can_id=0;
+        all.can_mask=0;
+        if (!filters.empty() && !filtersWarned)
+        {
+            fprintf(stderr, "Warning: SocketCan has %d ids registered, needing more than %d kernel filters: accepting all frames.\n",
+                    (int)ids.size(), CAN_RAW_FILTER_MAX);
+            filtersWarned=true;
+        }
+        return (setsockopt(skt, SOL_CAN_RAW, CAN_RAW_FILTER, &all, sizeof(all))==0);
+    }
+
+    if (setsockopt(skt, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(), filters.size()*sizeof(struct can_filter))!=0)
+    {
+        fprintf(stderr, "Error: SocketCan was unable to set the kernel CAN filters.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// the filters are installed once, at the next canRead(), rather than
+// at every single registration
 bool SocketCan::canIdAdd(unsigned int id)
 {
-    //not yet implemented
+    if (ids.insert(id).second)
+        filtersPending=true;
     return true;
 }
 
 bool SocketCan::canIdDelete(unsigned int id)
 {
-    //not yet implemented 
+    if (ids.erase(id)>0)
+        filtersPending=true;
     return true;
 }
 
+double SocketCan::getRxTimestamp(unsigned int i) const
+{
+    if (i<rxStamps.size())
+        return rxStamps[i];
+    return 0.0;
+}
+
 bool SocketCan::canRead(CanBuffer &msgs,
                      unsigned int size, 
                      unsigned int *readout,
                      bool wait)
 {
-/*
-    int res;
-    #ifdef WIN32
-        long lRead=size;
-    #else
-        int32_t lRead=size;
+    unsigned int i=0;
+    #if SOCK_DEBUG
+        printf("Asked for %d messages\n", size);
     #endif
 
-    CMSG *tmp=reinterpret_cast<CMSG *>(msgs[0].getPointer());
-    if (wait)
-        res=::canRead(*handle, tmp, &lRead, 0);
-    else
-        res=::canTake(*handle, tmp, &lRead);
-
-    *readout=lRead;
-
-    if ( (res==NTCAN_SUCCESS)||(res==NTCAN_RX_TIMEOUT))
-        return true;
+    if (filtersPending && !applyFilters())
+        fprintf(stderr, "Warning: SocketCan was unable to set the receive filters.\n");
 
-    fprintf(stderr, "Error: canRead returned with code:%.8X\n", res);*/
+    if (timestamps && (rxStamps.size()<size))
+        rxStamps.resize(size);
 
-    int i=0;
-    int bytes_read=0;
-    #if SOCK_DEBUG
-        printf("Asked for %d messages\n", size);
-    #endif
-    for (i=0; i<size; i++)
+    // the frames land directly in the caller's buffer, one batch per syscall
+    const size_t ctrlLen=CMSG_SPACE(sizeof(struct timeval));
+    while (i<size)
     {
-        can_frame *frm=reinterpret_cast<can_frame *>(msgs[i].getPointer());
-        //printf("start reading\n");
-        bytes_read = 0;
-        bytes_read = read( skt, frm, sizeof(*frm) );
+        unsigned int chunk=std::min<unsigned int>(size-i, MMSG_BATCH_SIZE);
+        for (unsigned int j=0; j<chunk; j++)
+        {
+            rxIovs[j].iov_base=msgs[i+j].getPointer();
+            rxIovs[j].iov_len=sizeof(struct can_frame);
+            memset(&rxHdrs[j], 0, sizeof(struct mmsghdr));
+            rxHdrs[j].msg_hdr.msg_iov=&rxIovs[j];
+            rxHdrs[j].msg_hdr.msg_iovlen=1;
+            if (timestamps)
+            {
+                rxHdrs[j].msg_hdr.msg_control=&rxCtrl[j*ctrlLen];
+                rxHdrs[j].msg_hdr.msg_controllen=ctrlLen;
+            }
+        }
+
+        int n=recvmmsg(skt, rxHdrs.data(), chunk, MSG_DONTWAIT, NULL);
         #if SOCK_DEBUG
-            printf("finished reading. read %d bytes\n",bytes_read);
+            printf("finished reading. read %d frames\n",n);
         #endif
-        if (bytes_read<=0) break;
-
-        #if SOCK_DEBUG
-            printf("Read: %d \n ",bytes_read);
-            printf("len %d ", frm->can_dlc);
-            printf("id %d ", frm->can_id);
-            printf("data: ");
-            for(int j=0;j<frm->can_dlc;j++)
-                printf("%2x ", frm->data[j]);
-            printf("\n");
-        #endif
-
-        //yarp::os::Time::delay(0.010); //test only
+        if (n<=0)
+            break;
+
+        for (int j=0; j<n; j++)
+        {
+            if (timestamps)
+            {
+                rxStamps[i+j]=0.0;
+                for (struct cmsghdr *cmsg=CMSG_FIRSTHDR(&rxHdrs[j].msg_hdr); cmsg!=NULL;
+                     cmsg=CMSG_NXTHDR(&rxHdrs[j].msg_hdr, cmsg))
+                {
+                    if ((cmsg->cmsg_level==SOL_SOCKET) && (cmsg->cmsg_type==SCM_TIMESTAMP))
+                    {
+                        struct timeval tv;
+                        memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+                        rxStamps[i+j]=tv.tv_sec+1e-6*tv.tv_usec;
+                    }
+                }
+            }
+
+            #if SOCK_DEBUG
+                can_frame *frm=reinterpret_cast<can_frame *>(msgs[i+j].getPointer());
+                printf("len %d ", frm->can_dlc);
+                printf("id %d ", frm->can_id);
+                printf("data: ");
+                for(int k=0;k<frm->can_dlc;k++)
+                    printf("%2x ", frm->data[k]);
+                printf("\n");
+            #endif
+        }
+
+        i+=n;
+        if ((unsigned int)n<chunk)
+            break;
     }
+
     *readout=i;
     #if SOCK_DEBUG
         printf("Read %d messages\n", *readout);
     #endif
     return true;
-
-	/*
-	//debug
-	//struct can_frame frame;
-    can_frame *frame=reinterpret_cast<can_frame *>(msgs[0].getPointer());
-    bytes_read = read( skt, frame, sizeof(*frame) );
-    *readout=1;
-
-    printf("Read: %d \n ",bytes_read);
-
-    printf("len %d ", frame->can_dlc);
-    printf("id %d ", frame->can_id);
-    printf("data: ");
-    for(i=0;i<frame->can_dlc;i++)
-        printf("%2x ", frame->data[i]);
-    printf("\n");
-
-    return true;
-	*/
 }
 
 bool SocketCan::canWrite(const CanBuffer &msgs,
@@ -177,55 +269,42 @@ bool SocketCan::canWrite(const CanBuffer &msgs,
                       unsigned int *sent,
                       bool wait)
 {
-    int res;
-    int32_t lRead=size;
-    int bytes_sent=0;
-
-/*
-    //debug
-    struct can_frame frame2;
-    frame2.can_id = 0x123;
-    strcpy( (char*)(&frame2.data), "YAY" );
-    frame2.can_dlc = strlen( (char*)(&frame2.data) );
-    bytes_sent = write( skt, &frame2, sizeof(frame2) );
-*/
-/*
-    //debug
-    can_frame frame3;
-    frame3.can_id = 0x123;
-    frame3.data[0] = 'Y';
-    frame3.can_dlc = 1;
-    bytes_sent = write( skt, &frame3, sizeof(frame3) );
-*/
-
-    //debug
-    //fprintf(stderr, "id:%d data:%d size:%d\n", tmp->can_id, tmp->data[0], tmp->can_dlc );
-   
     //@@@ IMPORTANT (RANDAZ): I'm putting here a delay of one millisecond.
 	//I noticed that without this delay a lot CAN messages are lost when iCubInterface starts and
 	//sends the configuration parameters (PIDs etc.) to the control boards.
 	//Further investigation is required in order to understand how the internal buffer is handled 
 	//when the function write( skt, tmp, sizeof(*tmp) ); is called.
 	Time::delay(0.001);
-	
-    int i=0;
-	(*sent)=0;
-	for (i=0; i<size; i++)
+
+    CanBuffer &buffer=const_cast<CanBuffer &>(msgs);
+    unsigned int i=0;
+    (*sent)=0;
+    while (i<size)
     {
-		CanBuffer &buffer=const_cast<CanBuffer &>(msgs);
-		const struct can_frame *tmp=reinterpret_cast<const struct can_frame*>(buffer[i].getPointer());   
-		bytes_sent = write( skt, tmp, sizeof(*tmp) );
-		if (bytes_sent>0) 
-		{
-			(*sent)++;
-		}
+        unsigned int chunk=std::min<unsigned int>(size-i, MMSG_BATCH_SIZE);
+        for (unsigned int j=0; j<chunk; j++)
+        {
+            txIovs[j].iov_base=buffer[i+j].getPointer();
+            txIovs[j].iov_len=sizeof(struct can_frame);
+            memset(&txHdrs[j], 0, sizeof(struct mmsghdr));
+            txHdrs[j].msg_hdr.msg_iov=&txIovs[j];
+            txHdrs[j].msg_hdr.msg_iovlen=1;
+        }
+
+        int n=sendmmsg(skt, txHdrs.data(), chunk, 0);
+        if (n>0)
+        {
+            (*sent)+=n;
+            i+=n;
+        }
         else
-		{
-			fprintf(stderr, "Error: SocketCan::canWrite() was unable to send message.\n");
-			//break;
-		}
-	}
-	
+        {
+            // as with one write() per frame, skip the failing frame and go on
+            fprintf(stderr, "Error: SocketCan::canWrite() was unable to send message.\n");
+            i++;
+        }
+    }
+
     if (*sent <size)
        {
            fprintf(stderr, "Error: SocketCan::canWrite() not all messages were sent.\n");
@@ -258,25 +337,65 @@ bool SocketCan::open(yarp::os::Searchable &par)
                                       canRxQueue=par.check("CanRxQueue", Value(RX_QUEUE_SIZE), "length of rx buffer").asInt32() ;
     if  (canRxQueue == RX_QUEUE_SIZE) canRxQueue=par.check("canRxQueue", Value(RX_QUEUE_SIZE), "length of rx buffer").asInt32() ;
 
-   int so_timestamping_flags = 0;
+                     timestamps=par.check("CanTimestamps", Value(false), "enable kernel receive timestamps").asBool();
+    if  (!timestamps)    timestamps=par.check("canTimestamps", Value(false), "enable kernel receive timestamps").asBool();
+
+   // the interface name can be given explicitly (e.g. vcan0), otherwise it is can<CanDeviceNum>
+   std::string devName=par.check("CanDeviceName", Value(""), "name of the can interface").asString();
+   if (devName.empty()) devName=par.check("canDeviceName", Value(""), "name of the can interface").asString();
+   if (devName.empty()) devName="can"+std::to_string(netId);
+
    /* Create the socket */
    skt = socket( PF_CAN, SOCK_RAW, CAN_RAW );
+   if (skt<0)
+   {
+       fprintf(stderr, "Error: SocketCan was unable to create the socket.\n");
+       skt = 0;
+       return false;
+   }
  
    /* Locate the interface you wish to use */
    struct ifreq ifr;
-   sprintf (ifr.ifr_name, "can%d",netId);
-   ioctl(skt, SIOCGIFINDEX, &ifr); // ifr.ifr_ifindex gets filled with that device's index
+   memset(&ifr, 0, sizeof(ifr));
+   strncpy(ifr.ifr_name, devName.c_str(), IFNAMSIZ-1);
+   if (ioctl(skt, SIOCGIFINDEX, &ifr)<0) // ifr.ifr_ifindex gets filled with that device's index
+   {
+       fprintf(stderr, "Error: SocketCan was unable to find the interface %s.\n", devName.c_str());
+       ::close(skt);
+       skt = 0;
+       return false;
+   }
  
    /* Select that CAN interface, and bind the socket to it. */
    struct sockaddr_can addr;
+   memset(&addr, 0, sizeof(addr));
    addr.can_family = AF_CAN;
    addr.can_ifindex = ifr.ifr_ifindex;
-   bind( skt, (struct sockaddr*)&addr, sizeof(addr) );
+   if (bind( skt, (struct sockaddr*)&addr, sizeof(addr) )<0)
+   {
+       fprintf(stderr, "Error: SocketCan was unable to bind to the interface %s.\n", devName.c_str());
+       ::close(skt);
+       skt = 0;
+       return false;
+   }
 
     int flags;
     if (-1 == (flags = fcntl(skt, F_GETFL, 0))) flags = 0;
     fcntl(skt, F_SETFL, flags | O_NONBLOCK);
 
+    if (timestamps)
+    {
+        int on=1;
+        if (setsockopt(skt, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on))!=0)
+        {
+            fprintf(stderr, "Warning: SocketCan was unable to enable receive timestamps.\n");
+            timestamps=false;
+        }
+    }
+
+    // ids may have been registered before opening
+    if (!applyFilters())
+        fprintf(stderr, "Warning: SocketCan was unable to set the receive filters.\n");
 
    return true;
 }
@@ -300,6 +419,7 @@ bool SocketCan::close()
     if (!skt)
         return false;
 
-    //not yet implemented 
+    ::close(skt);
+    skt = 0;
     return true;
 }
@@ -32,9 +32,13 @@
 #include "memory.h"
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <linux/can.h>
 #include <linux/can/raw.h>
 
+#include <set>
+#include <vector>
+
 namespace yarp{
     namespace dev{
         class SocketCan;
@@ -102,6 +106,18 @@ public:
  * | YARP device name |
  * |:-----------------:|
  * | `socketcan` |
+ *
+ * Parameters accepted in the config argument of the open method:
+ * | Parameter name | Type   | Units | Default Value | Required | Description | Notes |
+ * |:--------------:|:------:|:-----:|:-------------:|:--------:|:-----------:|:-----:|
+ * | canDeviceNum   | int    | -     | -1            | Yes      | number of the can interface, opened as can<canDeviceNum> | |
+ * | canDeviceName  | string | -     | -             | No       | name of the can interface | overrides canDeviceNum, e.g. vcan0 |
+ * | canTimestamps  | bool   | -     | false         | No       | enable the kernel receive timestamps | see getRxTimestamp() |
+ *
+ * Frames are exchanged with the kernel in batches through recvmmsg()/sendmmsg(),
+ * and the ids registered with canIdAdd() are installed as kernel-side CAN_RAW filters,
+ * merging runs of consecutive ids into mask filters. Registrations are collected and
+ * installed at once by open() or by the next canRead().
  */
 class yarp::dev::SocketCan: public ImplementCanBufferFactory<SocketCanMessage, can_frame>,
     public ICanBus, 
@@ -109,10 +125,37 @@ class yarp::dev::SocketCan: public ImplementCanBufferFactory<SocketCanMessage, c
 {
 private:
     int skt;
+
+    // ids registered through canIdAdd(), used to build the kernel-side filters
+    std::set<unsigned int> ids;
+    bool filtersPending;
+    bool filtersWarned;
+
+    // batched rx/tx: the iovecs point directly to the frames of the caller's buffers
+    std::vector<struct mmsghdr> rxHdrs;
+    std::vector<struct iovec>   rxIovs;
+    std::vector<struct mmsghdr> txHdrs;
+    std::vector<struct iovec>   txIovs;
+
+    // receive timestamps (SO_TIMESTAMP), one control buffer per frame of a batch
+    bool timestamps;
+    std::vector<char>   rxCtrl;
+    std::vector<double> rxStamps;
+
+    bool applyFilters();
+
 public:
     SocketCan();
     ~SocketCan();
 
+    /**
+     * Returns the kernel receive timestamp of the i-th frame returned by the
+     * last call to canRead(); requires the canTimestamps option.
+     * @param i is the index of the frame in the buffer filled by canRead().
+     * @return the timestamp in seconds, or 0.0 if not available.
+     */
+    double getRxTimestamp(unsigned int i) const;
+
     /* ICanBus */
     virtual bool canSetBaudRate(unsigned int rate);
     virtual bool canGetBaudRate(unsigned int *rate);
@@ -21,8 +21,10 @@
 
 #include <string>
 #include <sstream>
+#include <stdexcept>
 
 #include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
 #include <yarp/os/Portable.h>
 #include <yarp/os/Bottle.h>
 #include <yarp/os/Value.h>
@@ -145,6 +147,23 @@ public:
      */
     virtual void feedSample(const yarp::sig::Vector& input, const yarp::sig::Vector& output) = 0;
 
+    /**
+     * Provide the learning machine with a batch of examples at once. The
+     * default implementation feeds the samples one by one; machines that can
+     * incorporate multiple samples more efficiently should override it.
+     *
+     * @param inputs a matrix containing a sample input on each row
+     * @param outputs a matrix containing the corresponding outputs on each row
+     */
+    virtual void feedSamples(const yarp::sig::Matrix& inputs, const yarp::sig::Matrix& outputs) {
+        if(inputs.rows() != outputs.rows()) {
+            throw std::runtime_error("Number of inputs and outputs in batch differ");
+        }
+        for(size_t i = 0; i < inputs.rows(); i++) {
+            this->feedSample(inputs.getRow(i), outputs.getRow(i));
+        }
+    }
+
     /**
      * Train the learning machine on the examples that have been supplied so
      * far. This method is primarily intended to be used for offline/batch
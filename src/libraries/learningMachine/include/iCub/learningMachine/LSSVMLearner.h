@@ -67,6 +67,21 @@ public:
 
     virtual double evaluate(const yarp::sig::Vector& v1, const yarp::sig::Vector& v2);
 
+    /**
+     * Evaluates the kernel between a vector and a batch of samples at once.
+     * The squared distances are expanded into the precomputed squared norms
+     * of the samples and a single matrix-vector product.
+     *
+     * @param X  the n samples, stored contiguously row by row
+     * @param norms  the squared norms of the n samples
+     * @param n  the number of samples
+     * @param v  the vector to evaluate the samples against
+     * @param dim  the dimensionality of v and of the samples
+     * @param k  the n resulting kernel values
+     */
+    virtual void evaluate(const double* X, const double* norms, size_t n,
+                          const double* v, size_t dim, double* k);
+
     virtual void setGamma(double g) {
         this->gamma = g;
     }
@@ -111,6 +126,12 @@ public:
  * efficiency the hyperparameters are shared among all outputs. Only the RBF
  * kernel function is supported.
  *
+ * In online mode the inverse of the regularized kernel matrix is kept in
+ * memory and bordered in O(n^2) for every new sample, while the oldest sample
+ * is dropped in O(n^2) as soon as the (optional) budget is exceeded. The
+ * coefficients are then solved lazily, so that a call to train() is not
+ * needed.
+ *
  * \see iCub::contrib::IMachineLearner
  * \see iCub::contrib::IFixedSizeLearner
  *
@@ -120,14 +141,24 @@ public:
 class LSSVMLearner : public IFixedSizeLearner {
 private:
     /**
-     * Storage for the input vectors.
+     * Storage for the input vectors, contiguously row by row.
+     */
+    std::vector<double> inputs;
+
+    /**
+     * The squared norms of the input vectors.
+     */
+    std::vector<double> norms;
+
+    /**
+     * Storage for the output vectors, contiguously row by row.
      */
-    std::vector<yarp::sig::Vector> inputs;
+    std::vector<double> outputs;
 
     /**
-     * Storage for the output vectors.
+     * The number of stored samples.
      */
-    std::vector<yarp::sig::Vector> outputs;
+    unsigned int sampleCount;
 
     /**
      * The matrix of Lagrange multipliers, i.e. the coefficients.
@@ -154,6 +185,54 @@ private:
      */
     RBFKernel* kernel;
 
+    /**
+     * Flag indicating whether the machine learns online.
+     */
+    bool online;
+
+    /**
+     * Maximum number of samples in online mode, zero for no limit.
+     */
+    unsigned int budget;
+
+    /**
+     * The inverse of the regularized kernel matrix in online mode. Only the
+     * leading sampleCount x sampleCount block is used, the remainder is spare
+     * capacity for new samples.
+     */
+    yarp::sig::Matrix Hinv;
+
+    /**
+     * Flag indicating whether the coefficients match the stored samples.
+     */
+    bool solved;
+
+    /**
+     * Borders the inverse of the regularized kernel matrix with the stored
+     * sample at index i, which is the first one not yet included.
+     *
+     * @param i  the index of the sample
+     */
+    void addToInverse(unsigned int i);
+
+    /**
+     * Drops the oldest sample from the storage and from the inverse of the
+     * regularized kernel matrix.
+     */
+    void removeOldest();
+
+    /**
+     * Recomputes the inverse of the regularized kernel matrix for all stored
+     * samples, e.g. after a change of the hyperparameters.
+     */
+    void rebuildInverse();
+
+    /**
+     * Solves the coefficients, the biases and the Leave-One-Out error from the
+     * inverse of the regularized kernel matrix, if needed.
+     */
+    void updateWeights();
+
 
 public:
     /**
@@ -245,9 +324,7 @@ public:
      *
      * @param C the new value
      */
-    virtual void setC(double C) {
-        this->C = C;
-    }
+    virtual void setC(double C);
 
     /**
      * Accessor for the regularization parameter C.
@@ -259,7 +336,42 @@ public:
     }
 
     /**
-     * Accessor for the kernel.
+     * Enables or disables online learning. Enabling it computes the inverse of
+     * the regularized kernel matrix for the samples collected so far.
+     *
+     * @param o  the new value
+     */
+    virtual void setOnline(bool o);
+
+    /**
+     * Accessor for the online learning flag.
+     *
+     * @returns true if the machine learns online
+     */
+    virtual bool getOnline() {
+        return this->online;
+    }
+
+    /**
+     * Mutator for the maximum number of samples in online mode. When the
+     * budget is exceeded the oldest samples are dropped.
+     *
+     * @param b  the new value, zero for no limit
+     */
+    virtual void setBudget(unsigned int b);
+
+    /**
+     * Accessor for the maximum number of samples in online mode.
+     *
+     * @returns the value of the budget
+     */
+    virtual unsigned int getBudget() {
+        return this->budget;
+    }
+
+    /**
+     * Accessor for the kernel. After changing the kernel of an online machine
+     * directly, call setOnline(true) to recompute the inverse.
      *
      * @returns a pointer to the kernel
      */
@@ -111,6 +111,17 @@ void cholupdate(yarp::sig::Matrix& R, const yarp::sig::Vector& x, yarp::sig::Vec
  */
 void cholupdate(yarp::sig::Matrix& R, const yarp::sig::Vector& x, bool rtrans = 0);
 
+/**
+ * Perform a rank-k update to a Cholesky factor, using the rows of X as update
+ * vectors. The factor and the block are triangularized together by Householder
+ * reflections, so that R is traversed once for the whole block rather than
+ * once per vector.
+ *
+ * @param R  an upper triangular Cholesky factor
+ * @param X  a matrix containing an update vector on each row
+ */
+void cholupdate(yarp::sig::Matrix& R, const yarp::sig::Matrix& X);
+
 /**
  * Solves a system A*x=b for multiple row vectors in B using a precomputed
  * Cholesky factor R.
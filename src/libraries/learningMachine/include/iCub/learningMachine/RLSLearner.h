@@ -33,7 +33,9 @@ namespace learningmachine {
  *
  * Recursive Regularized Least Squares (a.k.a. ridge regression) learner. It
  * uses a rank 1 update rule to update the Cholesky factor of the covariance
- * matrix.
+ * matrix. Batches of samples are incorporated with a single rank k update.
+ * The weights are only solved when they are needed, i.e. on the first
+ * prediction, training or serialization after new samples have been fed.
  *
  * \see iCub::learningmachine::IMachineLearner
  * \see iCub::learningmachine::IFixedSizeLearner
@@ -70,6 +72,16 @@ private:
      */
     double lambda;
 
+    /**
+     * Whether W is up to date with R and B.
+     */
+    bool solved;
+
+    /**
+     * Solves the weight matrix W if samples have been fed since the last time.
+     */
+    void updateWeights();
+
 public:
     /**
      * Constructor.
@@ -100,6 +112,11 @@ public:
      */
     virtual void feedSample(const yarp::sig::Vector& input, const yarp::sig::Vector& output);
 
+    /*
+     * Inherited from IMachineLearner.
+     */
+    virtual void feedSamples(const yarp::sig::Matrix& inputs, const yarp::sig::Matrix& outputs);
+
     /*
      * Inherited from IMachineLearner.
      */
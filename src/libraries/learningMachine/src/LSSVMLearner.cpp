@@ -16,10 +16,14 @@
  * Public License for more details
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <sstream>
 #include <cmath>
 
+#include <gsl/gsl_blas.h>
+
 #include <yarp/math/Math.h>
 #include <yarp/math/SVD.h>
 
@@ -45,8 +49,25 @@ double RBFKernel::evaluate(const yarp::sig::Vector& v1, const yarp::sig::Vector&
     return std::exp(result);
 }
 
+void RBFKernel::evaluate(const double* X, const double* norms, size_t n,
+                         const double* v, size_t dim, double* k) {
+    if(n == 0) {
+        return;
+    }
+
+    // |x - v|^2 = |x|^2 + |v|^2 - 2 x'v
+    double vnorm = cblas_ddot(dim, v, 1, v, 1);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, n, dim, -2.0, X, std::max(dim, (size_t) 1),
+                v, 1, 0.0, k, 1);
+    for(size_t i = 0; i < n; i++) {
+        double dist = std::max(k[i] + norms[i] + vnorm, 0.0);
+        k[i] = std::exp(-1 * this->gamma * dist);
+    }
+}
+
 
-LSSVMLearner::LSSVMLearner(unsigned int dom, unsigned int cod, double c) {
+LSSVMLearner::LSSVMLearner(unsigned int dom, unsigned int cod, double c)
+  : sampleCount(0), C(c), online(false), budget(0), solved(true) {
     this->setName("LSSVM");
     this->kernel = new RBFKernel();
     // make sure to not use initialization list to constructor of base for
@@ -57,9 +78,10 @@ LSSVMLearner::LSSVMLearner(unsigned int dom, unsigned int cod, double c) {
 }
 
 LSSVMLearner::LSSVMLearner(const LSSVMLearner& other)
-  : IFixedSizeLearner(other), inputs(other.inputs), outputs(other.outputs),
-    alphas(other.alphas), bias(other.bias), LOO(other.LOO), C(other.C),
-    kernel(new RBFKernel(*other.kernel)) {
+  : IFixedSizeLearner(other), inputs(other.inputs), norms(other.norms),
+    outputs(other.outputs), sampleCount(other.sampleCount), alphas(other.alphas),
+    bias(other.bias), LOO(other.LOO), C(other.C), kernel(new RBFKernel(*other.kernel)),
+    online(other.online), budget(other.budget), Hinv(other.Hinv), solved(other.solved) {
 
 }
 
@@ -72,13 +94,19 @@ LSSVMLearner& LSSVMLearner::operator=(const LSSVMLearner& other) {
 
     this->IFixedSizeLearner::operator=(other);
     this->inputs = other.inputs;
+    this->norms = other.norms;
     this->outputs = other.outputs;
+    this->sampleCount = other.sampleCount;
     this->alphas = other.alphas;
     this->bias = other.bias;
     this->LOO = other.LOO;
     this->C = other.C;
     delete this->kernel;
     this->kernel = new RBFKernel(*other.kernel);
+    this->online = other.online;
+    this->budget = other.budget;
+    this->Hinv = other.Hinv;
+    this->solved = other.solved;
 
     return *this;
 }
@@ -87,26 +115,182 @@ void LSSVMLearner::feedSample(const yarp::sig::Vector& input, const yarp::sig::V
     // call parent method to let it do some validation for us
     this->IFixedSizeLearner::feedSample(input, output);
 
-    this->inputs.push_back(input);
-    this->outputs.push_back(output);
+    if(this->online && this->budget > 0 && this->sampleCount >= this->budget) {
+        this->removeOldest();
+    }
+
+    this->inputs.insert(this->inputs.end(), input.data(), input.data() + input.size());
+    this->norms.push_back(cblas_ddot(input.size(), input.data(), 1, input.data(), 1));
+    this->outputs.insert(this->outputs.end(), output.data(), output.data() + output.size());
+    this->sampleCount++;
+
+    if(this->online) {
+        this->addToInverse(this->sampleCount - 1);
+        // coefficients are solved lazily
+        this->solved = false;
+    }
+}
+
+void LSSVMLearner::addToInverse(unsigned int i) {
+    // make room for the new row and column
+    if(this->Hinv.rows() <= i) {
+        unsigned int capacity = std::max(2 * (unsigned int) this->Hinv.rows(), i + 1);
+        if(this->budget > 0) {
+            capacity = std::min(capacity, std::max(this->budget, i + 1));
+        }
+        yarp::sig::Matrix grown(capacity, capacity);
+        for(unsigned int r = 0; r < i; r++) {
+            std::memcpy(grown[r], this->Hinv[r], i * sizeof(double));
+        }
+        this->Hinv = grown;
+    }
+
+    unsigned int dom = this->getDomainSize();
+    int ld = this->Hinv.cols();
+    double* G = this->Hinv.data();
+
+    // kernel column against the samples already included, c = Hinv * k
+    yarp::sig::Vector k(i), c(i);
+    double s = 1.0 + (1.0 / this->C); // the RBF kernel is one on the diagonal
+    if(i > 0) {
+        this->kernel->evaluate(this->inputs.data(), this->norms.data(), i,
+                               this->inputs.data() + i * dom, dom, k.data());
+        cblas_dsymv(CblasRowMajor, CblasUpper, i, 1.0, G, ld, k.data(), 1, 0.0, c.data(), 1);
+        // the Schur complement is bounded from below by 1/C
+        s -= cblas_ddot(i, k.data(), 1, c.data(), 1);
+    }
+
+    // Hinv = [Hinv + c c' / s, -c / s; -c' / s, 1 / s]
+    if(i > 0) {
+        cblas_dger(CblasRowMajor, i, i, 1.0 / s, c.data(), 1, c.data(), 1, G, ld);
+    }
+    for(unsigned int r = 0; r < i; r++) {
+        G[r * ld + i] = G[i * ld + r] = -c(r) / s;
+    }
+    G[i * ld + i] = 1.0 / s;
+}
+
+void LSSVMLearner::removeOldest() {
+    assert(this->sampleCount > 0);
+
+    unsigned int n = this->sampleCount;
+    int ld = this->Hinv.cols();
+    double* G = this->Hinv.data();
+
+    // the inverse of the trailing block is Hinv(1:,1:) - b b' / a, with
+    // a = Hinv(0,0) and b = Hinv(1:,0)
+    if(n > 1) {
+        cblas_dger(CblasRowMajor, n - 1, n - 1, -1.0 / G[0], G + ld, ld, G + ld, ld, G + ld + 1, ld);
+    }
+    for(unsigned int r = 0; r + 1 < n; r++) {
+        std::memmove(G + r * ld, G + (r + 1) * ld + 1, (n - 1) * sizeof(double));
+    }
+
+    this->inputs.erase(this->inputs.begin(), this->inputs.begin() + this->getDomainSize());
+    this->norms.erase(this->norms.begin());
+    this->outputs.erase(this->outputs.begin(), this->outputs.begin() + this->getCoDomainSize());
+    this->sampleCount--;
+    this->solved = false;
+}
+
+void LSSVMLearner::rebuildInverse() {
+    // drop what does not fit in the budget
+    if(this->budget > 0 && this->sampleCount > this->budget) {
+        unsigned int excess = this->sampleCount - this->budget;
+        this->inputs.erase(this->inputs.begin(), this->inputs.begin() + excess * this->getDomainSize());
+        this->norms.erase(this->norms.begin(), this->norms.begin() + excess);
+        this->outputs.erase(this->outputs.begin(), this->outputs.begin() + excess * this->getCoDomainSize());
+        this->sampleCount = this->budget;
+    }
+
+    this->Hinv.resize(this->sampleCount, this->sampleCount);
+    for(unsigned int i = 0; i < this->sampleCount; i++) {
+        this->addToInverse(i);
+    }
+    this->solved = false;
+}
+
+void LSSVMLearner::updateWeights() {
+    if(this->solved) {
+        return;
+    }
+    this->solved = true;
+
+    unsigned int n = this->sampleCount;
+    unsigned int cod = this->getCoDomainSize();
+    if(n == 0) {
+        this->alphas = yarp::sig::Matrix();
+        this->bias.clear();
+        this->LOO.clear();
+        return;
+    }
+
+    int ld = this->Hinv.cols();
+    const double* G = this->Hinv.data();
+
+    // eta = Hinv * 1
+    yarp::sig::Vector ones(n, 1.0), eta(n);
+    cblas_dsymv(CblasRowMajor, CblasUpper, n, 1.0, G, ld, ones.data(), 1, 0.0, eta.data(), 1);
+    double s = cblas_ddot(n, eta.data(), 1, ones.data(), 1);
+
+    // nu = Hinv * Y, stored in the coefficients
+    this->alphas.resize(n, cod);
+    cblas_dsymm(CblasRowMajor, CblasLeft, CblasUpper, n, cod, 1.0, G, ld,
+                this->outputs.data(), cod, 0.0, this->alphas.data(), cod);
+
+    // bias = 1' * nu / s, alphas = nu - eta * bias'
+    this->bias = zeros(cod);
+    for(unsigned int r = 0; r < n; r++) {
+        for(unsigned int c = 0; c < cod; c++) {
+            this->bias(c) += this->alphas(r, c);
+        }
+    }
+    for(unsigned int c = 0; c < cod; c++) {
+        this->bias(c) /= s;
+    }
+    cblas_dger(CblasRowMajor, n, cod, -1.0, eta.data(), 1, this->bias.data(), 1, this->alphas.data(), cod);
+
+    // compute LOO, the diagonal of the inverse of the bordered kernel matrix
+    // is Hinv(j,j) - eta(j)^2 / s
+    this->LOO = zeros(cod);
+    for(unsigned int j = 0; j < n; j++) {
+        double diag = G[j * ld + j] - eta(j) * eta(j) / s;
+        for(unsigned int i = 0; i < cod; i++) {
+            double err = this->alphas(j, i) / diag;
+            this->LOO(i) += err * err;
+        }
+    }
+    for(unsigned int i = 0; i < cod; i++) {
+        this->LOO(i) /= n;
+    }
 }
 
 void LSSVMLearner::train() {
-    assert(this->inputs.size() == this->outputs.size());
+    // online machines only need to solve the coefficients
+    if(this->online) {
+        this->updateWeights();
+        return;
+    }
 
     // save wasting some time
-    if(inputs.size() == 0) {
+    if(this->sampleCount == 0) {
         return;
     }
 
-    // create kernel matrix
-    yarp::sig::Matrix K(inputs.size() + 1, inputs.size() + 1);
-    for(int r = 0; r < K.rows() - 1; r++) {
+    unsigned int n = this->sampleCount;
+    unsigned int dom = this->getDomainSize();
+    unsigned int cod = this->getCoDomainSize();
+
+    // create kernel matrix, row by row against the preceding samples
+    yarp::sig::Matrix K(n + 1, n + 1);
+    for(unsigned int r = 0; r < n; r++) {
+        this->kernel->evaluate(this->inputs.data(), this->norms.data(), r + 1,
+                               this->inputs.data() + r * dom, dom, K[r]);
         // symmetric matrix
-        for(int c = 0; c <= r; c++) {
-            K(r, c) = K(c, r) = this->kernel->evaluate(this->inputs[r], this->inputs[c]);
-            if(r == c) K(r, c) += (1.0 / this->C);
+        for(unsigned int c = 0; c < r; c++) {
+            K(c, r) = K(r, c);
         }
+        K(r, r) += (1.0 / this->C);
     }
     for(int i = 0; i < K.rows() - 1; i++) {
         K(i, K.cols() - 1) = K(K.rows() - 1, i) = 1.;
@@ -117,10 +301,10 @@ void LSSVMLearner::train() {
     yarp::sig::Matrix Kinv = luinv(K);
 
     // compute solution
-    yarp::sig::Matrix Y = zeros(this->outputs.size() + 1, this->getCoDomainSize());
-    for(int r = 0; r < Y.rows() - 1; r++) {
-        for(int c = 0; c < Y.cols(); c++) {
-            Y(r, c) = this->outputs[r](c);
+    yarp::sig::Matrix Y = zeros(n + 1, cod);
+    for(unsigned int r = 0; r < n; r++) {
+        for(unsigned int c = 0; c < cod; c++) {
+            Y(r, c) = this->outputs[r * cod + c];
         }
     }
 
@@ -129,9 +313,9 @@ void LSSVMLearner::train() {
     this->bias = result.getRow(result.rows() - 1);
 
     // compute LOO
-    this->LOO = zeros(this->getCoDomainSize());
+    this->LOO = zeros(cod);
 
-    for(unsigned int i = 0; i < this->getCoDomainSize(); i++) {
+    for(unsigned int i = 0; i < cod; i++) {
         yarp::sig::Vector alphas_i = this->alphas.getCol(i);
         for(size_t j = 0; j < alphas_i.size(); j++) {
             double err = alphas_i(j) / Kinv(j, j);
@@ -144,26 +328,36 @@ void LSSVMLearner::train() {
 
 Prediction LSSVMLearner::predict(const yarp::sig::Vector& input) {
     this->checkDomainSize(input);
+    this->updateWeights();
 
-    if(this->inputs.size() == 0) {
+    // samples collected after training are not part of the expansion
+    unsigned int n = this->alphas.rows();
+    if(n == 0) {
         return zeros(this->getCoDomainSize());
     }
 
     // compute kernel expansion
-    yarp::sig::Vector k(this->inputs.size());
-    for(size_t i = 0; i < k.size(); i++) {
-        k(i) = this->kernel->evaluate(this->inputs[i], input);
-    }
+    yarp::sig::Vector k(n);
+    this->kernel->evaluate(this->inputs.data(), this->norms.data(), n,
+                           input.data(), input.size(), k.data());
+
+    yarp::sig::Vector output(this->bias);
+    cblas_dgemv(CblasRowMajor, CblasTrans, n, this->alphas.cols(), 1.0, this->alphas.data(),
+                this->alphas.cols(), k.data(), 1, 1.0, output.data(), 1);
 
-    return Prediction((this->alphas.transposed() * k) + this->bias);
+    return Prediction(output);
 }
 
 void LSSVMLearner::reset() {
     this->inputs.clear();
+    this->norms.clear();
     this->outputs.clear();
+    this->sampleCount = 0;
     this->alphas = yarp::sig::Matrix();
     this->LOO.clear();
     this->bias.clear();
+    this->Hinv = yarp::sig::Matrix();
+    this->solved = true;
 }
 
 LSSVMLearner* LSSVMLearner::clone() {
@@ -174,7 +368,9 @@ std::string LSSVMLearner::getInfo() {
     std::ostringstream buffer;
     buffer << this->IFixedSizeLearner::getInfo();
     buffer << "C: " << this->getC() << " | ";
-    buffer << "Collected Samples: " << this->inputs.size() << " | ";
+    buffer << "Online: " << (this->online ? "yes" : "no") << " | ";
+    buffer << "Budget: " << this->budget << " | ";
+    buffer << "Collected Samples: " << this->sampleCount << " | ";
     buffer << "Training Samples: " << this->alphas.rows() << " | ";
     buffer << "Kernel: " << this->kernel->getInfo() << std::endl;
     buffer << "LOO: " << this->LOO.toString() << std::endl;
@@ -186,30 +382,30 @@ std::string LSSVMLearner::getConfigHelp() {
     buffer << this->IFixedSizeLearner::getConfigHelp();
     //buffer << "  kernel idx|all cfg    Kernel configuration" << std::endl;
     buffer << "  c val                 Tradeoff parameter C" << std::endl;
+    buffer << "  online 0|1            Learn online without retraining" << std::endl;
+    buffer << "  budget n              Maximum number of samples online (0: no limit)" << std::endl;
     buffer << this->kernel->getConfigHelp() << std::endl;
     return buffer.str();
 }
 
 void LSSVMLearner::writeBottle(yarp::os::Bottle& bot) {
+    this->updateWeights();
+
     // write kernel gamma
     bot << this->kernel->getGamma() << this->getC() << this->bias
         << this->alphas;
 
     // write inputs
     for(unsigned int i = 0; i < this->inputs.size(); i++) {
-        for(unsigned int d = 0; d < this->getDomainSize(); d++) {
-            bot.addFloat64(this->inputs[i](d));
-        }
+        bot.addFloat64(this->inputs[i]);
     }
-    bot.addInt32(this->inputs.size());
+    bot.addInt32(this->sampleCount);
 
     // write outputs
     for(unsigned int i = 0; i < this->outputs.size(); i++) {
-        for(unsigned int d = 0; d < this->getCoDomainSize(); d++) {
-            bot.addFloat64(this->outputs[i](d));
-        }
+        bot.addFloat64(this->outputs[i]);
     }
-    bot.addInt32(this->outputs.size());
+    bot.addInt32(this->sampleCount);
 
     // make sure to call the superclass's method
     this->IFixedSizeLearner::writeBottle(bot);
@@ -220,37 +416,67 @@ void LSSVMLearner::readBottle(yarp::os::Bottle& bot) {
     this->IFixedSizeLearner::readBottle(bot);
 
     // read outputs
-    this->outputs.resize(bot.pop().asInt32());
+    this->sampleCount = bot.pop().asInt32();
+    this->outputs.resize(this->sampleCount * this->getCoDomainSize());
     for(int i = this->outputs.size() - 1; i >= 0; i--) {
-        this->outputs[i].resize(this->getCoDomainSize());
-        for(int d = this->getCoDomainSize() - 1; d >= 0; d--) {
-            this->outputs[i](d) = bot.pop().asFloat64();
-        }
+        this->outputs[i] = bot.pop().asFloat64();
     }
 
     // read inputs
-    this->inputs.resize(bot.pop().asInt32());
+    this->sampleCount = bot.pop().asInt32();
+    this->inputs.resize(this->sampleCount * this->getDomainSize());
     for(int i = this->inputs.size() - 1; i >= 0; i--) {
-        this->inputs[i].resize(this->getDomainSize());
-        for(int d = this->getDomainSize() - 1; d >= 0; d--) {
-            this->inputs[i](d) = bot.pop().asFloat64();
-        }
+        this->inputs[i] = bot.pop().asFloat64();
+    }
+    this->norms.resize(this->sampleCount);
+    for(unsigned int i = 0; i < this->sampleCount; i++) {
+        const double* x = this->inputs.data() + i * this->getDomainSize();
+        this->norms[i] = cblas_ddot(this->getDomainSize(), x, 1, x, 1);
     }
 
     double c;
     double gamma;
     bot >> this->alphas >> this->bias >> c >> gamma;
-    this->setC(c);
     this->kernel->setGamma(gamma);
+    this->setC(c);
 }
 
 void LSSVMLearner::setDomainSize(unsigned int size) {
     this->IFixedSizeLearner::setDomainSize(size);
+    this->reset();
 }
 
 void LSSVMLearner::setCoDomainSize(unsigned int size) {
     this->IFixedSizeLearner::setCoDomainSize(size);
-    //this->initAll(this->getCoDomainSize());
+    this->reset();
+}
+
+void LSSVMLearner::setC(double C) {
+    this->C = C;
+    if(this->online) {
+        this->rebuildInverse();
+    }
+}
+
+void LSSVMLearner::setOnline(bool o) {
+    if(o) {
+        this->online = true;
+        this->rebuildInverse();
+    } else {
+        // keep the last solution for the samples collected so far
+        this->updateWeights();
+        this->online = false;
+        this->Hinv = yarp::sig::Matrix();
+    }
+}
+
+void LSSVMLearner::setBudget(unsigned int b) {
+    this->budget = b;
+    if(this->online) {
+        while(this->budget > 0 && this->sampleCount > this->budget) {
+            this->removeOldest();
+        }
+    }
 }
 
 bool LSSVMLearner::configure(yarp::os::Searchable& config) {
@@ -265,7 +491,25 @@ bool LSSVMLearner::configure(yarp::os::Searchable& config) {
         }
     }
 
-    success |= this->kernel->configure(config);
+    // format: set budget int
+    if(config.find("budget").isInt32() && config.find("budget").asInt32() >= 0) {
+        this->setBudget(config.find("budget").asInt32());
+        success = true;
+    }
+
+    // format: set online 0|1
+    if(config.find("online").isInt32()) {
+        this->setOnline(config.find("online").asInt32() != 0);
+        success = true;
+    }
+
+    if(this->kernel->configure(config)) {
+        // the inverse depends on the kernel parameters
+        if(this->online) {
+            this->rebuildInverse();
+        }
+        success = true;
+    }
 
     return success;
 }
@@ -164,6 +164,59 @@ void cholupdate(yarp::sig::Matrix& R, const yarp::sig::Vector& x, bool rtrans) {
     gsl_linalg_cholesky_update(Rgsl, xgsl, cgsl, sgsl, NULL, NULL, NULL, (unsigned char) rtrans, 0);
 }
 
+void cholupdate(yarp::sig::Matrix& R, const yarp::sig::Matrix& X) {
+    assert(R.rows() == R.cols());
+    assert(X.cols() == R.cols());
+
+    int p = R.cols();
+    int k = X.rows();
+    if(k == 0) {
+        return;
+    }
+
+    // transposed copy, such that each column of the block is contiguous
+    yarp::sig::Matrix Xt = X.transposed();
+
+    for(int j = 0; j < p; j++) {
+        double* rj = R[j];
+        double* xj = Xt[j];
+        double sigma = cblas_ddot(k, xj, 1, xj, 1);
+        if(sigma == 0.0) {
+            continue;
+        }
+
+        // reflection mapping [R(j,j); X(:,j)] onto [mu; 0]
+        double alpha = rj[j];
+        double norm = sqrt(alpha * alpha + sigma);
+        double mu = (alpha > 0.0) ? -norm : norm;
+        double v0 = alpha - mu;
+        double tau = 2.0 / (v0 * v0 + sigma);
+
+        // apply the reflection to the trailing columns
+        for(int c = j + 1; c < p; c++) {
+            double* xc = Xt[c];
+            double s = tau * (v0 * rj[c] + cblas_ddot(k, xj, 1, xc, 1));
+            rj[c] -= s * v0;
+            cblas_daxpy(k, -s, xj, 1, xc, 1);
+        }
+        rj[j] = mu;
+
+        // force positive values on the diagonal
+        if(mu < 0.0) {
+            for(int c = j; c < p; c++) {
+                rj[c] = -rj[c];
+            }
+        }
+    }
+
+    // reflect, as GSL functions expects duplicate information (i.e., lower and upper triangles)
+    for(int i = 0; i < p; i++) {
+        for(int j = 0; j < i; j++) {
+            R(i, j) = R(j, i);
+        }
+    }
+}
+
 void cholsolve(const yarp::sig::Matrix& R, const yarp::sig::Matrix& B, yarp::sig::Matrix& X) {
     assert(B.rows() == X.rows());
     assert(B.cols() == X.cols());
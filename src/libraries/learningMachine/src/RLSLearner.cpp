@@ -20,6 +20,8 @@
 #include <stdexcept>
 #include <cmath>
 
+#include <gsl/gsl_blas.h>
+
 #include <yarp/math/Math.h>
 
 #include "iCub/learningMachine/RLSLearner.h"
@@ -47,7 +49,7 @@ RLSLearner::RLSLearner(unsigned int dom, unsigned int cod, double lambda) {
 
 RLSLearner::RLSLearner(const RLSLearner& other)
   : IFixedSizeLearner(other), sampleCount(other.sampleCount), R(other.R),
-    B(other.B), W(other.W), lambda(other.lambda) {
+    B(other.B), W(other.W), lambda(other.lambda), solved(other.solved) {
 }
 
 RLSLearner::~RLSLearner() {
@@ -63,6 +65,7 @@ RLSLearner& RLSLearner::operator=(const RLSLearner& other) {
     this->B = other.B;
     this->W = other.W;
     this->lambda = other.lambda;
+    this->solved = other.solved;
 
     return *this;
 }
@@ -74,20 +77,59 @@ void RLSLearner::feedSample(const yarp::sig::Vector& input, const yarp::sig::Vec
     cholupdate(this->R, input);
 
     // update B
-    this->B = this->B + outerprod(output, input);
+    for(size_t i = 0; i < this->B.rows(); i++) {
+        cblas_daxpy(this->B.cols(), output[i], input.data(), 1, this->B[i], 1);
+    }
 
-    // update W
-    cholsolve(this->R, this->B, this->W);
+    // W is solved lazily
+    this->solved = false;
 
     this->sampleCount++;
 }
 
-void RLSLearner::train() {
+void RLSLearner::feedSamples(const yarp::sig::Matrix& inputs, const yarp::sig::Matrix& outputs) {
+    if(inputs.rows() != outputs.rows()) {
+        throw std::runtime_error("Number of inputs and outputs in batch differ");
+    }
+    if(inputs.cols() != this->getDomainSize()) {
+        throw std::runtime_error("Input sample has invalid dimensionality");
+    }
+    if(outputs.cols() != this->getCoDomainSize()) {
+        throw std::runtime_error("Output sample has invalid dimensionality");
+    }
+    if(inputs.rows() == 0) {
+        return;
+    }
+
+    // update R with all samples at once
+    cholupdate(this->R, inputs);
 
+    // update B += outputs' * inputs
+    gsl_matrix_const_view in = gsl_matrix_const_view_array(inputs.data(), inputs.rows(), inputs.cols());
+    gsl_matrix_const_view out = gsl_matrix_const_view_array(outputs.data(), outputs.rows(), outputs.cols());
+    gsl_matrix_view b = gsl_matrix_view_array(this->B.data(), this->B.rows(), this->B.cols());
+    gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, &out.matrix, &in.matrix, 1.0, &b.matrix);
+
+    // W is solved lazily
+    this->solved = false;
+
+    this->sampleCount += inputs.rows();
+}
+
+void RLSLearner::updateWeights() {
+    if(!this->solved) {
+        cholsolve(this->R, this->B, this->W);
+        this->solved = true;
+    }
+}
+
+void RLSLearner::train() {
+    this->updateWeights();
 }
 
 Prediction RLSLearner::predict(const yarp::sig::Vector& input) {
     this->checkDomainSize(input);
+    this->updateWeights();
 
     yarp::sig::Vector output = (this->W * input);
 
@@ -99,6 +141,7 @@ void RLSLearner::reset() {
     this->R = eye(this->getDomainSize(), this->getDomainSize()) * sqrt(this->lambda);
     this->B = zeros(this->getCoDomainSize(), this->getDomainSize());
     this->W = zeros(this->getCoDomainSize(), this->getDomainSize());
+    this->solved = true;
 }
 
 std::string RLSLearner::getInfo() {
@@ -122,6 +165,7 @@ std::string RLSLearner::getConfigHelp() {
 }
 
 void RLSLearner::writeBottle(yarp::os::Bottle& bot) {
+    this->updateWeights();
     bot << this->R << this->B << this->W << this->lambda << this->sampleCount;
     // make sure to call the superclass's method
     this->IFixedSizeLearner::writeBottle(bot);
@@ -131,6 +175,7 @@ void RLSLearner::readBottle(yarp::os::Bottle& bot) {
     // make sure to call the superclass's method
     this->IFixedSizeLearner::readBottle(bot);
     bot >> this->sampleCount >> this->lambda >> this->W >> this->B >> this->R;
+    this->solved = true;
 }
 
 void RLSLearner::setDomainSize(unsigned int size) {
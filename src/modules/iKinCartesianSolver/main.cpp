@@ -85,6 +85,7 @@ verbosity      off
 maxIter        200
 tol            0.001
 interPoints    off
+warmStart      on
 ping_robot_tmo 20.0
 \endcode
 
@@ -106,6 +107,7 @@ verbosity       off
 maxIter         200
 tol             0.001
 interPoints     off
+warmStart       on
 ping_robot_tmo  20.0
 
 CustomKinFile   cartesian/kinematics.ini
@@ -44,12 +44,22 @@ private:
     GazeIpOptMin(const GazeIpOptMin&);
     GazeIpOptMin &operator=(const GazeIpOptMin&);
 
+protected:
+    bool fastPathOn;
+
+    bool solveFast(const Vector &q0, const Vector &xd, const Vector &qRest, Vector &qd);
+
 public:
     GazeIpOptMin(iKinChain &_chain, const double tol, const double constr_tol,
                  const int max_iter=IKINCTRL_DISABLED,
                  const unsigned int verbose=0) :
                  iKinIpOptMin(_chain,IKINCTRL_POSE_XYZ,tol,constr_tol,
-                              max_iter,verbose,false) { }
+                              max_iter,verbose,false), fastPathOn(false) { }
+
+    // the fast path solves the problem through few Newton steps
+    // and falls back on IPOPT whenever the joints bounds are active
+    void   setFastPath(const bool sw)                 { fastPathOn=sw;     }
+    bool   getFastPath() const                        { return fastPathOn; }
 
     void   set_ctrlPose(const unsigned int _ctrlPose) { }
     bool   set_posePriority(const string &priority)   { return false; }
@@ -172,6 +172,8 @@ public:
     void   clearNeckYaw();
     double getNeckAngleUserTolerance() const;
     void   setNeckAngleUserTolerance(const double angle);    
+    bool   getNeckFastSolver();
+    void   setNeckFastSolver(const bool sw);
     bool   threadInit() override;
     void   threadRelease() override;
     void   afterStart(bool s) override;
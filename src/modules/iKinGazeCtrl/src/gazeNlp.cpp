@@ -23,9 +23,51 @@
 #include <IpTNLP.hpp>
 #include <IpIpoptApplication.hpp>
 
+#include <yarp/math/SVD.h>
+
 #include <iCub/gazeNlp.h>
 #include <iCub/utils.h>
 
+constexpr int    FASTPATH_MAX_ITER  = 20;      // [-]
+constexpr double FASTPATH_TOL       = 1e-6;    // [-]
+constexpr double FASTPATH_MAX_STEP  = 0.5;     // [rad]
+
+
+/************************************************************************/
+// Transition function (and its first derivative) that goes to zero
+// as the neck pitch approaches its minimum
+static double pitchTransition(iKinChain &chain, const double pitch, double *dfPitch=nullptr)
+{
+    double offset=5.0*CTRL_DEG2RAD;
+    double delta=1.0*CTRL_DEG2RAD;
+    double pitch_cog=chain(0).getMin()+offset+delta/2.0;
+    double c=10.0/delta;
+    double _tanh=tanh(c*(pitch-pitch_cog));
+
+    if (dfPitch!=nullptr)
+        *dfPitch=0.5*c*(1.0-_tanh*_tanh);
+
+    return 0.5*(1.0+_tanh);
+}
+
+
+/************************************************************************/
+// Compute the rest posture of the neck pitch and roll that
+// depends on the gravity direction
+static void computeRestPosture(iKinChain &chain, const Vector &gDir, Vector &qRest)
+{
+    Vector gDir_=SE3inv(chain.getH(2,true)).submatrix(0,2,0,2)*gDir;
+    qRest.resize(chain.getDOF(),0.0);
+
+    // rest pitch
+    qRest[0]=CTRL_PI/2.0+atan2(gDir_[1],gDir_[0]);
+    qRest[0]=sat(qRest[0],chain(0).getMin(),chain(0).getMax());
+
+    // rest roll
+    qRest[1]=-CTRL_PI/2.0-atan2(gDir_[1],gDir_[2]);
+    qRest[1]=sat(qRest[1],chain(1).getMin(),chain(1).getMax());
+}
+
 
 // Describe the nonlinear problem of aligning two vectors
 // in counterphase for controlling neck movements.
@@ -83,17 +125,10 @@ protected:
             mod=norm(Hxd,3);
             cosAng=dot(Hxd,2,Hxd,3)/mod;
 
-            double offset=5.0*CTRL_DEG2RAD;
-            double delta=1.0*CTRL_DEG2RAD;
-            double pitch_cog=chain(0).getMin()+offset+delta/2.0;
-            double c=10.0/delta;
-            double _tanh=tanh(c*(q[0]-pitch_cog));
-
             // transition function and its first derivative
             // to block the roll around qRest[1] when the pitch
             // approaches its minimum
-            fPitch=0.5*(1.0+_tanh);
-            dfPitch=0.5*c*(1.0-_tanh*_tanh);
+            fPitch=pitchTransition(chain,q[0],&dfPitch);
             
             GeoJacobP=chain.GeoJacobian();
             AnaJacobZ=chain.AnaJacobian(2);
@@ -312,15 +347,7 @@ public:
     /************************************************************************/
     void setGravityDirection(const Vector &gDir)
     {
-        Vector gDir_=SE3inv(chain.getH(2,true)).submatrix(0,2,0,2)*gDir;
-
-        // rest pitch
-        qRest[0]=CTRL_PI/2.0+atan2(gDir_[1],gDir_[0]);
-        qRest[0]=sat(qRest[0],chain(0).getMin(),chain(0).getMax());
-
-        // rest roll
-        qRest[1]=-CTRL_PI/2.0-atan2(gDir_[1],gDir_[2]);
-        qRest[1]=sat(qRest[1],chain(1).getMin(),chain(1).getMax());
+        computeRestPosture(chain,gDir,qRest);
     }
 
     /************************************************************************/
@@ -328,9 +355,117 @@ public:
 };
 
 
+/************************************************************************/
+bool GazeIpOptMin::solveFast(const Vector &q0, const Vector &xd,
+                             const Vector &qRest, Vector &qd)
+{
+    unsigned int dim=chain.getDOF();
+    qd.resize(dim,0.0);
+
+    size_t n=std::min(q0.length(),(size_t)dim);
+    for (size_t i=0; i<n; i++)
+        qd[i]=q0[i];
+
+    // The head-centered z-axis shall point toward the target while
+    // staying as close as possible to the rest posture: the pointing
+    // error is projected onto the plane orthogonal to the target
+    // direction, which yields two independent equations, whereas the
+    // remaining redundancy is exploited to descend toward qRest.
+    // At convergence the KKT conditions of the NLP without the
+    // inequalities are met.
+    Matrix J,A(2,dim);
+    Vector e(2),dq(dim);
+    bool converged=false;
+    double cosAng=-1.0;
+
+    for (int iter=0; iter<FASTPATH_MAX_ITER; iter++)
+    {
+        chain.setAng(qd);
+        Matrix H=chain.getH();
+        chain.GeoJacobian(J);
+
+        Vector z=H.getCol(2).subVector(0,2);
+        Vector d=xd.subVector(0,2)-H.getCol(3).subVector(0,2);
+        double rho=norm(d);
+        if (rho<IKIN_ALMOST_ZERO)
+            return false;
+
+        d/=rho;
+        cosAng=dot(z,d);
+
+        // basis of the plane orthogonal to d
+        Vector t(3,0.0);
+        t[fabs(d[0])<0.9?0:1]=1.0;
+        Vector u=cross(d,t); u/=norm(u);
+        Vector v=cross(d,u);
+
+        e[0]=dot(u,d-z);
+        e[1]=dot(v,d-z);
+
+        for (unsigned int i=0; i<dim; i++)
+        {
+            Vector jp=J.subcol(0,i,3);
+            Vector jw=J.subcol(3,i,3);
+
+            // derivatives of the target direction and of the z-axis
+            Vector dd=-1.0/rho*(jp-dot(d,jp)*d);
+            Vector dz=cross(jw,z);
+
+            A(0,i)=dot(u,dd-dz);
+            A(1,i)=dot(v,dd-dz);
+        }
+
+        Matrix pinvA=pinv(A);
+        Vector g=qRest-qd;
+        dq=pinvA*(-1.0*e-A*g)+g;
+
+        double step=norm(dq);
+        if (step>FASTPATH_MAX_STEP)
+            dq*=FASTPATH_MAX_STEP/step;
+
+        qd+=dq;
+
+        if ((norm(e)<FASTPATH_TOL) && (step<FASTPATH_TOL))
+        {
+            converged=true;
+            break;
+        }
+    }
+
+    // z pointing away from the target is a spurious solution
+    if (!converged || (cosAng<=0.0))
+        return false;
+
+    // resort to IPOPT as soon as any bound is active:
+    // this includes the region where the roll is blocked
+    for (unsigned int i=0; i<dim; i++)
+        if ((qd[i]<=chain(i).getMin()) || (qd[i]>=chain(i).getMax()))
+            return false;
+
+    double fPitch=pitchTransition(chain,qd[0]);
+    if ((qd[1]-qRest[1]<(chain(1).getMin()-qRest[1])*fPitch) ||
+        (qd[1]-qRest[1]>(chain(1).getMax()-qRest[1])*fPitch))
+        return false;
+
+    qd=chain.setAng(qd);
+    return true;
+}
+
+
 /************************************************************************/
 Vector GazeIpOptMin::solve(const Vector &q0, Vector &xd, const Vector &gDir)
 {
+    if (fastPathOn)
+    {
+        Vector qRest,qd;
+        computeRestPosture(chain,gDir,qRest);
+        if (solveFast(q0,xd,qRest,qd))
+            return qd;
+
+        // restore the starting configuration for IPOPT
+        chain.setAng(q0);
+    }
+
     Ipopt::SmartPtr<HeadCenter_NLP> nlp;
     nlp=new HeadCenter_NLP(chain,q0,xd);
 
@@ -143,6 +143,13 @@ Shifts 8 8 8 8 8 8 ...
   parameter \e switch can be therefore ["on"|"off"], being "on"
   by default.
 
+--neck_solver \e type
+- Select the solver in charge of computing the neck configuration;
+  the parameter \e type can be ["ipopt"|"fast"], being "ipopt" by
+  default. The "fast" solver relies on few Newton steps to reduce
+  the gaze retargeting latency and falls back on IPOPT whenever the
+  neck joints bounds are active.
+
 --imu::mode \e switch
 - Enable/disable stabilization using IMU data; the parameter
   \e switch can be therefore ["on"|"off"], being "on"
@@ -382,6 +389,8 @@ following ports:
       means no constraint.
     - [get] [ntol]: returns in degrees the current user
       tolerance for gazing with the neck.
+    - [get] [nfst]: returns the status of the fast solver for
+      the neck [0/1].
     - [get] [des]: returns the desired head joints angles that
       achieve the target [deg].
     - [get] [vel]: returns the head joints velocities commanded
@@ -446,6 +455,8 @@ following ports:
       [deg].
     - [set] [ntol] <val>: sets in degrees the new user tolerance
       for gazing with the neck.
+    - [set] [nfst] <val>: enables/disables the fast solver for
+      the neck; val can be [0/1].
     - [set] [track] <val>: sets the controller's tracking mode;
       val can be [0/1].
     - [set] [stab] <val>: turns on/off the gaze stabilization
@@ -613,6 +624,7 @@ protected:
         double neckYawMin;
         double neckYawMax;
         double neckAngleUserTolerance;
+        bool   neckFastSolverOn;
         double eyesBoundVer;
         Vector counterRotGain;
         bool   saccadesOn;
@@ -679,6 +691,7 @@ protected:
         slv->getCurNeckRollRange(context.neckRollMin,context.neckRollMax);
         slv->getCurNeckYawRange(context.neckYawMin,context.neckYawMax);
         context.neckAngleUserTolerance=slv->getNeckAngleUserTolerance();
+        context.neckFastSolverOn=slv->getNeckFastSolver();
         context.eyesBoundVer=commData.eyesBoundVer;
         context.counterRotGain=eyesRefGen->getCounterRotGain();
         context.saccadesOn=commData.saccadesOn;
@@ -712,6 +725,7 @@ protected:
             slv->bindNeckRoll(context.neckRollMin,context.neckRollMax);
             slv->bindNeckYaw(context.neckYawMin,context.neckYawMax);
             slv->setNeckAngleUserTolerance(context.neckAngleUserTolerance);
+            slv->setNeckFastSolver(context.neckFastSolverOn);
             eyesRefGen->manageBindEyes(context.eyesBoundVer);
             eyesRefGen->setCounterRotGain(context.counterRotGain);
             commData.saccadesOn=context.saccadesOn;
@@ -1278,6 +1292,7 @@ public:
         loc=new Localizer(&commData,10);
         eyesRefGen=new EyePinvRefGen(drvTorso,drvHead,&commData,ctrl,counterRotGain,20);
         slv=new Solver(drvTorso,drvHead,&commData,eyesRefGen,loc,ctrl,20);
+        slv->setNeckFastSolver(rf.check("neck_solver",Value("ipopt")).asString()=="fast");
 
         commData.port_xd=new xdPort(slv);
         commData.port_xd->open(commData.localStemName+"/xd:i");
@@ -1429,6 +1444,12 @@ public:
                             reply.addFloat64(angle);
                             return true;
                         }
+                        else if (type==createVocab32('n','f','s','t'))
+                        {
+                            reply.addVocab32(ack);
+                            reply.addInt32((int)slv->getNeckFastSolver());
+                            return true;
+                        }
                         else if (type==createVocab32('d','e','s'))
                         {
                             Vector des;
@@ -1695,6 +1716,12 @@ public:
                             reply.addVocab32(ack);
                             return true;
                         }
+                        else if (type==createVocab32('n','f','s','t'))
+                        {
+                            slv->setNeckFastSolver(command.get(2).asInt32()>0);
+                            reply.addVocab32(ack);
+                            return true;
+                        }
                         else if (type==createVocab32('t','r','a','c'))
                         {
                             bool mode=(command.get(2).asInt32()>0);
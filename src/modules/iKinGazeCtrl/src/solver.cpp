@@ -681,6 +681,22 @@ void Solver::setNeckAngleUserTolerance(const double angle)
 }
 
 
+/************************************************************************/
+bool Solver::getNeckFastSolver()
+{
+    lock_guard<mutex> lck(mtx);
+    return invNeck->getFastPath();
+}
+
+
+/************************************************************************/
+void Solver::setNeckFastSolver(const bool sw)
+{
+    lock_guard<mutex> lck(mtx);
+    invNeck->setFastPath(sw);
+}
+
+
 /************************************************************************/
 void Solver::updateAngles()
 {
@@ -44,13 +44,43 @@ private:
      */
     bool enabled;
 
+    /**
+     * Maximum number of samples fed to the machine at once.
+     */
+    unsigned int batchSize;
+
+    /**
+     * The port the training samples are read from, which is drained when
+     * feeding batches.
+     */
+    yarp::os::BufferedPort< yarp::os::PortablePair<yarp::sig::Vector,yarp::sig::Vector> >* port;
+
+    /**
+     * Feeds the given sample along with the samples that are already queued
+     * on the port, up to the batch size.
+     *
+     * @param sample the sample that has just been read
+     */
+    void feedBatch(const yarp::os::PortablePair<yarp::sig::Vector,yarp::sig::Vector>& sample);
+
 public:
     /**
      * Constructor.
      *
      * @param mp a reference to a machine portable.
      */
-    TrainProcessor(MachinePortable& mp) : IMachineProcessor(mp), enabled(true) { }
+    TrainProcessor(MachinePortable& mp) : IMachineProcessor(mp), enabled(true), batchSize(1), port(0) { }
+
+    /**
+     * Enables feeding the samples queued on the port in batches.
+     *
+     * @param p the port the samples are read from
+     * @param size the maximum number of samples in a batch
+     */
+    virtual void setBatch(yarp::os::BufferedPort< yarp::os::PortablePair<yarp::sig::Vector,yarp::sig::Vector> >* p, unsigned int size) {
+        this->port = p;
+        this->batchSize = (size > 0) ? size : 1;
+    }
 
     /**
      * Enables or disables processing of training samples.
@@ -16,6 +16,7 @@
  * Public License for more details
  */
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <cassert>
@@ -32,6 +33,12 @@ namespace learningmachine {
 void TrainProcessor::onRead(yarp::os::PortablePair<yarp::sig::Vector,yarp::sig::Vector>& sample) {
     if(this->getMachinePortable().hasWrapped() && this->enabled) {
         try {
+            // samples are passed one at a time if events need to be raised
+            if(this->batchSize > 1 && this->port != 0 && !EventDispatcher::instance().hasListeners()) {
+                this->feedBatch(sample);
+                return;
+            }
+
             // Event Code
             if(EventDispatcher::instance().hasListeners()) {
                 Prediction prediction = this->getMachine().predict(sample.head);
@@ -50,6 +57,51 @@ void TrainProcessor::onRead(yarp::os::PortablePair<yarp::sig::Vector,yarp::sig::
     return;
 }
 
+void TrainProcessor::feedBatch(const yarp::os::PortablePair<yarp::sig::Vector,yarp::sig::Vector>& sample) {
+    size_t dom = sample.head.size();
+    size_t cod = sample.body.size();
+    size_t size = std::min<size_t>(this->batchSize, 1 + this->port->getPendingReads());
+    if(size == 1 || dom == 0 || cod == 0) {
+        this->getMachine().feedSample(sample.head, sample.body);
+        return;
+    }
+
+    yarp::sig::Matrix inputs(size, dom);
+    yarp::sig::Matrix outputs(size, cod);
+    inputs.setRow(0, sample.head);
+    outputs.setRow(0, sample.body);
+
+    // drain the samples that are already waiting, without blocking
+    size_t count = 1;
+    while(count < size) {
+        yarp::os::PortablePair<yarp::sig::Vector,yarp::sig::Vector>* next = this->port->read(false);
+        if(next == 0) {
+            break;
+        }
+
+        // a sample of a different size is passed on its own, such that the
+        // machine reports the error without discarding the whole batch
+        if(next->head.size() != dom || next->body.size() != cod) {
+            try {
+                this->getMachine().feedSample(next->head, next->body);
+            } catch(const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+            continue;
+        }
+
+        inputs.setRow(count, next->head);
+        outputs.setRow(count, next->body);
+        count++;
+    }
+
+    if(count < size) {
+        inputs = inputs.submatrix(0, count - 1, 0, dom - 1);
+        outputs = outputs.submatrix(0, count - 1, 0, cod - 1);
+    }
+    this->getMachine().feedSamples(inputs, outputs);
+}
+
 
 void TrainModule::printOptions(std::string error) {
     if(error != "") {
@@ -61,6 +113,7 @@ void TrainModule::printOptions(std::string error) {
     std::cout << "--load file            Load serialized machine from a file" << std::endl;
     std::cout << "--machine type         Desired type of learning machine" << std::endl;
     std::cout << "--port pfx             Prefix for registering the ports" << std::endl;
+    std::cout << "--batch size           Feed up to size queued samples at once (default: 1)" << std::endl;
     std::cout << "--commands file        Load configuration commands from a file" << std::endl;
 }
 
@@ -154,6 +207,14 @@ bool TrainModule::configure(yarp::os::ResourceFinder& opt) {
 
     // add processor for incoming data (training samples)
     this->train_in.useCallback(trainProcessor);
+    if(opt.check("batch", val)) {
+        if(val->isInt32() && val->asInt32() > 0) {
+            this->trainProcessor.setBatch(&this->train_in, val->asInt32());
+        } else {
+            this->printOptions("Batch size has to be a positive integer");
+            return false;
+        }
+    }
 
     // register ports before connecting
     this->registerAllPorts();
@@ -138,10 +138,22 @@ content to a yarp port each <T> seconds. The parameter <T> is
 optional. 
  
 <b>asynchronous broadcast</b> \n 
-<i>Format</i>: [async] [on]/[off] \n 
+<i>Format</i>: [async] [on]/[delta]/[off] \n 
 <i>Reply</i>: [nack]; [ack] \n 
 <i>Action</i>: ask the database to enable/disable the broadcast 
 toward a yarp port whenever a change in the content occurs. 
+With [on] the whole content is broadcast, whereas with [delta] 
+only the changes are streamed (see the \e delta format below). 
+ 
+<b>snapshot</b> \n 
+<i>Format</i>: [snap] \n 
+<i>Reply</i>: [ack] <seq> ((("prop0" <val0>) ... ("id" <num>)) ...) \n 
+<i>Action</i>: retrieve the whole content of the database along 
+with the sequence number of the last change it accounts for. 
+Consumers of the delta broadcasts request a snapshot at startup 
+and whenever they detect a gap in the sequence numbers, then 
+apply only the deltas whose sequence number is greater than 
+<seq>. 
  
 <b>ask</b> \n
 <i>Format</i>: [ask] (("prop0" "<" <val0>) || ("prop1" ">=" 
@@ -200,9 +212,45 @@ to (cond1)&&(cond2) || (cond1)&&(cond3).
 --async-bc 
 - Broadcast the database content whenever a change occurs. 
  
+--delta-bc 
+- Broadcast only the changes whenever they occur; this option 
+  implies \e --async-bc. 
+ 
 --stats 
 - Enable statistics printouts.
  
+--journal 
+- Persist the database through an append-only binary journal of
+  the changes rather than rewriting the \e dbFileName file. The 
+  changes are committed in groups by a background thread to the
+  file \e dbFileName.journal, which is compacted periodically 
+  into the file \e dbFileName.snapshot. At startup the snapshot 
+  is memory-mapped and the journal is replayed on top of it; if 
+  neither exists, \e dbFileName is loaded instead. Incomplete 
+  records left by a crash at the tail of the journal are 
+  discarded. This option has no effect along with 
+  \e --no-save-db.
+ 
+--journal-period <T> 
+- The time window in seconds over which changes are grouped 
+  before being committed to the journal; 0.05 by default.
+ 
+--journal-max-size <S> 
+- The journal is compacted into the snapshot once it grows 
+  beyond \e S megabytes; 4 by default.
+ 
+--index "(prop0 prop1 ...)" 
+- The list of properties the database keeps indexed; a single 
+  property name can be given as well. Indexes are maintained 
+  throughout add/set/del requests and let [ask] queries visit 
+  only the items that can satisfy the conditions: equality tests
+  are answered through hash lookups, whereas ranges over integer
+  and floating point values rely on ordered indexes. Within each
+  "&&" group the most selective indexed condition is picked 
+  first; if a group has no indexed condition, the whole query 
+  falls back to the linear scan. Condition "!=" is never served 
+  by the indexes. 
+ 
 \section portsa_sec Ports Accessed
 None.
 
@@ -212,7 +260,16 @@ None.
   send requests to the database and receive replies.
 
 - \e /<moduleName>/broadcast:o the port used to broadcast the 
-  database content in synchronous and asynchronous mode.
+  database content in synchronous and asynchronous mode. In
+  delta mode the port streams bottles in the format "delta"
+  (<seq> add <id> (("prop0" <val0>) ...)) (<seq> set <id> 
+  (("prop0" <val0>) ...)) (<seq> del <id> ("prop0" ...)) 
+  (<seq> del <id>) (<seq> clear) (<seq> reset) ..., where 
+  <seq> is incremented by one at each change of the database; 
+  "reset" signals that the content has been replaced through the
+  modify port and calls for a new snapshot. Decrements of the 
+  \e lifeTimer property are not streamed, whereas the removal of
+  expired items is.
  
 - \e /<moduleName>/modify:i the port used to modify the database
   content complying with the data format implemented for the
@@ -257,12 +314,34 @@ reply: [ack] (id (1))
 
 #include <cstdio>
 #include <cstdarg>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <functional>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <fstream>
 #include <sstream>
+#include <iomanip>
+#include <iterator>
 #include <string>
 #include <map>
+#include <set>
+#include <memory>
+#include <vector>
+#include <unordered_map>
 #include <deque>
 
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#else
+    #include <io.h>
+#endif
+
 #include <yarp/os/all.h>
 
 using namespace std;
@@ -280,6 +359,7 @@ using namespace yarp::os;
 #define CMD_ASK                         createVocab32('a','s','k')
 #define CMD_SYNC                        createVocab32('s','y','n','c')
 #define CMD_ASYNC                       createVocab32('a','s','y','n')
+#define CMD_SNAP                        createVocab32('s','n','a','p')
 #define CMD_QUIT                        createVocab32('q','u','i','t')
 #define CMD_BYE                         createVocab32('b','y','e')
                                         
@@ -297,6 +377,7 @@ using namespace yarp::os;
 #define BCTAG_EMPTY                     ("empty")
 #define BCTAG_SYNC                      ("sync")
 #define BCTAG_ASYNC                     ("async")
+#define BCTAG_DELTA                     ("delta")
 
 
 namespace relationalOperators
@@ -395,6 +476,410 @@ bool notEqual(Value &a, Value &b)
 }
 
 
+/************************************************************************/
+class Journal
+{
+public:
+    /************************************************************************/
+    struct Entry
+    {
+        char op;                    // 'a'dd, 's'et, 'd'el, 'c'lear
+        int id;
+        shared_ptr<Property> prop;  // content of added items
+        Bottle content;             // properties involved in set/del
+
+        Entry() : op('c'), id(-1) { }
+    };
+
+    typedef vector<pair<int,shared_ptr<Property>>> Snapshot;
+
+protected:
+    /************************************************************************/
+    struct Header
+    {
+        char     magic[4];
+        uint32_t version;
+        uint64_t generation;
+    };
+
+    string snapshotFileName;
+    string journalFileName;
+    double period;
+    size_t maxSize;
+    function<void(Snapshot&)> takeSnapshot;
+
+    FILE    *fout;
+    size_t   size;
+    uint64_t generation;
+
+    thread writer;
+    mutex mtx;
+    condition_variable cv;
+    deque<Entry> pending;
+    bool compactRequested;
+    bool closing;
+
+    /************************************************************************/
+    static uint32_t checksum(const char *data, const size_t len)
+    {
+        // FNV-1a
+        uint32_t h=2166136261u;
+        for (size_t i=0; i<len; i++)
+        {
+            h^=(unsigned char)data[i];
+            h*=16777619u;
+        }
+
+        return h;
+    }
+
+    /************************************************************************/
+    static void encode(const Entry &entry, string &buf)
+    {
+        // [payload length][op][id][payload][checksum of op, id and payload]
+        string payload=(entry.prop?entry.prop->toString():entry.content.toString());
+        uint32_t len=(uint32_t)payload.size();
+        int32_t id=entry.id;
+
+        buf.append((const char*)&len,sizeof(len));
+        size_t start=buf.size();
+        buf.push_back(entry.op);
+        buf.append((const char*)&id,sizeof(id));
+        buf.append(payload);
+
+        uint32_t crc=checksum(buf.data()+start,buf.size()-start);
+        buf.append((const char*)&crc,sizeof(crc));
+    }
+
+    /************************************************************************/
+    static bool decode(const char *&ptr, const char *end, Entry &entry)
+    {
+        uint32_t len,crc;
+        int32_t id;
+        const size_t overhead=sizeof(len)+1+sizeof(id)+sizeof(crc);
+
+        if ((size_t)(end-ptr)<overhead)
+            return false;
+
+        memcpy(&len,ptr,sizeof(len));
+        if ((size_t)(end-ptr)<overhead+len)
+            return false;
+
+        const char *record=ptr+sizeof(len);
+        memcpy(&crc,record+1+sizeof(id)+len,sizeof(crc));
+        if (crc!=checksum(record,1+sizeof(id)+len))
+            return false;
+
+        memcpy(&id,record+1,sizeof(id));
+        string payload(record+1+sizeof(id),len);
+
+        entry=Entry();
+        entry.op=record[0];
+        entry.id=id;
+        if (entry.op=='a')
+            entry.prop=make_shared<Property>(payload.c_str());
+        else
+            entry.content.fromString(payload);
+
+        ptr+=overhead+len;
+        return true;
+    }
+
+    /************************************************************************/
+    static void fillHeader(Header &header, const char *magic, const uint64_t generation)
+    {
+        memcpy(header.magic,magic,sizeof(header.magic));
+        header.version=1;
+        header.generation=generation;
+    }
+
+    /************************************************************************/
+    static bool checkHeader(const char *data, const size_t len, const char *magic,
+                            Header &header)
+    {
+        if (len<sizeof(Header))
+            return false;
+
+        memcpy(&header,data,sizeof(Header));
+        return ((memcmp(header.magic,magic,sizeof(header.magic))==0) && (header.version==1));
+    }
+
+    /************************************************************************/
+    static bool mapFile(const string &fileName, const function<void(const char*,size_t)> &parse)
+    {
+    #ifndef _WIN32
+        int fd=::open(fileName.c_str(),O_RDONLY);
+        if (fd<0)
+            return false;
+
+        struct stat st;
+        if ((fstat(fd,&st)!=0) || (st.st_size==0))
+        {
+            ::close(fd);
+            return false;
+        }
+
+        void *data=mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+        ::close(fd);
+        if (data==MAP_FAILED)
+            return false;
+
+        parse((const char*)data,st.st_size);
+        munmap(data,st.st_size);
+    #else
+        ifstream fin(fileName.c_str(),ios::binary);
+        if (!fin.is_open())
+            return false;
+
+        string data((istreambuf_iterator<char>(fin)),istreambuf_iterator<char>());
+        parse(data.data(),data.size());
+    #endif
+        return true;
+    }
+
+    /************************************************************************/
+    static void sync(FILE *f)
+    {
+        fflush(f);
+    #ifndef _WIN32
+        fsync(fileno(f));
+    #else
+        _commit(_fileno(f));
+    #endif
+    }
+
+    /************************************************************************/
+    void commit(deque<Entry> &batch)
+    {
+        if (batch.empty() || (fout==NULL))
+            return;
+
+        string buf;
+        for (deque<Entry>::iterator it=batch.begin(); it!=batch.end(); it++)
+            encode(*it,buf);
+
+        if (fwrite(buf.data(),1,buf.size(),fout)!=buf.size())
+            yError("unable to append to the journal %s!",journalFileName.c_str());
+
+        sync(fout);
+        size+=buf.size();
+    }
+
+    /************************************************************************/
+    void run()
+    {
+        unique_lock<mutex> lck(mtx);
+        while (!closing)
+        {
+            cv.wait(lck,[this]() { return (closing || compactRequested || !pending.empty()); });
+
+            // let the mutations pile up to commit them as a group
+            if (!pending.empty())
+                cv.wait_for(lck,chrono::duration<double>(period),[this]() { return closing; });
+
+            deque<Entry> batch;
+            batch.swap(pending);
+            bool compactNow=compactRequested;
+            compactRequested=false;
+            lck.unlock();
+
+            commit(batch);
+            if (compactNow || (size>maxSize))
+                compact();
+
+            lck.lock();
+        }
+    }
+
+public:
+    /************************************************************************/
+    Journal() : period(0.05), maxSize(0), fout(NULL), size(0), generation(0),
+                compactRequested(false), closing(false) { }
+
+    /************************************************************************/
+    void configure(const string &baseName, const double period, const size_t maxSize,
+                   const function<void(Snapshot&)> &takeSnapshot)
+    {
+        snapshotFileName=baseName+".snapshot";
+        journalFileName=baseName+".journal";
+        this->period=period;
+        this->maxSize=maxSize;
+        this->takeSnapshot=takeSnapshot;
+    }
+
+    /************************************************************************/
+    bool replay(const function<void(const Entry&)> &apply)
+    {
+        bool found=false;
+        uint64_t snapshotGeneration=0;
+        size_t nItems=0,nEntries=0;
+
+        mapFile(snapshotFileName,[&](const char *data, size_t len)
+        {
+            Header header;
+            if (!checkHeader(data,len,"OPCS",header))
+            {
+                yWarning("unrecognized snapshot %s!",snapshotFileName.c_str());
+                return;
+            }
+
+            found=true;
+            snapshotGeneration=header.generation;
+
+            Entry entry;
+            const char *ptr=data+sizeof(Header),*end=data+len;
+            for (; decode(ptr,end,entry); nItems++)
+                apply(entry);
+
+            if (ptr!=end)
+                yWarning("snapshot %s is corrupted!",snapshotFileName.c_str());
+        });
+
+        // the journal is meaningful only on top of the snapshot
+        // it was started from
+        mapFile(journalFileName,[&](const char *data, size_t len)
+        {
+            Header header;
+            if (!checkHeader(data,len,"OPCJ",header) || (header.generation!=snapshotGeneration))
+            {
+                yWarning("journal %s does not match the snapshot, skipped",journalFileName.c_str());
+                return;
+            }
+
+            found=true;
+
+            Entry entry;
+            const char *ptr=data+sizeof(Header),*end=data+len;
+            for (; decode(ptr,end,entry); nEntries++)
+                apply(entry);
+
+            if (ptr!=end)
+                yWarning("discarded the incomplete tail of journal %s",journalFileName.c_str());
+        });
+
+        generation=snapshotGeneration;
+        if (found)
+            yInfo("replayed %d items and %d journal entries",(int)nItems,(int)nEntries);
+
+        return found;
+    }
+
+    /************************************************************************/
+    bool compact()
+    {
+        Snapshot snapshot;
+        takeSnapshot(snapshot);
+
+        Header header;
+        fillHeader(header,"OPCS",generation+1);
+        string buf((const char*)&header,sizeof(header));
+        for (Snapshot::iterator it=snapshot.begin(); it!=snapshot.end(); it++)
+        {
+            Entry entry;
+            entry.op='a';
+            entry.id=it->first;
+            entry.prop=it->second;
+            encode(entry,buf);
+        }
+
+        string tmpFileName=snapshotFileName+".tmp";
+        FILE *fsnap=fopen(tmpFileName.c_str(),"wb");
+        if (fsnap==NULL)
+        {
+            yError("unable to write the snapshot %s!",tmpFileName.c_str());
+            return false;
+        }
+
+        bool ok=(fwrite(buf.data(),1,buf.size(),fsnap)==buf.size());
+        sync(fsnap);
+        fclose(fsnap);
+
+    #ifdef _WIN32
+        ::remove(snapshotFileName.c_str());
+    #endif
+        if (!ok || (rename(tmpFileName.c_str(),snapshotFileName.c_str())!=0))
+        {
+            yError("unable to write the snapshot %s!",snapshotFileName.c_str());
+            return false;
+        }
+
+        // from now on the old journal no longer matches the snapshot
+        generation++;
+        if (fout!=NULL)
+            fclose(fout);
+
+        fout=fopen(journalFileName.c_str(),"wb");
+        if (fout==NULL)
+        {
+            yError("unable to open the journal %s!",journalFileName.c_str());
+            return false;
+        }
+
+        fillHeader(header,"OPCJ",generation);
+        fwrite(&header,sizeof(header),1,fout);
+        sync(fout);
+        size=sizeof(header);
+
+        return true;
+    }
+
+    /************************************************************************/
+    void start()
+    {
+        closing=false;
+        writer=thread(&Journal::run,this);
+    }
+
+    /************************************************************************/
+    void append(const Entry &entry)
+    {
+        lock_guard<mutex> lck(mtx);
+        pending.push_back(entry);
+        cv.notify_one();
+    }
+
+    /************************************************************************/
+    void cut()
+    {
+        // called while the snapshot is being taken: the pending
+        // entries are already accounted for by the snapshot
+        lock_guard<mutex> lck(mtx);
+        pending.clear();
+    }
+
+    /************************************************************************/
+    void requestCompaction()
+    {
+        lock_guard<mutex> lck(mtx);
+        compactRequested=true;
+        cv.notify_one();
+    }
+
+    /************************************************************************/
+    void close()
+    {
+        if (writer.joinable())
+        {
+            mtx.lock();
+            closing=true;
+            cv.notify_one();
+            mtx.unlock();
+            writer.join();
+        }
+
+        commit(pending);
+        pending.clear();
+        compact();
+
+        if (fout!=NULL)
+        {
+            fclose(fout);
+            fout=NULL;
+        }
+    }
+};
+
+
 /************************************************************************/
 class DataBase : public PeriodicThread
 {
@@ -402,15 +887,28 @@ protected:
     /************************************************************************/
     struct Item
     {
-        Property *prop;
-        double    lastUpdate;
-        string    owner;
+        shared_ptr<Property> prop;  // shared with snapshots, copied on write
+        double lastUpdate;
+        string owner;
 
-        Item() : prop(NULL),
-                 lastUpdate(OPT_DISABLED),
+        Item() : lastUpdate(OPT_DISABLED),
                  owner(OPT_OWNERSHIP_ALL) { }
     };
 
+    /************************************************************************/
+    struct Delta
+    {
+        int seq;
+        string op;
+        int id;
+        shared_ptr<Property> prop;  // content of added items
+        Bottle content;             // properties involved in set/del
+
+        Delta() : seq(0), id(-1) { }
+    };
+
+    typedef Journal::Snapshot Snapshot;
+
     /************************************************************************/
     struct Condition
     {
@@ -419,33 +917,455 @@ protected:
         Value val;
     };
 
+    /************************************************************************/
+    struct Index
+    {
+        unordered_map<string,std::set<int>> hash;   // equality, keyed by type and value
+        multimap<double,int> ints;                  // ranges over int32 values
+        multimap<double,int> floats;                // ranges over float64 values
+        std::set<int> ids;                          // items owning the property
+    };
+
+    /************************************************************************/
+    struct Lookup
+    {
+        const std::set<int> *pSet;
+        multimap<double,int>::const_iterator first;
+        multimap<double,int>::const_iterator last;
+        size_t size;
+
+        Lookup() : pSet(NULL), first(), last(), size(0) { }
+    };
+
     ResourceFinder *rf;
     map<int,Item> itemsMap;
+    map<string,Index> indexes;
     mutex mtx;
     int  idCnt;
     bool initialized;
     bool nosavedb;
     bool quitting;
 
+    Journal journal;
+    bool journaling;
+
     BufferedPort<Bottle> *pBroadcastPort;
+    mutex bcMtx;
     bool asyncBroadcast;
+    bool deltaBroadcast;
+
+    deque<Delta> deltas;
+    int seq;
 
     /************************************************************************/
     void clear()
     {
-        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
-            delete it->second.prop;
-
         itemsMap.clear();
+
+        // keep the indexed properties, drop their content
+        for (map<string,Index>::iterator idx=indexes.begin(); idx!=indexes.end(); idx++)
+            idx->second=Index();
     }
 
     /************************************************************************/
     void eraseItem(map<int,Item>::iterator &it)
     {
-        delete it->second.prop;
+        indexItem(it->first,it->second.prop.get(),false);
         itemsMap.erase(it);
     }
 
+    /************************************************************************/
+    static string hashKey(const Value &val)
+    {
+        // the key carries the type, since relational operators
+        // never compare values of different types
+        ostringstream key;
+        if (val.isFloat64())
+        {
+            double d=val.asFloat64();
+            key<<'d'<<setprecision(17)<<(d==0.0?0.0:d);
+        }
+        else if (val.isInt32())
+            key<<'i'<<val.asInt32();
+        else if (val.isString())
+            key<<'s'<<val.asString();
+        else
+            key<<val.getCode()<<':'<<val.toString();
+
+        return key.str();
+    }
+
+    /************************************************************************/
+    void indexValue(Index &index, const int id, const Value &val, const bool insert)
+    {
+        multimap<double,int> *range=NULL;
+        double key=0.0;
+        if (val.isFloat64())
+        {
+            range=&index.floats;
+            key=val.asFloat64();
+        }
+        else if (val.isInt32())
+        {
+            range=&index.ints;
+            key=val.asInt32();
+        }
+
+        if (insert)
+        {
+            index.hash[hashKey(val)].insert(id);
+            index.ids.insert(id);
+            if (range!=NULL)
+                range->insert(make_pair(key,id));
+        }
+        else
+        {
+            unordered_map<string,std::set<int>>::iterator bucket=index.hash.find(hashKey(val));
+            if (bucket!=index.hash.end())
+            {
+                bucket->second.erase(id);
+                if (bucket->second.empty())
+                    index.hash.erase(bucket);
+            }
+
+            index.ids.erase(id);
+            if (range!=NULL)
+            {
+                pair<multimap<double,int>::iterator,multimap<double,int>::iterator> r=range->equal_range(key);
+                for (multimap<double,int>::iterator it=r.first; it!=r.second; it++)
+                {
+                    if (it->second==id)
+                    {
+                        range->erase(it);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    /************************************************************************/
+    void indexItem(const int id, Property *pProp, const bool insert)
+    {
+        for (map<string,Index>::iterator idx=indexes.begin(); idx!=indexes.end(); idx++)
+            if (pProp->check(idx->first))
+                indexValue(idx->second,id,pProp->find(idx->first),insert);
+    }
+
+    /************************************************************************/
+    Property *mutableProp(Item &item)
+    {
+        // leave untouched the content still referenced by snapshots
+        if (item.prop.use_count()>1)
+            item.prop=make_shared<Property>(*item.prop);
+
+        return item.prop.get();
+    }
+
+    /************************************************************************/
+    void putProperty(const int id, Item &item, const string &prop, const Value &val)
+    {
+        Property *pProp=mutableProp(item);
+        map<string,Index>::iterator idx=indexes.find(prop);
+        if (idx!=indexes.end())
+        {
+            if (pProp->check(prop))
+                indexValue(idx->second,id,pProp->find(prop),false);
+            indexValue(idx->second,id,val,true);
+        }
+
+        pProp->unput(prop);
+        pProp->put(prop,val);
+    }
+
+    /************************************************************************/
+    void unputProperty(const int id, Item &item, const string &prop)
+    {
+        Property *pProp=mutableProp(item);
+        map<string,Index>::iterator idx=indexes.find(prop);
+        if ((idx!=indexes.end()) && pProp->check(prop))
+            indexValue(idx->second,id,pProp->find(prop),false);
+
+        pProp->unput(prop);
+    }
+
+    /************************************************************************/
+    void pushDelta(const string &op, const int id=-1,
+                   const shared_ptr<Property> &prop=shared_ptr<Property>(),
+                   const Bottle &content=Bottle())
+    {
+        // the sequence number accounts for every change, even when
+        // deltas are not streamed, so that consumers can spot gaps
+        seq++;
+        if (asyncBroadcast && deltaBroadcast)
+        {
+            deltas.push_back(Delta());
+            Delta &delta=deltas.back();
+            delta.seq=seq;
+            delta.op=op;
+            delta.id=id;
+            delta.prop=prop;
+            delta.content=content;
+        }
+
+        if (journaling)
+        {
+            Journal::Entry entry;
+            entry.op=op[0];
+            entry.id=id;
+            entry.prop=prop;
+            entry.content=content;
+
+            // a replaced content is journaled as a whole
+            if (op=="reset")
+            {
+                entry.op='c';
+                journal.append(entry);
+
+                entry.op='a';
+                for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+                {
+                    entry.id=it->first;
+                    entry.prop=it->second.prop;
+                    journal.append(entry);
+                }
+            }
+            else
+                journal.append(entry);
+        }
+    }
+
+    /************************************************************************/
+    void applyEntry(const Journal::Entry &entry)
+    {
+        map<int,Item>::iterator it=itemsMap.find(entry.id);
+        if (entry.op=='a')
+        {
+            if (it!=itemsMap.end())
+                eraseItem(it);
+
+            itemsMap[entry.id].prop=entry.prop;
+            indexItem(entry.id,entry.prop.get(),true);
+
+            if (idCnt<=entry.id)
+                idCnt=entry.id+1;
+        }
+        else if (entry.op=='s')
+        {
+            if (it!=itemsMap.end())
+                for (int i=0; i<entry.content.size(); i++)
+                    if (Bottle *option=entry.content.get(i).asList())
+                        putProperty(entry.id,it->second,option->get(0).asString(),option->get(1));
+        }
+        else if (entry.op=='d')
+        {
+            if (it!=itemsMap.end())
+            {
+                if (entry.content.size()>0)
+                {
+                    for (int i=0; i<entry.content.size(); i++)
+                        unputProperty(entry.id,it->second,entry.content.get(i).asString());
+                }
+                else
+                    eraseItem(it);
+            }
+        }
+        else if (entry.op=='c')
+            clear();
+    }
+
+    /************************************************************************/
+    bool loadJournal()
+    {
+        lock_guard<mutex> lck(mtx);
+        clear();
+        idCnt=0;
+
+        return journal.replay([this](const Journal::Entry &entry) { applyEntry(entry); });
+    }
+
+    /************************************************************************/
+    int takeSnapshot(Snapshot &snapshot)
+    {
+        lock_guard<mutex> lck(mtx);
+        snapshot.reserve(itemsMap.size());
+        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+            snapshot.push_back(make_pair(it->first,it->second.prop));
+
+        return seq;
+    }
+
+    /************************************************************************/
+    void serialize(const Snapshot &snapshot, Bottle &bottle)
+    {
+        for (Snapshot::const_iterator it=snapshot.begin(); it!=snapshot.end(); it++)
+        {
+            Bottle &item=bottle.addList();
+            item.read(*it->second);
+
+            Bottle &idList=item.addList();
+            idList.addString(PROP_ID);
+            idList.addInt32(it->first);
+        }
+    }
+
+    /************************************************************************/
+    void broadcastDeltas()
+    {
+        lock_guard<mutex> bcLck(bcMtx);
+        deque<Delta> pending;
+        mtx.lock();
+        pending.swap(deltas);
+        mtx.unlock();
+
+        if (pending.empty() || (pBroadcastPort==NULL))
+            return;
+
+        if (pBroadcastPort->getOutputCount()>0)
+        {
+            Bottle &bottle=pBroadcastPort->prepare();
+            bottle.clear();
+
+            bottle.addString(BCTAG_DELTA);
+            for (deque<Delta>::iterator it=pending.begin(); it!=pending.end(); it++)
+            {
+                Bottle &entry=bottle.addList();
+                entry.addInt32(it->seq);
+                entry.addString(it->op);
+                if (it->id>=0)
+                    entry.addInt32(it->id);
+
+                if (it->prop)
+                    entry.addList().read(*it->prop);
+                else if (it->content.size()>0)
+                    entry.addList()=it->content;
+            }
+
+            pBroadcastPort->writeStrict();
+        }
+    }
+
+    /************************************************************************/
+    void notifyChange()
+    {
+        if (asyncBroadcast)
+        {
+            if (deltaBroadcast)
+                broadcastDeltas();
+            else
+                broadcast(BCTAG_ASYNC);
+        }
+    }
+
+    /************************************************************************/
+    bool lookup(Condition &cond, Lookup &res)
+    {
+        map<string,Index>::const_iterator idx=indexes.find(cond.prop);
+        if (idx==indexes.end())
+            return false;
+
+        const Index &index=idx->second;
+        if (cond.compare==&relationalOperators::alwaysTrue)
+        {
+            res.pSet=&index.ids;
+            res.size=index.ids.size();
+            return true;
+        }
+        else if (cond.compare==&relationalOperators::equal)
+        {
+            unordered_map<string,std::set<int>>::const_iterator bucket=index.hash.find(hashKey(cond.val));
+            if (bucket!=index.hash.end())
+            {
+                res.pSet=&bucket->second;
+                res.size=bucket->second.size();
+            }
+            return true;
+        }
+        else if (cond.compare==&relationalOperators::notEqual)
+            return false;
+
+        // range comparisons hold only between values of the same type
+        const multimap<double,int> *range;
+        double key;
+        if (cond.val.isFloat64())
+        {
+            range=&index.floats;
+            key=cond.val.asFloat64();
+        }
+        else if (cond.val.isInt32())
+        {
+            range=&index.ints;
+            key=cond.val.asInt32();
+        }
+        else
+            return true;
+
+        if (cond.compare==&relationalOperators::greater)
+        {
+            res.first=range->upper_bound(key);
+            res.last=range->end();
+        }
+        else if (cond.compare==&relationalOperators::greaterEqual)
+        {
+            res.first=range->lower_bound(key);
+            res.last=range->end();
+        }
+        else if (cond.compare==&relationalOperators::lower)
+        {
+            res.first=range->begin();
+            res.last=range->lower_bound(key);
+        }
+        else
+        {
+            res.first=range->begin();
+            res.last=range->upper_bound(key);
+        }
+
+        res.size=distance(res.first,res.last);
+        return true;
+    }
+
+    /************************************************************************/
+    bool collectCandidates(deque<Condition> &condList, deque<string> &opList,
+                           std::set<int> &candidates)
+    {
+        // each "&&" group contributes with the items selected by its
+        // most selective indexed condition; a group without indexed
+        // conditions requires the linear scan
+        unsigned int i=0;
+        while (i<condList.size())
+        {
+            Lookup best;
+            bool found=false;
+            for (; i<condList.size(); i++)
+            {
+                Lookup res;
+                if (lookup(condList[i],res))
+                {
+                    if (!found || (res.size<best.size))
+                        best=res;
+                    found=true;
+                }
+
+                if ((i<opList.size()) && (opList[i]=="||"))
+                {
+                    i++;
+                    break;
+                }
+            }
+
+            if (!found)
+                return false;
+
+            if (best.pSet!=NULL)
+                candidates.insert(best.pSet->begin(),best.pSet->end());
+            else for (multimap<double,int>::const_iterator it=best.first; it!=best.last; it++)
+                candidates.insert(it->second);
+        }
+
+        return true;
+    }
+
     /************************************************************************/
     void write(FILE *stream)
     {
@@ -515,9 +1435,12 @@ public:
     {
         pBroadcastPort=NULL;
         asyncBroadcast=false;
+        deltaBroadcast=false;
+        seq=0;
         initialized=false;
         nosavedb=false;
         quitting=false;
+        journaling=false;
         idCnt=0;
     }
 
@@ -527,7 +1450,11 @@ public:
         if (isRunning())
             stop();
 
-        save();
+        if (journaling)
+            journal.close();
+        else
+            save();
+
         clear();
     }
 
@@ -541,9 +1468,55 @@ public:
             return;
         }
 
+        if (rf.check("index"))
+        {
+            Bottle props;
+            Value &index=rf.find("index");
+            if (Bottle *b=index.asList())
+                props=*b;
+            else
+                props.add(index);
+
+            for (int i=0; i<props.size(); i++)
+            {
+                string prop=props.get(i).asString();
+                if (prop.empty() || (prop==PROP_ID))
+                    continue;
+
+                indexes[prop];
+                yInfo("indexing property \"%s\"",prop.c_str());
+            }
+        }
+
         nosavedb=rf.check("no-save-db");
+        journaling=rf.check("journal") && !nosavedb;
+        if (journaling)
+        {
+            string baseName=rf.getHomeContextPath()+"/"+rf.find("db").asString();
+            journal.configure(baseName,rf.check("journal-period",Value(0.05)).asFloat64(),
+                              (size_t)(1e6*rf.check("journal-max-size",Value(4.0)).asFloat64()),
+                              [this](Snapshot &snapshot)
+                              {
+                                  lock_guard<mutex> lck(mtx);
+                                  for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+                                      snapshot.push_back(make_pair(it->first,it->second.prop));
+
+                                  journal.cut();
+                              });
+        }
+
         if (!rf.check("no-load-db"))
-            load();
+        {
+            // the ini database is the starting point when no journal is there yet
+            if (!journaling || !loadJournal())
+                load();
+        }
+
+        if (journaling)
+        {
+            journal.compact();
+            journal.start();
+        }
 
         dump();
         initialized=true;
@@ -555,7 +1528,8 @@ public:
             start();
         }
 
-        asyncBroadcast=rf.check("async-bc");
+        deltaBroadcast=rf.check("delta-bc");
+        asyncBroadcast=rf.check("async-bc") || deltaBroadcast;
     }
 
     /************************************************************************/
@@ -614,7 +1588,8 @@ public:
             }
 
             int id=b2->get(1).asInt32();
-            itemsMap[id].prop=new Property(b3->toString().c_str());
+            itemsMap[id].prop=make_shared<Property>(b3->toString().c_str());
+            indexItem(id,itemsMap[id].prop.get(),true);
 
             if (idCnt<=id)
                 idCnt=id+1;
@@ -629,6 +1604,12 @@ public:
         if (nosavedb)
             return;
 
+        if (journaling)
+        {
+            journal.requestCompaction();
+            return;
+        }
+
         lock_guard<mutex> lck(mtx);
         string dbFileName=rf->getHomeContextPath();
         dbFileName+="/";
@@ -659,30 +1640,38 @@ public:
     {
         if (pBroadcastPort!=NULL)
         {
+            lock_guard<mutex> bcLck(bcMtx);
             if (pBroadcastPort->getOutputCount()>0)
             {
-                lock_guard<mutex> lck(mtx);
+                // serialize out of the database lock
+                Snapshot snapshot;
+                takeSnapshot(snapshot);
+
                 Bottle &bottle=pBroadcastPort->prepare();
                 bottle.clear();
 
                 bottle.addString(type);
-                if (itemsMap.empty())
+                if (snapshot.empty())
                     bottle.addString(BCTAG_EMPTY);
-                else for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
-                {
-                    Bottle &item=bottle.addList();
-                    item.read(*it->second.prop);
-
-                    Bottle &idList=item.addList();
-                    idList.addString(PROP_ID);
-                    idList.addInt32(it->first);
-                }
+                else
+                    serialize(snapshot,bottle);
 
                 pBroadcastPort->writeStrict();
             }
         }
     }
 
+    /************************************************************************/
+    int snapshot(Bottle &response)
+    {
+        Snapshot snapshot;
+        int seq=takeSnapshot(snapshot);
+
+        response.clear();
+        serialize(snapshot,response);
+        return seq;
+    }
+
     /************************************************************************/
     bool add(Bottle *content)
     {
@@ -696,8 +1685,10 @@ public:
         }
 
         lock_guard<mutex> lck(mtx);
-        itemsMap[idCnt].prop=new Property(content->toString().c_str());
+        itemsMap[idCnt].prop=make_shared<Property>(content->toString().c_str());
         itemsMap[idCnt].lastUpdate=Time::now();
+        indexItem(idCnt,itemsMap[idCnt].prop.get(),true);
+        pushDelta("add",idCnt,itemsMap[idCnt].prop);
 
         return true;
     }
@@ -716,6 +1707,7 @@ public:
                 {
                     lock_guard<mutex> lck(mtx);
                     clear();
+                    pushDelta("clear");
                     yInfo("database cleared");
                     return true;
                 }
@@ -738,12 +1730,16 @@ public:
             if (propSet!=NULL)
             {
                 for (int i=0; i<propSet->size(); i++)
-                    it->second.prop->unput(propSet->get(i).asString());
+                    unputProperty(id,it->second,propSet->get(i).asString());
 
                 it->second.lastUpdate=Time::now();
+                pushDelta("del",id,shared_ptr<Property>(),*propSet);
             }
             else
+            {
                 eraseItem(it);
+                pushDelta("del",id);
+            }
 
             return true;
         }
@@ -769,7 +1765,7 @@ public:
         map<int,Item>::iterator it=itemsMap.find(id);
         if (it!=itemsMap.end())
         {
-            Property *pProp=it->second.prop;
+            Property *pProp=it->second.prop.get();
             response.clear();
 
             Bottle *propSet=content->find(PROP_SET).asList();
@@ -815,7 +1811,7 @@ public:
             string owner=it->second.owner;
             if ((owner==OPT_OWNERSHIP_ALL) || (owner==agent))
             {
-                Property *pProp=it->second.prop;
+                Bottle changes;
                 for (int i=0; i<content->size(); i++)
                 {
                     if (Bottle *option=content->get(i).asList())
@@ -829,14 +1825,15 @@ public:
                         if (prop==PROP_ID)
                             continue;
 
-                        pProp->unput(prop);
-                        pProp->put(prop,val);
+                        putProperty(id,it->second,prop,val);
+                        changes.addList()=*option;
                     }
                     else
                         continue;
                 }
 
                 it->second.lastUpdate=Time::now();
+                pushDelta("set",id,shared_ptr<Property>(),changes);
                 return true;
             }
         }
@@ -1061,12 +2058,28 @@ public:
 
         response.clear();
 
+        // visit only the candidates provided by the indexes, if any;
+        // the whole list of conditions is then checked on each of them
+        std::set<int> candidates;
+        if (!indexes.empty() && collectCandidates(condList,opList,candidates))
+        {
+            for (std::set<int>::iterator id=candidates.begin(); id!=candidates.end(); id++)
+            {
+                map<int,Item>::iterator it=itemsMap.find(*id);
+                if (it!=itemsMap.end())
+                    if (recursiveCheck(it->second.prop.get(),condList,opList))
+                        response.addInt32(it->first);
+            }
+
+            return true;
+        }
+
         // apply the conditions to each item
         for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
         {
             // do recursion and keep only the item that
             // satisfies the whole list of conditions
-            if (recursiveCheck(it->second.prop,condList,opList))
+            if (recursiveCheck(it->second.prop.get(),condList,opList))
                 response.addInt32(it->first);
         }
 
@@ -1080,27 +2093,25 @@ public:
         bool erased=false;
         for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
         {
-            Property *pProp=it->second.prop;
+            Property *pProp=it->second.prop.get();
             if (pProp->check(PROP_LIFETIMER))
             {
                 double lifeTimer=pProp->find(PROP_LIFETIMER).asFloat64()-dt;
                 if (lifeTimer<=0.0)
                 {
+                    pushDelta("del",it->first);
                     eraseItem(it);
                     erased=true;
                     break;
                 }
                 else
-                {
-                    pProp->unput(PROP_LIFETIMER);
-                    pProp->put(PROP_LIFETIMER,lifeTimer);
-                }
+                    putProperty(it->first,it->second,PROP_LIFETIMER,Value(lifeTimer));
             }
         }
         mtx.unlock();
 
-        if (asyncBroadcast && erased)
-            broadcast(BCTAG_ASYNC);
+        if (erased)
+            notifyChange();
     }
 
     /************************************************************************/
@@ -1141,8 +2152,7 @@ public:
                     b.addInt32(idCnt);
                     idCnt++;
 
-                    if (asyncBroadcast)
-                        broadcast(BCTAG_ASYNC);
+                    notifyChange();
                 }
                 else
                     reply.addVocab32(REP_NACK);
@@ -1163,8 +2173,7 @@ public:
                 if (remove(content))
                 {
                     reply.addVocab32(REP_ACK);
-                    if (asyncBroadcast)
-                        broadcast(BCTAG_ASYNC);
+                    notifyChange();
                 }
                 else
                     reply.addVocab32(REP_NACK);
@@ -1207,8 +2216,7 @@ public:
                 if (set(content,agent))
                 {
                     reply.addVocab32(REP_ACK);
-                    if (asyncBroadcast)
-                        broadcast(BCTAG_ASYNC);
+                    notifyChange();
                 }
                 else
                     reply.addVocab32(REP_NACK);
@@ -1349,14 +2357,20 @@ public:
                 }
 
                 int opt=command.get(1).asVocab32();
-                if (opt==Vocab32::encode("on"))
+                if ((opt==Vocab32::encode("on")) || (opt==Vocab32::encode("delta")))
                 {
+                    lock_guard<mutex> lck(mtx);
                     asyncBroadcast=true;
+                    deltaBroadcast=(opt==Vocab32::encode("delta"));
+                    if (!deltaBroadcast)
+                        deltas.clear();
                     reply.addVocab32(REP_ACK);
                 }
                 else if (opt==Vocab32::encode("off"))
                 {
+                    lock_guard<mutex> lck(mtx);
                     asyncBroadcast=false;
+                    deltas.clear();
                     reply.addVocab32(REP_ACK);
                 }
                 else
@@ -1389,6 +2403,17 @@ public:
                 break;
             }
 
+            //-----------------
+            case CMD_SNAP:
+            {
+                Bottle response;
+                int seq=snapshot(response);
+                reply.addVocab32(REP_ACK);
+                reply.addInt32(seq);
+                reply.addList()=response;
+                break;
+            }
+
             //-----------------
             case CMD_QUIT:
             case CMD_BYE:
@@ -1434,7 +2459,8 @@ public:
                             if (idList->get(0).asString()==PROP_ID)
                             {
                                 int id=idList->get(1).asInt32();
-                                itemsMap[id].prop=new Property(item->tail().toString().c_str());
+                                itemsMap[id].prop=make_shared<Property>(item->tail().toString().c_str());
+                                indexItem(id,itemsMap[id].prop.get(),true);
 
                                 if (idCnt<=id)
                                     idCnt=id+1;
@@ -1445,11 +2471,10 @@ public:
             }
         }
 
+        pushDelta("reset");
         mtx.unlock();
 
-        if (asyncBroadcast)
-            broadcast(BCTAG_ASYNC);
-
+        notifyChange();
         return true;
     }
 };
@@ -1644,7 +2669,12 @@ int main(int argc, char *argv[])
         printf("\t--no-save-db        : prevent from saving the content of database at shutdown\n");
         printf("\t--sync-bc        <T>: broadcast the database content each T seconds\n");
         printf("\t--async-bc          : broadcast the database content whenever a change occurs\n");
+        printf("\t--delta-bc          : broadcast only the changes whenever they occur\n");
         printf("\t--stats             : enable statistics printouts\n");
+        printf("\t--journal           : persist the database through an append-only journal\n");
+        printf("\t--journal-period <T>: time window to group the changes committed to the journal (default: 0.05)\n");
+        printf("\t--journal-max-size <S>: size in MB triggering the journal compaction (default: 4)\n");
+        printf("\t--index   \"(p0 ...)\": properties to be indexed for faster queries\n");
         printf("\n");
         return 0;
     }
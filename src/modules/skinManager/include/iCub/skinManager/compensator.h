@@ -20,6 +20,7 @@
 #define __COMP_H__
 
 #include <mutex>
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -27,6 +28,7 @@
 #include <list>
 #include <fstream>
 #include <deque>
+#include <unordered_map>
 
 #include <yarp/sig/Vector.h>
 #include <yarp/os/BufferedPort.h>
@@ -61,6 +63,8 @@ private:
     static const int MIN_TOUCH_THR = 1;         // min value assigned to the touch thresholds (i.e. the 95% percentile)
     static const double BIN_TOUCH;              // output value of the binarization filter when touch is detected
     static const double BIN_NO_TOUCH;           // output value of the binarization filter when no touch is detected
+    static const double MIN_GRID_CELL_SIZE;     // min side of the cells of the grid used to look for neighbors (in meters)
+    static const int NEIGHBORS_SLACK = 4;       // spare entries in each CSR row, so that moving a taxel rarely needs a full rebuild
     
     // INIT
     unsigned int skinDim;                       // number of taxels (for the hand it is 192)
@@ -71,17 +75,34 @@ private:
     unsigned int linkNum;                       // number of the link
 
     // SKIN CONTACTS
-    vector< list<int> >     neighborsXtaxel;    // list of neighbors for each taxel    
+    vector<int>             neighborsStart;     // CSR adjacency: the neighbors of taxel i are neighborsIdx[neighborsStart[i]..neighborsStart[i]+neighborsCount[i]-1]
+    vector<int>             neighborsCount;     // CSR adjacency: number of neighbors of each taxel (row i can hold up to neighborsStart[i+1]-neighborsStart[i])
+    vector<int>             neighborsIdx;       // CSR adjacency: sorted neighbor ids of all the taxels, stored contiguously
+    double                  gridCellSize;       // side of the cells of the uniform grid used to look for neighbors (>= maxNeighDist)
+    unordered_map<long long, vector<int> > taxelsXcell; // taxels inside each (non empty) cell of the grid
+    vector<long long>       cellXtaxel;         // grid cell of each taxel
     vector<Vector>          taxelPos;           // taxel positions {xPos, yPos, zPos}
     vector<Vector>          taxelOri;           // taxel normals {xOri, yOri, zOri}
     Vector                  taxelPoseConfidence;// taxels pose estimation confidence
     double                  maxNeighDist;       // max distance between two neighbor taxels
     mutex                   poseSem;            // mutex to access taxel poses
 
+    // CONTACT CLUSTERING (buffers reused at every call of getContacts)
+    struct ContactAccumulator{
+        double CoP[3], geoCenter[3], normal[3];     // weighted sums, normalized at the end
+        double pressure, pressureCoP, pressureNormal;
+        int activeTaxelsGeo;                        // number of taxels whose position is known
+        vector<unsigned int> taxels;                // taxels belonging to the contact
+    };
+    vector<int>                 taxelRoot;          // union-find parent of each active taxel (-1 if the taxel is not active)
+    vector<int>                 contactXroot;       // contact of each union-find root
+    vector<unsigned int>        activeTaxelIds;     // active taxels of the current frame, in increasing order
+    vector<ContactAccumulator>  contactAccs;        // accumulators of the contacts of the current frame
+
     // COMPENSATION
-    vector<bool> touchDetected;                 // true if touch has been detected in the last read of the taxel
-    vector<bool> touchDetectedFilt;             // true if touch has been detected after applying the filtering
-    vector<bool> subTouchDetected;              // true if the taxel value has gone under the baseline (because of touch in neighbouring taxels)
+    vector<unsigned char> touchDetected;        // 1 if touch has been detected in the last read of the taxel
+    vector<unsigned char> touchDetectedFilt;    // 1 if touch has been detected after applying the filtering
+    vector<unsigned char> subTouchDetected;     // 1 if the taxel value has gone under the baseline (because of touch in neighbouring taxels)
     Vector rawData;                             // data read from the skin
     Vector touchThresholds;                     // thresholds for discriminating between "touch" and "no touch"
     mutex touchThresholdSem;                    // semaphore for controlling the access to the touchThreshold
@@ -114,8 +135,7 @@ private:
     float minBaseline;                  // min baseline value regarded as "safe"
     bool binarization;                  // if true binarize the compensated output value (0: no touch, 255: touch)
     bool smoothFilter;                  // if true the smooth filter is on, otherwise it is off
-    float smoothFactor;                 // intensity of the smooth filter action
-    mutex smoothFactorSem;
+    atomic<float> smoothFactor;         // intensity of the smooth filter action
 
     /* ports */
     BufferedPort<Vector> compensatedTactileDataPort;    // output port
@@ -130,6 +150,9 @@ private:
     void sendInfoMsg(string msg);
     void computeNeighbors();
     void updateNeighbors(unsigned int taxelId);
+    long long gridCell(const Vector &pos) const;
+    void findNeighbors(unsigned int taxelId, vector<int> &neighbors) const;
+    int findRoot(int taxelId);
 
     /* class methods */
 public:
@@ -141,8 +164,8 @@ public:
     void calibrationInit();
     void calibrationDataCollection();
     void calibrationFinish();
+    // single pass over the taxels: compensation, touch detection, smoothing, binarization and baseline update
     bool readRawAndWriteCompensatedData();
-    void updateBaseline();
     bool doesBaselineExceed(unsigned int &taxelIndex, double &baseline, double &initialBaseline);
     skinContactList getContacts();
     bool isWorking(){ return _isWorking; }
@@ -207,13 +207,10 @@ void CompensationThread::run(){
 
     if( state == compensation){
         // It reads the raw data, computes the difference between the read values and the baseline 
-        // and outputs these values
+        // and outputs these values. If the read succeeds, the baseline is updated in the same pass
         FOR_ALL_PORTS(i){
             if(compWorking[i]){
-                if(compensators[i]->readRawAndWriteCompensatedData()){
-                    //If the read succeeded, update the baseline
-                    compensators[i]->updateBaseline();
-                }
+                compensators[i]->readRawAndWriteCompensatedData();
             }
         }
 
@@ -20,6 +20,7 @@
 #include <yarp/math/Rand.h> // TEMP
 #include "math.h"
 #include <algorithm>
+#include <iterator>
 #include "iCub/skinManager/compensator.h"
 
 
@@ -32,6 +33,21 @@ using namespace iCub::skinDynLib;
 
 const double Compensator::BIN_TOUCH     = 100.0;
 const double Compensator::BIN_NO_TOUCH  = 0.0;
+const double Compensator::MIN_GRID_CELL_SIZE = 0.001;
+
+namespace{
+    // cells of the neighbor grid are packed in a single key, using 21 bits for each axis
+    const int       GRID_BITS = 21;
+    const long long GRID_MASK = (1LL<<GRID_BITS)-1;
+
+    inline long long cellCoord(double x, double cellSize){
+        return (long long)floor(x/cellSize);
+    }
+
+    inline long long packCell(long long ix, long long iy, long long iz){
+        return ((ix & GRID_MASK)<<(2*GRID_BITS)) | ((iy & GRID_MASK)<<GRID_BITS) | (iz & GRID_MASK);
+    }
+}
 
 Compensator::Compensator(string _name, string _robotName, string outputPortName, string inputPortName, BufferedPort<Bottle>* _infoPort, 
                          double _compensationGain, double _contactCompensationGain, int addThreshold, float _minBaseline, bool _zeroUpRawData, 
@@ -134,12 +150,8 @@ bool Compensator::init(string name, string robotName, string outputPortName, str
     taxelOri.resize(skinDim, zeros(3));
     taxelPoseConfidence.resize(skinDim,0.0);
     maxNeighDist = MAX_NEIGHBOR_DISTANCE;
-    // by default every taxel is neighbor with all the other taxels
-    list<int> defaultNeighbors(skinDim);
-    int i=0;
-    for(list<int>::iterator it=defaultNeighbors.begin();it!=defaultNeighbors.end();it++, i++) 
-        *it = i;
-    neighborsXtaxel.resize(skinDim, defaultNeighbors);
+    // by default every taxel is neighbor with all the other taxels (all the positions are zero)
+    computeNeighbors();
 
     // test read to check if the skin is broken (all taxel output is 0)
     if(robotName!="icubSim" && readInputData(compensatedData)){
@@ -342,106 +354,79 @@ bool Compensator::readRawAndWriteCompensatedData(){
     Vector& compensatedData2Send = compensatedTactileDataPort.prepare();
     compensatedData2Send.resize(skinDim);   // local variable with data to send
     compensatedData.resize(skinDim);        // global variable with data to store
-    
-    double d;
+
+    // the parameters can be changed by the rpc thread: read them once per frame
+    const bool   smooth         = smoothFilter;
+    const bool   binarize       = binarization;
+    const float  sf             = smoothFactor;
+    const double smoothOld      = sf;
+    const double smoothNew      = 1-sf;
+    const double addThr         = addThreshold;
+    const double gainTouch      = contactCompensationGain*0.02;
+    const double gainNoTouch    = compensationGain*0.02;
+    // raw data are either from zero up or from MAX_SKIN down
+    const double rawSign        = zeroUpRawData ? 1.0 : -1.0;
+    const double rawOffset      = zeroUpRawData ? 0.0 : MAX_SKIN;
+
+    const double *raw           = rawData.data();
+    const double *thr           = touchThresholds.data();
+    double *base                = baselines.data();
+    double *comp                = compensatedData.data();
+    double *old                 = compensatedDataOld.data();
+    double *filt                = compensatedDataFilt.data();
+    double *out                 = compensatedData2Send.data();
+    unsigned char *touch        = touchDetected.data();
+    unsigned char *subTouch     = subTouchDetected.data();
+    unsigned char *touchFilt    = touchDetectedFilt.data();
+    bool negativeBaseline       = false;
+
+    double d, t, gain;
     for(unsigned int i=0; i<skinDim; i++){
         // baseline compensation
-        d =  (double)( zeroUpRawData ? rawData(i)-baselines[i] : MAX_SKIN-rawData(i)-baselines[i] );
-        d =   min<double>( MAX_SKIN, d);
-        compensatedData[i] = d;     // save the data before applying filtering
+        d = min<double>(MAX_SKIN, rawSign*raw[i] + rawOffset - base[i]);
+        comp[i] = d;     // save the data before applying filtering
+
+        // detect touch and subtouch (before applying filtering, so the compensation algorithm is not affected by the filters)
+        t = thr[i] + addThr;
+        touch[i]    = (d > t);
+        subTouch[i] = (d < -t);
+
+        // baseline drift compensation, with the unfiltered data and the baseline used in this frame
+        gain = touch[i] ? gainTouch : gainNoTouch;
+        base[i] += gain*d/thr[i];
+        negativeBaseline |= (base[i]<0);
 
-        // detect touch (before applying filtering, so the compensation algorithm is not affected by the filters)
-        touchDetected[i] = (d > touchThresholds[i] + addThreshold);
-        
-        // detect subtouch
-        subTouchDetected[i] = (d < -touchThresholds[i] - addThreshold);
-        
         // smooth filter
-        if(smoothFilter){
-            lock_guard<mutex> lck(smoothFactorSem);
-            d = (1-smoothFactor)*d + smoothFactor*compensatedDataOld(i);
-            compensatedDataOld(i) = d;    // update old value
+        if(smooth){
+            d = smoothNew*d + smoothOld*old[i];
+            old[i] = d;    // update old value
         }
-        compensatedDataFilt[i] = d;
+        filt[i] = d;
 
         // binarization filter
         // here we don't use the touchDetected array because, if the smooth filter is on,
         // we want to use the filtered values
-        touchDetectedFilt[i] = (d > touchThresholds[i] + addThreshold);
-        if(binarization)
-            d = ( touchDetectedFilt[i] ? BIN_TOUCH : BIN_NO_TOUCH );
+        touchFilt[i] = (d > t);
+        if(binarize)
+            d = ( touchFilt[i] ? BIN_TOUCH : BIN_NO_TOUCH );
         
-        compensatedData2Send[i] = max<double>(0.0, d); // trim only data to send because you need negative values for update baseline
+        out[i] = max<double>(0.0, d); // trim only data to send because you need negative values for update baseline
     }
 
     compensatedTactileDataPort.write();
-    return true;
-}
 
-void Compensator::updateBaseline(){
-    double mean_change = 0, change, gain;
-    unsigned int non_touching_taxels = 0;
-    double d; 
-
-    for(unsigned int j=0; j<skinDim; j++) {
-        // *** Algorithm 1
-        /*if(!touchDetected[j]){
-            if(d > 0.5) {
-                baselines[j]        += compensationGain;
-                mean_change            += compensationGain;                //for changing the taxels where we detected touch
-            }else if(d < -0.5) {
-                baselines[j]        -= compensationGain;
-                mean_change            -= compensationGain;                //for changing the taxels where we detected touch
-            }
-        }*/
-
-        // *** Algorithm 2
-        /*if(!(touchDetected[j] || subTouchDetected[j])){
-            non_touching_taxels++;                                        //for changing the taxels where we detected touch
-            d = compensatedData(j);
-            if(fabs(d)>0.5){
-                change          = (compensationGain/50)*d/touchThresholds[j];
-                baselines[j]    += change;
-                mean_change     += change;
+    if(negativeBaseline){
+        for(unsigned int j=0; j<skinDim; j++){
+            if(baselines[j]<0){
+                gain = touchDetected[j] ? gainTouch : gainNoTouch;
+                char temp[300];
+                snprintf(temp, sizeof(temp), "ERROR-Negative baseline. Port %s; tax %d; baseline %.2f; gain: %.4f; d: %.2f; raw: %.2f; change: %f; touchThr: %.2f", 
+                    SkinPart_s[skinPart].c_str(), j, baselines[j], gain, compensatedData[j], rawData[j], gain*compensatedData[j]/touchThresholds[j], touchThresholds[j]);
+                sendInfoMsg(temp);
             }
-        }*/
-    
-        d = compensatedData(j);
-        if(touchDetected[j]){
-            gain            = contactCompensationGain*0.02;                
-        }else{
-            gain            = compensationGain*0.02;
-            non_touching_taxels++;
         }
-        change          = gain*d/touchThresholds[j];
-        baselines[j]    += change;
-        mean_change     += change;
-
-    //        if(j<5)
-    //        printf("%d touch detected %s, change %.6f, gain: %.3f\n", j, touchDetected[j]?"yes":"no", change, touchDetected[j]?contactCompensationGain:compensationGain);
-
-        if(baselines[j]<0){
-            char* temp = new char[300];
-            sprintf(temp, "ERROR-Negative baseline. Port %s; tax %d; baseline %.2f; gain: %.4f; d: %.2f; raw: %.2f; change: %f; touchThr: %.2f", 
-                SkinPart_s[skinPart].c_str(), j, baselines[j], gain, d, rawData[j], change, touchThresholds[j]);
-            sendInfoMsg(temp);
-        }      
     }
-    
-    //for compensating the taxels where we detected touch
-    /*if (non_touching_taxels>0 && non_touching_taxels<skinDim && mean_change!=0){
-        mean_change /= non_touching_taxels;
-        for(unsigned int j=0; j<skinDim; j++) {
-            if (touchDetected[j]) {
-                baselines[j]        += mean_change;
-                if(baselines[j]<0){
-                    char* temp = new char[300];
-                    sprintf(temp, "ERROR-Negative baseline. Taxel %d; baseline %.2f; meanchange: %f", j, baselines[j], mean_change);
-                    sendInfoMsg(temp);
-                }
-            }
-        }
-    }*/
+    return true;
 }
 
 bool Compensator::doesBaselineExceed(unsigned int &taxelIndex, double &baseline, double &initialBaseline){
@@ -462,94 +447,109 @@ bool Compensator::doesBaselineExceed(unsigned int &taxelIndex, double &baseline,
     return false;
 }
 
+int Compensator::findRoot(int taxelId){
+    // path halving
+    while(taxelRoot[taxelId]!=taxelId){
+        taxelRoot[taxelId] = taxelRoot[taxelRoot[taxelId]];
+        taxelId = taxelRoot[taxelId];
+    }
+    return taxelId;
+}
+
 skinContactList Compensator::getContacts(){    
-    vector<int>         contactXtaxel(skinDim, -1);     // contact for each taxel (-1 means no contact)
-    deque<deque<int> >  taxelsXcontact;                 // taxels for each contact
-    int                 contactId = 0;                  // id of the next contact to create
-    int                 neighCont;                      // id of the contact of the current neighbor
+    taxelRoot.resize(skinDim);
+    contactXroot.resize(skinDim);
+    int contactNum = 0;                                 // number of contacts found
 
     poseSem.lock();
     {
+        // every active taxel starts as a contact on its own
+        activeTaxelIds.clear();
         for(unsigned int i=0; i<skinDim; i++){
-            if(touchDetectedFilt[i] ){ // && contactXtaxel[i]<0 (second condition should always be true)
-                list<int> *neighbors = &(neighborsXtaxel[i]);
-                //printf("Taxel %d active. Going to check its %d neighbors\n", i, neighbors->size());
-                for(list<int>::iterator it=neighbors->begin(); it!=neighbors->end(); it++){
-                    neighCont = contactXtaxel[(*it)];
-                    if(neighCont >= 0){                                     // ** if neighbor belongs to a contact
-                        if(contactXtaxel[i]<0){                             // ** add taxel to pre-existing contact
-                            contactXtaxel[i] = neighCont;
-                            taxelsXcontact[neighCont].push_back(i);
-                            //printf("Add taxel to pre existing contact %d (neighbor %d)\n", neighCont, (*neighbors)[n]);
-                        }else if(contactXtaxel[i]!=neighCont){              // ** merge 2 contacts
-                            //mergeContacts(contactXtaxel[i], neighCont);
-                            int newId = min(contactXtaxel[i], neighCont);
-                            int oldId = max(contactXtaxel[i], neighCont);
-                            deque<int> tax2move = taxelsXcontact[oldId];
-                            for(deque<int>::iterator it=tax2move.begin(); it!=tax2move.end(); it++){
-                                contactXtaxel[(*it)] = newId;               // assign new contact id
-                                taxelsXcontact[newId].push_back((*it));     // add taxel ids to contact
-                            }
-                            taxelsXcontact[oldId].clear();      // clear the list of taxels belonging to the merged contact
-                            //printf("Merge two contacts: %d and %d\n", oldId, newId);
-                        }
-                    }
+            if(touchDetectedFilt[i]){
+                taxelRoot[i] = i;
+                contactXroot[i] = -1;
+                activeTaxelIds.push_back(i);
+            }
+            else
+                taxelRoot[i] = -1;
+        }
 
+        // merge the active neighbors. the root of a set is always its taxel with min id
+        for(size_t a=0; a<activeTaxelIds.size(); a++){
+            int i = activeTaxelIds[a];
+            for(int n=neighborsStart[i]; n<neighborsStart[i]+neighborsCount[i]; n++){
+                int j = neighborsIdx[n];
+                if(j>i || taxelRoot[j]<0)   // the graph is symmetric: check every pair only once
+                    continue;
+                int ri = findRoot(i), rj = findRoot(j);
+                if(ri<rj)
+                    taxelRoot[rj] = ri;
+                else if(rj<ri)
+                    taxelRoot[ri] = rj;
+            }
+        }
+
+        // accumulate the contact data. taxels are visited in increasing order, so the root of
+        // each set is visited first and contacts are ordered by their min taxel id
+        for(size_t a=0; a<activeTaxelIds.size(); a++){
+            unsigned int tax = activeTaxelIds[a];
+            int root = findRoot(tax);
+            if(contactXroot[root]<0){
+                contactXroot[root] = contactNum++;
+                if((int)contactAccs.size()<contactNum)
+                    contactAccs.resize(contactNum);
+                ContactAccumulator &acc = contactAccs[contactXroot[root]];
+                for(int k=0; k<3; k++)
+                    acc.CoP[k] = acc.geoCenter[k] = acc.normal[k] = 0.0;
+                acc.pressure = acc.pressureCoP = acc.pressureNormal = 0.0;
+                acc.activeTaxelsGeo = 0;
+                acc.taxels.clear();
+            }
+            ContactAccumulator &acc = contactAccs[contactXroot[root]];
+            const Vector &pos = taxelPos[tax];
+            const Vector &ori = taxelOri[tax];
+            double out = max(compensatedDataFilt[tax], 0.0);
+            if(pos[0]!=0.0 || pos[1]!=0.0 || pos[2]!=0.0){  // if the taxel position estimate exists
+                for(int k=0; k<3; k++){
+                    acc.CoP[k]          += pos[k]*out;
+                    acc.geoCenter[k]    += pos[k];
                 }
-                if(contactXtaxel[i]<0){            // ** if no neighbor belongs to a contact -> create new contact
-                    contactXtaxel[i] = contactId;
-                    taxelsXcontact.resize(contactId+1);
-                    taxelsXcontact[contactId].push_back(i);
-                    contactId++;
-                    //printf("New contact created: %d\n", contactId-1);
-                }
+                acc.pressureCoP += out;
+                acc.activeTaxelsGeo++;
             }
+            if(ori[0]!=0.0 || ori[1]!=0.0 || ori[2]!=0.0){  // if the taxel orientation estimate exists
+                for(int k=0; k<3; k++)
+                    acc.normal[k]   += ori[k]*out;
+                acc.pressureNormal += out;
+            }
+            acc.pressure += out;
+            acc.taxels.push_back(tax);
         }
     }
     poseSem.unlock();
 
     skinContactList contactList;
+    contactList.reserve(contactNum);
     Vector CoP(3), geoCenter(3), normal(3);
-    double pressure, pressureCoP, pressureNormal, out;
-    int activeTaxels, activeTaxelsGeo;
-    vector<unsigned int> taxelList;
-    for( deque<deque<int> >::iterator it=taxelsXcontact.begin(); it!=taxelsXcontact.end(); it++){
-        activeTaxels = it->size();
-        if(activeTaxels==0) continue;
-        
-        taxelList.resize(activeTaxels);
-        CoP.zero();
-        geoCenter.zero();
-        normal.zero();
-        pressure = pressureCoP = pressureNormal = 0.0;
-        activeTaxelsGeo = 0;
-        int i=0;
-        for( deque<int>::iterator tax=it->begin(); tax!=it->end(); tax++, i++){
-            out         = max(compensatedDataFilt[(*tax)], 0.0);
-            if(norm(taxelPos[(*tax)])!=0.0){  // if the taxel position estimate exists
-                CoP         += taxelPos[(*tax)] * out;
-                pressureCoP += out;
-                activeTaxelsGeo++;
-                geoCenter   += taxelPos[(*tax)];
-            }
-            if(norm(taxelOri[(*tax)])!=0.0){  // if the taxel orientation estimate exists
-                normal          += taxelOri[(*tax)] * out;
-                pressureNormal  += out;
-            }
-            pressure    += out;
-            taxelList[i] = *tax;
-        }
+    double pressure;
+    int activeTaxels;
+    for(int c=0; c<contactNum; c++){
+        const ContactAccumulator &acc = contactAccs[c];
         // if this is not the only contact and no taxel in this contact has a position => discard it
-        if(taxelsXcontact.size()>1 && activeTaxelsGeo==0)
+        if(contactNum>1 && acc.activeTaxelsGeo==0)
             continue;
-        if(pressureCoP!=0.0)        CoP         /= pressureCoP;
-        if(pressureNormal!=0.0)     normal      /= pressureNormal;
-        if(activeTaxelsGeo!=0)      geoCenter   /= activeTaxelsGeo;
-        pressure    /= activeTaxels;
-        skinContact c(bodyPart, skinPart, linkNum, CoP, geoCenter, taxelList, pressure, normal);
+        activeTaxels = acc.taxels.size();
+        for(int k=0; k<3; k++){
+            CoP[k]          = acc.pressureCoP!=0.0      ? acc.CoP[k]/acc.pressureCoP            : acc.CoP[k];
+            normal[k]       = acc.pressureNormal!=0.0   ? acc.normal[k]/acc.pressureNormal      : acc.normal[k];
+            geoCenter[k]    = acc.activeTaxelsGeo!=0    ? acc.geoCenter[k]/acc.activeTaxelsGeo  : acc.geoCenter[k];
+        }
+        pressure = acc.pressure/activeTaxels;
+        skinContact contact(bodyPart, skinPart, linkNum, CoP, geoCenter, acc.taxels, pressure, normal);
         // set an estimate of the force that is with normal direction and intensity equal to the pressure
-        c.setForce(-0.05*activeTaxels*pressure*normal);
-        contactList.push_back(c);
+        contact.setForce(-0.05*activeTaxels*pressure*normal);
+        contactList.push_back(contact);
     }
     //printf("ContactList: %s\n", contactList.toString().c_str());
     
@@ -570,7 +570,6 @@ bool Compensator::setSmoothFactor(float value){
         return false;
     if(value==1.0) 
         value = 0.99f;    // otherwise with 1 the values don't update
-    lock_guard<mutex> lck(smoothFactorSem);
     smoothFactor = value;
     return true;
 }
@@ -616,7 +615,6 @@ Vector Compensator::getTouchThreshold(){
 }
 
 float Compensator::getSmoothFactor(){
-    lock_guard<mutex> lck(smoothFactorSem);
     return smoothFactor;
 }
 Vector Compensator::getTaxelPosition(unsigned int taxelId){
@@ -842,52 +840,125 @@ bool Compensator::setTaxelOrientation(unsigned int taxelId, const Vector &orient
         taxelPoseConfidence[taxelId] = orientation[3];
     return true;
 }
-void Compensator::computeNeighbors(){
-    neighborsXtaxel.clear();
-    neighborsXtaxel.resize(skinDim, list<int>(0));
-    Vector v;
-    double d2 = maxNeighDist*maxNeighDist;
-    for(unsigned int i=0; i<skinDim; i++){
-        for(unsigned int j=i+1; j<skinDim; j++){
-            //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-            v = taxelPos[i]-taxelPos[j];
-            if( dot(v,v) <= d2){
-                neighborsXtaxel[i].push_back(j);
-                neighborsXtaxel[j].push_back(i);
-                //printf("Taxels %d (%s) and %d (%s) are neighbors\n", i, taxelPos[i].toString().c_str(), j, taxelPos[j].toString().c_str());
+long long Compensator::gridCell(const Vector &pos) const{
+    return packCell(cellCoord(pos[0], gridCellSize), cellCoord(pos[1], gridCellSize), cellCoord(pos[2], gridCellSize));
+}
+void Compensator::findNeighbors(unsigned int taxelId, vector<int> &neighbors) const{
+    neighbors.clear();
+    const Vector &p = taxelPos[taxelId];
+    const double d2 = maxNeighDist*maxNeighDist;
+    const long long ix = cellCoord(p[0], gridCellSize);
+    const long long iy = cellCoord(p[1], gridCellSize);
+    const long long iz = cellCoord(p[2], gridCellSize);
+    // the cells are not smaller than maxNeighDist, so the neighbors can only be in the 27 cells around the taxel
+    for(long long dx=-1; dx<=1; dx++){
+        for(long long dy=-1; dy<=1; dy++){
+            for(long long dz=-1; dz<=1; dz++){
+                unordered_map<long long, vector<int> >::const_iterator cell = taxelsXcell.find(packCell(ix+dx, iy+dy, iz+dz));
+                if(cell==taxelsXcell.end())
+                    continue;
+                for(vector<int>::const_iterator it=cell->second.begin(); it!=cell->second.end(); it++){
+                    if((*it)==(int)taxelId)
+                        continue;
+                    const Vector &q = taxelPos[(*it)];
+                    double vx = p[0]-q[0], vy = p[1]-q[1], vz = p[2]-q[2];
+                    if(vx*vx + vy*vy + vz*vz <= d2)
+                        neighbors.push_back(*it);
+                }
             }
-            //}
         }
     }
+    sort(neighbors.begin(), neighbors.end());
+}
+void Compensator::computeNeighbors(){
+    // put the taxels in a uniform grid
+    gridCellSize = max(maxNeighDist, MIN_GRID_CELL_SIZE);
+    taxelsXcell.clear();
+    cellXtaxel.resize(skinDim);
+    for(unsigned int i=0; i<skinDim; i++){
+        cellXtaxel[i] = gridCell(taxelPos[i]);
+        taxelsXcell[cellXtaxel[i]].push_back(i);
+    }
 
+    // fill the CSR adjacency, row by row, leaving some spare room at the end of each row
+    neighborsStart.resize(skinDim+1);
+    neighborsCount.resize(skinDim);
+    neighborsIdx.clear();
+    vector<int> neighbors;
     int minNeighbors=skinDim, maxNeighbors=0, ns;
     for(unsigned int i=0; i<skinDim; i++){
-        //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-        ns = neighborsXtaxel[i].size();
+        neighborsStart[i] = neighborsIdx.size();
+        findNeighbors(i, neighbors);
+        neighborsIdx.insert(neighborsIdx.end(), neighbors.begin(), neighbors.end());
+        neighborsIdx.resize(neighborsIdx.size()+NEIGHBORS_SLACK, -1);
+        ns = neighbors.size();
+        neighborsCount[i] = ns;
         if(ns>maxNeighbors) maxNeighbors = ns;
         if(ns<minNeighbors) minNeighbors = ns;
     }
+    neighborsStart[skinDim] = neighborsIdx.size();
+
     stringstream ss;
     ss<<"Neighbors computed. Min neighbors: "<<minNeighbors<<"; max neighbors: "<<maxNeighbors;
     sendInfoMsg(ss.str());
 }
 void Compensator::updateNeighbors(unsigned int taxelId){
-    Vector v;
-    double d2 = maxNeighDist*maxNeighDist;
-    // remove all the neighbors of the taxel with id=taxelId
-    neighborsXtaxel[taxelId].clear();
+    if(neighborsStart.size()!=skinDim+1 || neighborsCount.size()!=skinDim || cellXtaxel.size()!=skinDim){
+        computeNeighbors();
+        return;
+    }
 
-    for(unsigned int i=0; i<skinDim; i++){
-        //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-        // remove taxelId from the neighbor list (if there is)
-        neighborsXtaxel[i].remove(taxelId);
-        // check whether they are neighbors
-        v = taxelPos[i]-taxelPos[taxelId];
-        if( dot(v,v) <= d2){
-            neighborsXtaxel[i].push_back(taxelId);
-            neighborsXtaxel[taxelId].push_back(i);
+    // move the taxel to its new cell
+    long long newCell = gridCell(taxelPos[taxelId]);
+    if(newCell!=cellXtaxel[taxelId]){
+        vector<int> &oldTaxels = taxelsXcell[cellXtaxel[taxelId]];
+        oldTaxels.erase(find(oldTaxels.begin(), oldTaxels.end(), (int)taxelId));
+        if(oldTaxels.empty())
+            taxelsXcell.erase(cellXtaxel[taxelId]);
+        vector<int> &newTaxels = taxelsXcell[newCell];
+        newTaxels.insert(lower_bound(newTaxels.begin(), newTaxels.end(), (int)taxelId), taxelId);
+        cellXtaxel[taxelId] = newCell;
+    }
+
+    // only the cells around the new position are searched; the old neighbors are read from the CSR row
+    vector<int> newNeighbors, lost, gained;
+    findNeighbors(taxelId, newNeighbors);
+    vector<int>::iterator rowBegin = neighborsIdx.begin()+neighborsStart[taxelId];
+    vector<int>::iterator rowEnd = rowBegin+neighborsCount[taxelId];
+    set_difference(rowBegin, rowEnd, newNeighbors.begin(), newNeighbors.end(), back_inserter(lost));
+    set_difference(newNeighbors.begin(), newNeighbors.end(), rowBegin, rowEnd, back_inserter(gained));
+
+    // the rows are edited in place: rebuild everything only if one of them has no room left
+    if((int)newNeighbors.size() > neighborsStart[taxelId+1]-neighborsStart[taxelId]){
+        computeNeighbors();
+        return;
+    }
+    for(size_t n=0; n<gained.size(); n++){
+        if(neighborsCount[gained[n]] == neighborsStart[gained[n]+1]-neighborsStart[gained[n]]){
+            computeNeighbors();
+            return;
         }
     }
+
+    copy(newNeighbors.begin(), newNeighbors.end(), rowBegin);
+    neighborsCount[taxelId] = newNeighbors.size();
+
+    // the rows of the other taxels only lose or gain taxelId, and stay sorted
+    for(size_t n=0; n<lost.size(); n++){
+        vector<int>::iterator b = neighborsIdx.begin()+neighborsStart[lost[n]];
+        vector<int>::iterator e = b+neighborsCount[lost[n]];
+        vector<int>::iterator pos = lower_bound(b, e, (int)taxelId);
+        copy(pos+1, e, pos);
+        neighborsCount[lost[n]]--;
+    }
+    for(size_t n=0; n<gained.size(); n++){
+        vector<int>::iterator b = neighborsIdx.begin()+neighborsStart[gained[n]];
+        vector<int>::iterator e = b+neighborsCount[gained[n]];
+        vector<int>::iterator pos = lower_bound(b, e, (int)taxelId);
+        copy_backward(pos, e, e+1);
+        *pos = taxelId;
+        neighborsCount[gained[n]]++;
+    }
 }
 
 void Compensator::sendInfoMsg(string msg){
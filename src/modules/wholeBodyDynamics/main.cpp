@@ -69,6 +69,11 @@ https://icub-tech-iit.github.io/documentation/icub_force_control/icub-force-cont
 --no_legs
 - this option disables the dynamics computation for the legs joints
 
+--parallel_limbs \e n
+- The limbs attached to the upper and lower torso are solved with \e n
+  threads. The result does not depend on \e n. If not specified the
+  limbs are solved serially.
+
 \section portsa_sec Ports Accessed
 The port the service is listening to.
 
@@ -112,6 +117,7 @@ This file can be edited at src/wholeBodyDynamics/main.cpp.
 #include <iostream>
 #include <iomanip>
 #include <cstring>
+#include <algorithm>
 
 #include "observerThread.h"
 
@@ -207,6 +213,7 @@ private:
     bool     auto_drift_comp;
     bool     default_ee_cont;       // true: when skin detects no contact, the ext contact is supposed at the end effector
                                     // false: ext contact is supposed at the last location where skin detected a contact
+    int      parallel_limbs;        // number of threads used to solve the limbs of the torso nodes
 
     dataFilter *inertialFilter{};
     BufferedPort<Vector> port_filtered_output;
@@ -254,6 +261,7 @@ public:
         dump_vel_enabled = false;
         auto_drift_comp = false;
         default_ee_cont = false;
+        parallel_limbs = 1;
     }
 
     virtual bool createDriver(PolyDriver *&_dd, Property options)
@@ -541,6 +549,12 @@ public:
             yInfo("Default contact at the end effector\n");
         }
 
+        if (rf.check("parallel_limbs"))
+        {
+            parallel_limbs = std::max(1, rf.find("parallel_limbs").asInt32());
+            yInfo("Solving the limbs with %d threads\n", parallel_limbs);
+        }
+
         //---------------------DEVICES--------------------------//
         if(head_enabled)
         {
@@ -728,6 +742,7 @@ public:
         inv_dyn->w0_dw0_enabled=w0_dw0_enabled;
         inv_dyn->dumpvel_enabled=dump_vel_enabled;
         inv_dyn->default_ee_cont=default_ee_cont;
+        inv_dyn->parallel_limbs=parallel_limbs;
 
         yInfo("ft thread istantiated...\n");
         Time::delay(5.0);
@@ -895,6 +910,7 @@ int main(int argc, char * argv[])
         cout << "\t--dumpvel         dumps joint velocities and accelerations (debug use only)"                                  << endl;
         cout << "\t--experimental_com_vel  enables com velocity computation (experimental)"                                      << endl;
         cout << "\t--auto_drift_comp  enables automatic drift compensation  (experimental, under debug)"                         << endl;
+        cout << "\t--parallel_limbs n  solves the limbs attached to the torso with n threads. default: 1"                         << endl;
         return 0;
     }
 
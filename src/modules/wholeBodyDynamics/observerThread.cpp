@@ -270,6 +270,7 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
     dumpvel_enabled = false;
     auto_drift_comp = false;
     add_legs_once = false;
+    parallel_limbs = 1;
 
     icub      = new iCubWholeBody(icub_type, DYNAMIC, VERBOSE);
     icub_sens = new iCubWholeBody(icub_type, DYNAMIC, VERBOSE);
@@ -466,6 +467,13 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
 
 bool inverseDynamics::threadInit()
 {
+    if (parallel_limbs>1)
+    {
+        yInfo("threadInit: solving the limbs with %d threads\n", parallel_limbs);
+        icub->upperTorso->setParallelLimbs(parallel_limbs);
+        icub->lowerTorso->setParallelLimbs(parallel_limbs);
+    }
+
     yInfo("threadInit: waiting for port connections... \n\n");
     if (!dummy_ft)
     {
@@ -137,6 +137,7 @@ public:
     bool       auto_drift_comp;
     bool       default_ee_cont;
     bool       add_legs_once;
+    int        parallel_limbs;      // number of threads used to solve the limbs attached to the torso nodes
 
 private:
     string      robot_name;
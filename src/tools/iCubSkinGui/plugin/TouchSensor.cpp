@@ -17,3 +17,4 @@ double TouchSensor::dYmax=-VERY_FAR;
 
 int TouchSensor::m_maxRange=0;
 double* TouchSensor::Exponential=0;
+double* TouchSensor::Stamp=0;
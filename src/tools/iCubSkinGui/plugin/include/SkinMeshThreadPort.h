@@ -82,31 +82,10 @@ public:
         }
     }
 
-    void eval(unsigned char *image)
+    bool eval(unsigned char *image,TouchSensor::Rect &dirty)
     {
         std::lock_guard<std::mutex> lck(mtx);
-        for (int t=0; t<MAX_SENSOR_NUM; ++t)
-        {
-            if (sensor[t])
-            {
-                if (mbSimpleDraw)
-                {
-                    sensor[t]->eval_light(image);
-                }
-                else
-                {
-                    sensor[t]->eval(image);
-                }
-            }
-        }
-    }
-
-    void draw(unsigned char *image)
-    {
-        for (int t=0; t<MAX_SENSOR_NUM; ++t)
-        {
-            if (sensor[t]) sensor[t]->draw(image);
-        }
+        return TouchSensor::compose(sensor,MAX_SENSOR_NUM,image,mbSimpleDraw,dirty);
     }
 };
 
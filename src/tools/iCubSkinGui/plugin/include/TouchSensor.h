@@ -12,6 +12,8 @@
 
 #include <stdio.h>
 
+#include <vector>
+
 #ifndef __ALE_TOUCHSENSOR_H__
 #define __ALE_TOUCHSENSOR_H__
 
@@ -19,6 +21,43 @@
 
 class TouchSensor
 {
+public:
+
+    // inclusive bounds in pixels, with y pointing upward as for the taxels
+    struct Rect
+    {
+        int x0,y0,x1,y1;
+
+        Rect() : x0(0),y0(0),x1(-1),y1(-1) {}
+        Rect(int xa,int ya,int xb,int yb) : x0(xa),y0(ya),x1(xb),y1(yb) {}
+
+        bool empty() const
+        {
+            return x1<x0 || y1<y0;
+        }
+
+        bool intersects(const Rect &r) const
+        {
+            return !empty() && !r.empty() && x0<=r.x1 && r.x0<=x1 && y0<=r.y1 && r.y0<=y1;
+        }
+
+        void merge(const Rect &r)
+        {
+            if (r.empty()) return;
+            if (empty()) { *this=r; return; }
+
+            if (r.x0<x0) x0=r.x0;
+            if (r.y0<y0) y0=r.y0;
+            if (r.x1>x1) x1=r.x1;
+            if (r.y1>y1) y1=r.y1;
+        }
+
+        Rect clipped(const Rect &r) const
+        {
+            return Rect(x0>r.x0?x0:r.x0,y0>r.y0?y0:r.y0,x1<r.x1?x1:r.x1,y1<r.y1?y1:r.y1);
+        }
+    };
+
 protected:
 
     bool calibrated_skin;
@@ -28,7 +67,11 @@ protected:
         for (int n = 0; n < MAX_TAXELS; ++n)
         {
             connected[n] = true;
+            drawn_activation[n] = 0.0;
         }
+
+        drawnR=drawnG=drawnB=0;
+        invalidated=true;
     }
 
 public:
@@ -78,18 +121,40 @@ public:
         double sigma=0.5*5.55*scale;
         int maxRange=int(2.5*sigma);
 
-        if (maxRange!=m_maxRange)
+        if (maxRange!=m_maxRange || !Stamp)
         {
             m_maxRange=maxRange;
 
             delete [] Exponential;
-            Exponential=new double[maxRange];
+            Exponential=new double[maxRange+1];
 
             double k=-0.5/(sigma*sigma);
-            for (int x=0; x<maxRange; ++x)
+            for (int x=0; x<=maxRange; ++x)
             {
                 Exponential[x]=exp(k*double(x*x));
             }
+
+            // the gaussian is separable: tabulate one quadrant of the stamp
+            delete [] Stamp;
+            Stamp=new double[(maxRange+1)*(maxRange+1)];
+
+            for (int y=0; y<=maxRange; ++y)
+            {
+                for (int x=0; x<=maxRange; ++x)
+                {
+                    Stamp[y*(maxRange+1)+x]=Exponential[y]*Exponential[x];
+                }
+            }
+        }
+
+        // half widths of the disc drawn in light mode
+        int maxRange2=m_maxRangeLight*m_maxRangeLight;
+        lightSpan.resize(m_maxRangeLight+1);
+        for (int dy=0; dy<=m_maxRangeLight; ++dy)
+        {
+            int dx=0;
+            while ((dx+1)*(dx+1)+dy*dy<=maxRange2) ++dx;
+            lightSpan[dy]=dx;
         }
 
         xMin=w2+int(scale*(dXc-dXmid-15.0))-maxRange;
@@ -104,6 +169,26 @@ public:
 
         m_Width=width;
         m_Height=height;
+
+        // area that can be touched by the splats and by the outlines,
+        // which are dithered over 3x3 pixels
+        m_reach=m_maxRange>m_maxRangeLight?m_maxRange:m_maxRangeLight;
+        if (int(m_Radius)+2>m_reach) m_reach=int(m_Radius)+2;
+
+        bounds=Rect();
+        for (int i=0; i<nTaxels; ++i)
+        {
+            bounds.merge(Rect(x[i]-m_reach,y[i]-m_reach,x[i]+m_reach,y[i]+m_reach));
+        }
+
+        for (int i=0; i<nVerts; ++i)
+        {
+            bounds.merge(Rect(xv[i]-2,yv[i]-2,xv[i]+2,yv[i]+2));
+        }
+
+        bounds=bounds.clipped(Rect(0,0,width-1,height-1));
+        resetClip();
+        invalidated=true;
     }
 
     virtual ~TouchSensor()
@@ -113,6 +198,12 @@ public:
             delete [] Exponential;
             Exponential=0;
         }
+
+        if (Stamp)
+        {
+            delete [] Stamp;
+            Stamp=0;
+        }
     }
 
     int Abs(int x)
@@ -125,13 +216,11 @@ public:
         return nTaxels;
     }
 
-    void eval_light(unsigned char *image)
+    // Compares the current activations against the ones rendered last time
+    // and returns the region of the image to be recomposed; eval(), eval_light()
+    // and draw() then render the activations committed here.
+    bool update(Rect &dirty)
     {
-        int act;
-        int dx,dy;
-        int Y0,Y1;
-        int dya,dyb,dxa,dxb;
-
         switch (ilayoutNum)
         {
             case 0:
@@ -146,29 +235,82 @@ public:
                 break;
         }
 
-        int maxRange2=m_maxRangeLight*m_maxRangeLight;
+        dirty=Rect();
 
-        for (int i=0; i<nTaxels; ++i) if (connected[i] && remapped_activation[i]>0.0)
+        if (invalidated)
         {
-            act=int(dGain*remapped_activation[i]);
-            Y0=(m_Height-y[i]-1)*m_Width+x[i];
+            dirty=bounds;
+        }
+        else
+        {
+            bool recolor=(R_MAX!=drawnR || G_MAX!=drawnG || B_MAX!=drawnB);
+
+            for (int i=0; i<nTaxels; ++i) if (connected[i])
+            {
+                bool active=remapped_activation[i]>0.0 || drawn_activation[i]>0.0;
+
+                if (remapped_activation[i]!=drawn_activation[i] || (recolor && active))
+                {
+                    dirty.merge(Rect(x[i]-m_reach,y[i]-m_reach,x[i]+m_reach,y[i]+m_reach));
+                }
+            }
+
+            dirty=dirty.clipped(bounds);
+        }
+
+        memcpy(drawn_activation,remapped_activation,nTaxels*sizeof(double));
+        drawnR=R_MAX;
+        drawnG=G_MAX;
+        drawnB=B_MAX;
+        invalidated=false;
+
+        return !dirty.empty();
+    }
+
+    const Rect& getBounds() const
+    {
+        return bounds;
+    }
+
+    void setClip(const Rect &r)
+    {
+        clip=r.clipped(Rect(0,0,m_Width-1,m_Height-1));
+    }
+
+    void resetClip()
+    {
+        clip=Rect(0,0,m_Width-1,m_Height-1);
+    }
+
+    void eval_light(unsigned char *image)
+    {
+        int act;
+        int dx,dy;
+        int Y0,Y1;
+        int dya,dyb,dxa,dxb;
+        int span;
 
-            dya=(y[i]>=m_maxRangeLight)?-m_maxRangeLight:-y[i];
-            dyb=(y[i]+m_maxRangeLight<m_Height)?m_maxRangeLight:m_Height-y[i]-1;
+        for (int i=0; i<nTaxels; ++i) if (connected[i] && drawn_activation[i]>0.0)
+        {
+            act=int(dGain*drawn_activation[i]);
+            if (act>255) act=255;
 
-            dxa=(x[i]>=m_maxRangeLight)?-m_maxRangeLight:-x[i];
-            dxb=(x[i]+m_maxRangeLight<m_Width)?m_maxRangeLight:m_Width-x[i]-1;
+            Y0=(m_Height-y[i]-1)*m_Width+x[i];
+
+            dya=(clip.y0-y[i]>-m_maxRangeLight)?clip.y0-y[i]:-m_maxRangeLight;
+            dyb=(clip.y1-y[i]<m_maxRangeLight)?clip.y1-y[i]:m_maxRangeLight;
 
             for (dy=dya; dy<=dyb; ++dy)
             {
                 Y1=Y0-dy*m_Width;
+                span=lightSpan[Abs(dy)];
+
+                dxa=(clip.x0-x[i]>-span)?clip.x0-x[i]:-span;
+                dxb=(clip.x1-x[i]<span)?clip.x1-x[i]:span;
 
                 for (dx=dxa; dx<=dxb; ++dx)
                 {
-                    if (dx*dx+dy*dy<=maxRange2)
-                    {
-                        image[(dx+Y1)*3]=act<255?act:255;
-                    }
+                    image[(dx+Y1)*3]=act;
                 }
             }
         }
@@ -180,37 +322,24 @@ public:
         int dx,dy;
         int Y0,Y1;
         int index;
-        double k0,k1;
+        double k0;
+        const double *row;
         int dya,dyb,dxa,dxb;
 
-        switch (ilayoutNum)
-        {
-            case 0:
-                for (int i=0; i<nTaxels; ++i)  remapped_activation[i]=activation[i];
-                break;
-            case 1:
-                for (int i=0; i<nTaxels; ++i)  remapped_activation[nTaxels-1-i]=activation[i];
-                break;
-            default:
-                for (int i=0; i<nTaxels; ++i)  remapped_activation[i]=activation[i];
-                printf("WARN: unkwnown layout number.\n");
-                break;
-        }
-
-        for (int i=0; i<nTaxels; ++i) if (connected[i] && remapped_activation[i]>0.0)
+        for (int i=0; i<nTaxels; ++i) if (connected[i] && drawn_activation[i]>0.0)
         {
-            k0=dGain*remapped_activation[i];
+            k0=dGain*drawn_activation[i];
             Y0=(m_Height-y[i]-1)*m_Width+x[i];
 
-            dya=(y[i]>=m_maxRange)?-m_maxRange:-y[i];
-            dyb=(y[i]+m_maxRange<m_Height)?m_maxRange:m_Height-y[i]-1;
+            dya=(clip.y0-y[i]>-m_maxRange)?clip.y0-y[i]:-m_maxRange;
+            dyb=(clip.y1-y[i]<m_maxRange)?clip.y1-y[i]:m_maxRange;
 
-            dxa=(x[i]>=m_maxRange)?-m_maxRange:-x[i];
-            dxb=(x[i]+m_maxRange<m_Width)?m_maxRange:m_Width-x[i]-1;
+            dxa=(clip.x0-x[i]>-m_maxRange)?clip.x0-x[i]:-m_maxRange;
+            dxb=(clip.x1-x[i]<m_maxRange)?clip.x1-x[i]:m_maxRange;
 
             for (dy=dya; dy<=dyb; ++dy)
             {
-                k1=k0*Exponential[Abs(dy)];
+                row=Stamp+Abs(dy)*(m_maxRange+1);
                 Y1=Y0-dy*m_Width;
 
                 for (dx=dxa; dx<=dxb; ++dx)
@@ -219,7 +348,7 @@ public:
 
                     if (image[index]<R_MAX || image[index+1]<G_MAX || image[index+2]<B_MAX)
                     {
-                        act=int(k1*Exponential[Abs(dx)]);
+                        act=int(k0*row[Abs(dx)]);
 
                         int actR=image[index  ]+(act*R_MAX)/255;
                         int actG=image[index+1]+(act*G_MAX)/255;
@@ -234,6 +363,81 @@ public:
         }
     }
 
+    // Recomposes only the regions whose activations changed since the last
+    // call and returns their bounding box; the rest of the image is kept.
+    static bool compose(TouchSensor **sensors,int num,unsigned char *image,bool light,Rect &dirty)
+    {
+        std::vector<Rect> regions;
+        int width=0,height=0;
+
+        for (int t=0; t<num; ++t) if (sensors[t])
+        {
+            Rect r;
+            if (sensors[t]->update(r))
+            {
+                regions.push_back(r);
+            }
+
+            width=sensors[t]->m_Width;
+            height=sensors[t]->m_Height;
+        }
+
+        // merge the overlapping regions, so that no pixel is recomposed twice
+        for (bool merged=true; merged;)
+        {
+            merged=false;
+            for (size_t i=0; i<regions.size() && !merged; ++i)
+            {
+                for (size_t j=i+1; j<regions.size(); ++j)
+                {
+                    if (regions[i].intersects(regions[j]))
+                    {
+                        regions[i].merge(regions[j]);
+                        regions.erase(regions.begin()+j);
+                        merged=true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        dirty=Rect();
+
+        for (size_t k=0; k<regions.size(); ++k)
+        {
+            const Rect &r=regions[k];
+
+            for (int py=r.y0; py<=r.y1; ++py)
+            {
+                memset(image+((height-py-1)*width+r.x0)*3,0,(r.x1-r.x0+1)*3);
+            }
+
+            // splats first, then outlines, as in the full redraw
+            for (int t=0; t<num; ++t) if (sensors[t] && sensors[t]->bounds.intersects(r))
+            {
+                sensors[t]->setClip(r);
+                if (light)
+                {
+                    sensors[t]->eval_light(image);
+                }
+                else
+                {
+                    sensors[t]->eval(image);
+                }
+            }
+
+            for (int t=0; t<num; ++t) if (sensors[t] && sensors[t]->bounds.intersects(r))
+            {
+                sensors[t]->draw(image);
+                sensors[t]->resetClip();
+            }
+
+            dirty.merge(r);
+        }
+
+        return !dirty.empty();
+    }
+
     void setActivationFirst7(unsigned char* data)
     {
         for (int i=0; i<7; ++i)
@@ -288,53 +492,32 @@ public:
 protected:
     void dither(int x,int y,unsigned char *image)
     {
-        static const unsigned char R1=0x80,G1=0x50,B1=0x00;
-        static const unsigned char R2=3*R1/4,G2=3*G1/4,B2=3*B1/4;
-        static const unsigned char R4=3*R2/4,G4=3*G2/4,B4=3*B2/4;
-
-        //y=m_Width-y-1;
-        //int bytePos=(x+(y-1)*m_Width)*3;
-        int bytePos=(x+(m_Height-y-2)*m_Width)*3;
-
-        if (image[bytePos-3]<R4) image[bytePos-3]=R4;
-        if (image[bytePos-2]<G4) image[bytePos-2]=G4;
-        //if (image[bytePos-1]<B4) image[bytePos-1]=B4;
-
-        if (image[bytePos  ]<R2) image[bytePos  ]=R2;
-        if (image[bytePos+1]<G2) image[bytePos+1]=G2;
-        //if (image[bytePos+2]<B2) image[bytePos+2]=B2;
+        static const unsigned char R1=0x80,G1=0x50;
+        static const unsigned char R2=3*R1/4,G2=3*G1/4;
+        static const unsigned char R4=3*R2/4,G4=3*G2/4;
 
-        if (image[bytePos+3]<R4) image[bytePos+3]=R4;
-        if (image[bytePos+4]<G4) image[bytePos+4]=G4;
-        //if (image[bytePos+5]<B4) image[bytePos+5]=B4;
+        // corners, edges and center of the 3x3 neighbourhood;
+        // the blue channel is left untouched
+        static const unsigned char R[3]={R4,R2,R1};
+        static const unsigned char G[3]={G4,G2,G1};
 
-        bytePos+=m_Width*3;
-
-        if (image[bytePos-3]<R2) image[bytePos-3]=R2;
-        if (image[bytePos-2]<G2) image[bytePos-2]=G2;
-        //if (image[bytePos-1]<B2) image[bytePos-1]=B2;
-
-        if (image[bytePos  ]<R1) image[bytePos  ]=R1;
-        if (image[bytePos+1]<G1) image[bytePos+1]=G1;
-        //if (image[bytePos+2]<B1) image[bytePos+2]=B1;
-
-        if (image[bytePos+3]<R2) image[bytePos+3]=R2;
-        if (image[bytePos+4]<G2) image[bytePos+4]=G2;
-        //if (image[bytePos+5]<B2) image[bytePos+5]=B2;
-
-        bytePos+=m_Width*3;
+        for (int dy=1; dy>=-1; --dy)
+        {
+            int py=y+dy;
+            if (py<clip.y0 || py>clip.y1) continue;
 
-        if (image[bytePos-3]<R4) image[bytePos-3]=R4;
-        if (image[bytePos-2]<G4) image[bytePos-2]=G4;
-        //if (image[bytePos-1]<B4) image[bytePos-1]=B4;
+            for (int dx=-1; dx<=1; ++dx)
+            {
+                int px=x+dx;
+                if (px<clip.x0 || px>clip.x1) continue;
 
-        if (image[bytePos  ]<R2) image[bytePos  ]=R2;
-        if (image[bytePos+1]<G2) image[bytePos+1]=G2;
-        //if (image[bytePos+2]<B2) image[bytePos+2]=B2;
+                int w=2-Abs(dx)-Abs(dy);
+                int bytePos=(px+(m_Height-py-1)*m_Width)*3;
 
-        if (image[bytePos+3]<R4) image[bytePos+3]=R4;
-        if (image[bytePos+4]<G4) image[bytePos+4]=G4;
-        //if (image[bytePos+5]<B4) image[bytePos+5]=B4;
+                if (image[bytePos  ]<R[w]) image[bytePos  ]=R[w];
+                if (image[bytePos+1]<G[w]) image[bytePos+1]=G[w];
+            }
+        }
     }
 
     void drawLine(unsigned char *image,int x0,int y0,int x1,int y1)
@@ -390,13 +573,18 @@ protected:
     double m_Radius,m_RadiusOrig;
     double activation[MAX_TAXELS];
     double remapped_activation[MAX_TAXELS];
+    double drawn_activation[MAX_TAXELS];
     bool connected[MAX_TAXELS];
 
     unsigned char R_MAX, G_MAX, B_MAX;
+    unsigned char drawnR, drawnG, drawnB;
+    bool invalidated;
 
     int m_maxRangeLight;
+    std::vector<int> lightSpan;
     static int m_maxRange;
     static double *Exponential;
+    static double *Stamp;
 
     // scaled
     int x[MAX_TAXELS],y[MAX_TAXELS];
@@ -409,6 +597,10 @@ protected:
 
     int m_Width,m_Height;
 
+    int  m_reach;
+    Rect bounds;
+    Rect clip;
+
     public:
     int min_tax;
     int max_tax;
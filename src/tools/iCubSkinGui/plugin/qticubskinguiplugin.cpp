@@ -195,22 +195,21 @@ void QtICubSkinGuiPlugin::paint(QPainter *painter)
         }
         gpActivationMap = new double[gImageArea];
         gpImageBuff = new uchar[gImageSize];
+        memset(gpImageBuff,0,gImageSize);
 
+        // the sensors are invalidated by the resize and fully recomposed
+        TouchSensor::Rect dirty;
         if(TheadType == TYPE_CAN && gpSkinMeshThreadCan  && gWidth>=180 && gHeight>=180){
             gpSkinMeshThreadCan->resize(gWidth,gHeight);
+            gpSkinMeshThreadCan->eval(gpImageBuff,dirty);
         } else if (TheadType == TYPE_PORT && gpSkinMeshThreadPort && gWidth>=180 && gHeight>=180){
             gpSkinMeshThreadPort->resize(gWidth,gHeight);
+            gpSkinMeshThreadPort->eval(gpImageBuff,dirty);
         }
     }
 
+    // the image is recomposed incrementally by onTimeout()
     if (TheadType == TYPE_CAN && gpSkinMeshThreadCan){
-        memset(gpImageBuff,0,gImageSize);
-
-        if (gWidth>=180 && gHeight>=180){
-            gpSkinMeshThreadCan->eval(gpImageBuff);
-            gpSkinMeshThreadCan->draw(gpImageBuff);
-        }
-
         QImage img = QImage(gpImageBuff,gWidth,gHeight,gRowStride,QImage::Format_RGB32);
         painter->beginNativePainting();
         painter->fillRect(0,0,gWidth,gHeight,QColor("black"));
@@ -218,15 +217,6 @@ void QtICubSkinGuiPlugin::paint(QPainter *painter)
         painter->endNativePainting();
 
     }else if (TheadType == TYPE_PORT && gpSkinMeshThreadPort) {
-        memset(gpImageBuff,0,gImageSize);
-
-        if (gWidth>=180 && gHeight>=180)
-        {
-            gpSkinMeshThreadPort->eval(gpImageBuff);
-            gpSkinMeshThreadPort->draw(gpImageBuff);
-        }
-
-
         QImage img = QImage(gpImageBuff,gWidth,gHeight,gRowStride,QImage::Format_RGB888);
 
         painter->beginNativePainting();
@@ -300,6 +290,7 @@ bool QtICubSkinGuiPlugin::parseParameters(QStringList params)
 
     gpActivationMap=new double[gImageArea];
     gpImageBuff=new uchar[gImageSize];
+    memset(gpImageBuff,0,gImageSize);
 
     /***********/
     // TODO
@@ -324,24 +315,46 @@ bool QtICubSkinGuiPlugin::parseParameters(QStringList params)
 
 void QtICubSkinGuiPlugin::onTimeout()
 {
-    update();
+    // recompose only the regions whose taxels changed
+    // and repaint just their bounding box
+    TouchSensor::Rect dirty;
+    bool changed=false;
+
+    mutex.lock();
+    if (gpImageBuff && gWidth>=180 && gHeight>=180){
+        if (TheadType == TYPE_CAN && gpSkinMeshThreadCan){
+            changed=gpSkinMeshThreadCan->eval(gpImageBuff,dirty);
+        } else if (TheadType == TYPE_PORT && gpSkinMeshThreadPort){
+            changed=gpSkinMeshThreadPort->eval(gpImageBuff,dirty);
+        }
+    }
+    mutex.unlock();
+
+    if (changed){
+        update(QRect(dirty.x0,gHeight-1-dirty.y1,dirty.x1-dirty.x0+1,dirty.y1-dirty.y0+1));
+    }
 }
 
 void QtICubSkinGuiPlugin::onInit()
 {
     int period = rf.check("period")?rf.find("period").asInt32():50;
 
+    // the image buffer may have been resized in the meanwhile
+    mutex.lock();
     if (TheadType==TYPE_CAN)
     {
         gpSkinMeshThreadCan=new SkinMeshThreadCan(rf,period);
+        gpSkinMeshThreadCan->resize(gWidth,gHeight);
         gpSkinMeshThreadCan->start();
 
     }
     else if (TheadType==TYPE_PORT)
     {
         gpSkinMeshThreadPort=new SkinMeshThreadPort(rf,period);
+        gpSkinMeshThreadPort->resize(gWidth,gHeight);
         gpSkinMeshThreadPort->start();
     }
+    mutex.unlock();
 
     done();
 }
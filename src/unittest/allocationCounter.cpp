@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "allocationCounter.h"
+
+namespace allocationCounter
+{
+std::atomic<bool> enabled(false);
+std::atomic<size_t> count(0);
+}  // namespace allocationCounter
+
+void *operator new(std::size_t size)
+{
+	if (allocationCounter::enabled)
+		allocationCounter::count++;
+	if (void *p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+	std::free(p);
+}
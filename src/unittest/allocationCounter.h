@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// The global operator new is replaced in allocationCounter.cpp:
+// while enabled, every heap allocation increments the counter.
+namespace allocationCounter
+{
+extern std::atomic<bool> enabled;
+extern std::atomic<size_t> count;
+}  // namespace allocationCounter
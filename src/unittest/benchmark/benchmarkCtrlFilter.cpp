@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <yarp/sig/Vector.h>
+
+#include <iCub/ctrl/filters.h>
+
+#include "randomData.h"
+#include "referenceFilters.h"
+#include "timing.h"
+
+using namespace yarp::sig;
+using namespace iCub::ctrl;
+using namespace referenceFilters;
+
+namespace
+{
+void run(const size_t channels, const size_t n)
+{
+	Vector num, den;
+	butterworth(num, den);
+	Vector y0(channels, 0.0);
+
+	randomData::Generator gen;
+	std::vector<Vector> inputs;
+	for (size_t k = 0; k < n; k++)
+		inputs.push_back(gen.uniformVector(channels, -1.0, 1.0));
+
+	DequeFilter reference(num, den, y0);
+	double deque = timing::microseconds([&]() {
+		for (size_t k = 0; k < n; k++)
+			reference.filt(inputs[k]);
+	});
+
+	Filter filter(num, den, y0);
+	double circular = timing::microseconds([&]() {
+		for (size_t k = 0; k < n; k++)
+			filter.filt(inputs[k]);
+	});
+
+	std::cout << "Filter [" << channels << " channels]: deque " << deque << " us, "
+			  << "circular " << circular << " us "
+			  << "for " << n << " samples" << std::endl;
+}
+}  // namespace
+
+// usage: benchmarkCtrlFilter [samples]
+int main(int argc, char *argv[])
+{
+	const size_t n = (argc > 1) ? std::stoul(argv[1]) : 20000;
+	for (size_t channels : {6, 16, 64})
+		run(channels, n);
+	return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <iostream>
+#include <string>
+
+#include <yarp/sig/Vector.h>
+
+#include <iCub/iDyn/iDyn.h>
+#include <iCub/iDyn/iDynInv.h>
+
+#include "randomData.h"
+#include "timing.h"
+
+using namespace yarp::sig;
+using namespace iCub::iDyn;
+
+namespace
+{
+void run(iDynChain &chain, const std::string &name, const NewEulMode mode, const size_t n)
+{
+	randomData::Generator gen;
+	chain.prepareNewtonEuler(mode);
+	chain.setAng(gen.configuration(chain));
+	chain.setDAng(gen.uniformVector(chain.getDOF(), -1.0, 1.0));
+	chain.setD2Ang(gen.uniformVector(chain.getDOF(), -1.0, 1.0));
+
+	Vector w0(3, 0.0), dw0(3, 0.0), ddp0(3, 0.0), Fend(3, 0.0), Muend(3, 0.0);
+	ddp0[2] = 9.81;
+	chain.initNewtonEuler(w0, dw0, ddp0, Fend, Muend);
+
+	chain.setFixedSizeNewtonEuler(false);
+	double classic = timing::microseconds([&]() {
+		for (size_t i = 0; i < n; i++)
+			chain.computeNewtonEuler();
+	});
+
+	chain.setFixedSizeNewtonEuler(true);
+	double fixed = timing::microseconds([&]() {
+		for (size_t i = 0; i < n; i++)
+			chain.computeNewtonEuler();
+	});
+
+	std::cout << name << " [" << NewEulMode_s[mode] << "]: classic " << classic << " us, "
+			  << "fixed-size " << fixed << " us "
+			  << "for " << n << " calls" << std::endl;
+}
+}  // namespace
+
+// usage: benchmarkIDynFixedNewtonEuler [calls]
+int main(int argc, char *argv[])
+{
+	const size_t n = (argc > 1) ? std::stoul(argv[1]) : 20000;
+
+	iCubArmDyn arm("right");
+	iCubLegDyn leg("left");
+	for (NewEulMode mode : {DYNAMIC, DYNAMIC_CORIOLIS_GRAVITY, STATIC})
+	{
+		run(arm, "iCubArmDyn", mode, n);
+		run(leg, "iCubLegDyn", mode, n);
+	}
+	return 0;
+}
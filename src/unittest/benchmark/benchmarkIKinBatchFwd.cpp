@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <iostream>
+#include <string>
+
+#include <yarp/sig/Matrix.h>
+#include <yarp/sig/Vector.h>
+
+#include <iCub/iKin/iKinFwd.h>
+
+#include "randomData.h"
+#include "timing.h"
+
+using namespace yarp::sig;
+using namespace iCub::iKin;
+
+namespace
+{
+void run(iKinChain &chain, const std::string &name, const size_t n)
+{
+	Matrix Q = randomData::Generator().configurations(chain, n);
+	Matrix P, J;
+
+	double scalar = timing::microseconds([&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			chain.EndEffPose(Q.getRow(i));
+			chain.GeoJacobian();
+		}
+	});
+	double batch = timing::microseconds([&]() { chain.EndEffPoseBatch(Q, P, J); });
+	double batch_mt = timing::microseconds([&]() { chain.EndEffPoseBatch(Q, P, J, true, 4); });
+
+	std::cout << name << ": scalar " << scalar << " us, "
+			  << "batch " << batch << " us, "
+			  << "batch (4 threads) " << batch_mt << " us "
+			  << "for " << n << " configurations" << std::endl;
+}
+}  // namespace
+
+// usage: benchmarkIKinBatchFwd [configurations]
+int main(int argc, char *argv[])
+{
+	const size_t n = (argc > 1) ? std::stoul(argv[1]) : 20000;
+
+	iCubArm arm("right_v2");
+	arm.releaseLink(0);
+	arm.releaseLink(1);
+	arm.releaseLink(2);
+	run(arm, "iCubArm", n);
+
+	iCubEye eye("left_v2");
+	run(eye, "iCubEye", n);
+	return 0;
+}
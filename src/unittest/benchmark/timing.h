@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace timing
+{
+// best wall-clock time in microseconds over a few runs of f
+template <class F>
+double microseconds(F &&f, const int runs = 5)
+{
+	double best = std::numeric_limits<double>::max();
+	for (int r = 0; r < runs; r++)
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		f();
+		auto t1 = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::micro>(t1 - t0).count());
+	}
+	return best;
+}
+}  // namespace timing
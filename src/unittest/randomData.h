@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <random>
+
+#include <yarp/sig/Matrix.h>
+#include <yarp/sig/Vector.h>
+
+// Seeded source of the datasets shared by the tests and the benchmarks:
+// the same seed always yields the same sequence of draws.
+namespace randomData
+{
+class Generator
+{
+	std::mt19937 gen;
+	std::normal_distribution<double> standard{0.0, 1.0};
+
+public:
+	explicit Generator(const unsigned int seed = 0) : gen(seed) {}
+
+	double uniform(const double lo, const double hi)
+	{
+		return std::uniform_real_distribution<double>(lo, hi)(gen);
+	}
+
+	int uniformInt(const int lo, const int hi)
+	{
+		return std::uniform_int_distribution<int>(lo, hi)(gen);
+	}
+
+	double normal(const double mean = 0.0, const double sigma = 1.0)
+	{
+		return mean + sigma * standard(gen);
+	}
+
+	yarp::sig::Vector uniformVector(const size_t n, const double lo, const double hi)
+	{
+		yarp::sig::Vector v(n);
+		for (size_t i = 0; i < n; i++)
+			v[i] = uniform(lo, hi);
+		return v;
+	}
+
+	yarp::sig::Matrix uniformMatrix(const size_t rows, const size_t cols, const double lo, const double hi)
+	{
+		yarp::sig::Matrix M(rows, cols);
+		for (size_t r = 0; r < rows; r++)
+			for (size_t c = 0; c < cols; c++)
+				M(r, c) = uniform(lo, hi);
+		return M;
+	}
+
+	yarp::sig::Matrix normalMatrix(const size_t rows, const size_t cols, const double mean = 0.0, const double sigma = 1.0)
+	{
+		yarp::sig::Matrix M(rows, cols);
+		for (size_t r = 0; r < rows; r++)
+			for (size_t c = 0; c < cols; c++)
+				M(r, c) = normal(mean, sigma);
+		return M;
+	}
+
+	// joint values within the limits of an iKinChain (or derived chain)
+	template <class Chain>
+	yarp::sig::Vector configuration(Chain &chain)
+	{
+		yarp::sig::Vector q(chain.getDOF());
+		for (unsigned int j = 0; j < chain.getDOF(); j++)
+			q[j] = uniform(chain(j).getMin(), chain(j).getMax());
+		return q;
+	}
+
+	// one configuration per row
+	template <class Chain>
+	yarp::sig::Matrix configurations(Chain &chain, const size_t n)
+	{
+		yarp::sig::Matrix Q(n, chain.getDOF());
+		for (size_t i = 0; i < n; i++)
+			Q.setRow(i, configuration(chain));
+		return Q;
+	}
+};
+}  // namespace randomData
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#pragma once
+
+#include <deque>
+
+#include <yarp/sig/Vector.h>
+
+// Reference implementations shared by the filter tests and benchmark.
+namespace referenceFilters
+{
+using yarp::sig::Vector;
+
+// the former implementation, with the histories kept in deques of Vectors
+class DequeFilter
+{
+	Vector b, a, y;
+	std::deque<Vector> uold, yold;
+
+public:
+	DequeFilter(const Vector &num, const Vector &den, const Vector &y0) : b(num), a(den), y(y0)
+	{
+		uold.insert(uold.begin(), b.length() - 1, Vector(y0.length(), 0.0));
+		yold.insert(yold.begin(), a.length() - 1, y0);
+	}
+
+	const Vector &filt(const Vector &u)
+	{
+		for (size_t j = 0; j < y.length(); j++)
+			y[j] = b[0] * u[j];
+		for (size_t i = 1; i < b.length(); i++)
+			for (size_t j = 0; j < y.length(); j++)
+				y[j] += b[i] * uold[i - 1][j];
+		for (size_t i = 1; i < a.length(); i++)
+			for (size_t j = 0; j < y.length(); j++)
+				y[j] -= a[i] * yold[i - 1][j];
+		for (size_t j = 0; j < y.length(); j++)
+			y[j] /= a[0];
+
+		uold.push_front(u);
+		uold.pop_back();
+		yold.push_front(y);
+		yold.pop_back();
+		return y;
+	}
+
+	const std::deque<Vector> &getInputStates() const { return uold; }
+	const std::deque<Vector> &getOutputStates() const { return yold; }
+};
+
+// 4th-order Butterworth low-pass, cut-off at 0.1 of the Nyquist frequency
+inline void butterworth(Vector &num, Vector &den)
+{
+	num.resize(5);
+	den.resize(5);
+	num[0] = 0.000416599204407; num[1] = 0.001666396817626; num[2] = 0.002499595226440;
+	num[3] = 0.001666396817626; num[4] = 0.000416599204407;
+	den[0] = 1.0; den[1] = -3.180638548874721; den[2] = 3.861194348994217;
+	den[3] = -2.112155355110971; den[4] = 0.438265142261981;
+}
+}  // namespace referenceFilters
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <yarp/math/Math.h>
+#include <yarp/math/SVD.h>
+#include <yarp/sig/Matrix.h>
+#include <yarp/sig/Vector.h>
+
+#include <iCub/ctrl/adaptWinPolyEstimator.h>
+
+#include "gtest/gtest.h"
+#include "randomData.h"
+
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::ctrl;
+
+namespace
+{
+// the former implementation, fitting every window through a pseudo-inverse
+class ReferenceEstimator
+{
+	std::deque<AWPolyElement> elemList;
+	unsigned int order, N;
+	double D;
+	Vector t, x, coeff, winLen;
+	bool firstRun = true;
+
+	Vector fit(const unsigned int n)
+	{
+		const unsigned int i1 = N - n;
+		if (order == 1)
+		{
+			double sum_xi = 0.0, sum_xixi = 0.0, sum_yi = 0.0, sum_xiyi = 0.0;
+			for (unsigned int i = i1; i < N; i++)
+			{
+				sum_xi += t[i];
+				sum_xixi += t[i] * t[i];
+				sum_yi += x[i];
+				sum_xiyi += t[i] * x[i];
+			}
+			double den = n * sum_xixi - sum_xi * sum_xi;
+			Vector c(2);
+			c[0] = (sum_yi * sum_xixi - sum_xi * sum_xiyi) / den;
+			c[1] = (n * sum_xiyi - sum_xi * sum_yi) / den;
+			return c;
+		}
+
+		Matrix R(n, order + 1);
+		Vector _y(n);
+		for (unsigned int i = i1; i < N; i++)
+		{
+			double p = t[i];
+			R(i - i1, 0) = 1.0;
+			for (unsigned int j = 1; j <= order; j++)
+			{
+				R(i - i1, j) = p;
+				p *= t[i];
+			}
+			_y[i - i1] = x[i];
+		}
+		return pinv(R) * _y;
+	}
+
+	double eval(double _x) const
+	{
+		double y = coeff[0], p = _x;
+		for (unsigned int i = 1; i <= order; i++)
+		{
+			y += coeff[i] * p;
+			p *= _x;
+		}
+		return y;
+	}
+
+public:
+	ReferenceEstimator(unsigned int order, unsigned int N, const double D) : order(order), N(N), D(D)
+	{
+		coeff.resize(order + 1);
+		t.resize(N);
+		x.resize(N);
+	}
+
+	Vector estimate(const AWPolyElement &el)
+	{
+		elemList.push_back(el);
+		size_t dim = elemList[0].data.length();
+		Vector esteem(dim, 0.0);
+		if (firstRun)
+		{
+			winLen.resize(dim, N);
+			firstRun = false;
+		}
+
+		int delta = (int)elemList.size() - (int)N;
+		if (delta < 0)
+			return esteem;
+
+		t[0] = 0.0;
+		for (unsigned int j = 1; j < N; j++)
+			t[j] = elemList[delta + j].time - elemList[delta].time;
+
+		for (unsigned int i = 0; i < dim; i++)
+		{
+			for (unsigned int j = 0; j < N; j++)
+				x[j] = elemList[delta + j].data[i];
+
+			unsigned int n1 = (unsigned int)((winLen[i] > (order + 1)) ? (winLen[i] - 1) : (order + 1));
+			unsigned int n2 = (unsigned int)((winLen[i] < N) ? (winLen[i] + 1) : N);
+			for (unsigned int n = n1; n <= n2; n++)
+			{
+				coeff = fit(n);
+				bool _stop = false;
+				for (unsigned int k = N - n; k < N; k++)
+					_stop |= (std::fabs(x[k] - eval(t[k])) > D);
+				if (_stop)
+				{
+					winLen[i] = n;
+					break;
+				}
+			}
+
+			// derivative of the same order as the polynomial
+			esteem[i] = coeff[order];
+			for (unsigned int k = 2; k <= order; k++)
+				esteem[i] *= k;
+		}
+
+		int margin = delta - 10;
+		if (margin > 0)
+			elemList.erase(elemList.begin(), elemList.begin() + margin);
+		return esteem;
+	}
+
+	const Vector &getWinLen() const { return winLen; }
+};
+
+// third order fitting, estimating the third derivative
+class AWCubicEstimator : public AWPolyEstimator
+{
+protected:
+	double getEsteeme() override { return 6.0 * coeff[3]; }
+
+public:
+	AWCubicEstimator(unsigned int N, const double D) : AWPolyEstimator(3, N, D) {}
+};
+
+// joint-like trajectories: sinusoids, ramps and steps plus noise,
+// sampled at about 1 kHz with some jitter
+std::vector<AWPolyElement> trajectories(const size_t channels, const size_t samples)
+{
+	randomData::Generator gen;
+	std::vector<AWPolyElement> elements;
+	double time = 100.0;
+	for (size_t k = 0; k < samples; k++)
+	{
+		Vector q(channels);
+		for (size_t j = 0; j < channels; j++)
+		{
+			q[j] = 30.0 * std::sin(2.0 * M_PI * (0.2 + 0.1 * j) * time) + 5.0 * j + gen.normal(0.0, 0.05);
+			if ((j % 3) == 1)
+				q[j] += 10.0 * std::floor(time);
+		}
+		elements.push_back(AWPolyElement(q, time));
+		time += 1e-3 + gen.uniform(-2e-4, 2e-4);
+	}
+	return elements;
+}
+
+template <class Estimator>
+void compareWithReference(const unsigned int order, const unsigned int N, const double D, const double tol, const std::string &name)
+{
+	const size_t channels = 16, n = 5000;
+	std::vector<AWPolyElement> elements = trajectories(channels, n);
+
+	ReferenceEstimator reference(order, N, D);
+	Estimator estimator(N, D);
+	for (size_t k = 0; k < n; k++)
+	{
+		const Vector out_ref = reference.estimate(elements[k]);
+		const Vector out = estimator.estimate(elements[k]);
+		const Vector winLen = estimator.getWinLen();
+		for (size_t j = 0; j < channels; j++)
+		{
+			ASSERT_EQ(winLen[j], reference.getWinLen()[j]) << name << ": sample " << k << ", channel " << j;
+			ASSERT_NEAR(out_ref[j], out[j], tol * std::max(1.0, std::fabs(out_ref[j])))
+				<< name << ": sample " << k << ", channel " << j;
+		}
+	}
+}
+}  // namespace
+
+TEST(ctrlAWPolyEstimator, linear_vs_reference_001)
+{
+	compareWithReference<AWLinEstimator>(1, 16, 1.0, 1e-6, "AWLinEstimator(16,1.0)");
+}
+
+TEST(ctrlAWPolyEstimator, quadratic_vs_reference_001)
+{
+	compareWithReference<AWQuadEstimator>(2, 25, 1.0, 1e-5, "AWQuadEstimator(25,1.0)");
+}
+
+TEST(ctrlAWPolyEstimator, cubic_vs_reference_001)
+{
+	compareWithReference<AWCubicEstimator>(3, 30, 1.0, 1e-4, "AWCubicEstimator(30,1.0)");
+}
+
+TEST(ctrlAWPolyEstimator, ring_and_reset_001)
+{
+	AWLinEstimator estimator(4, 1.0);
+	for (int k = 0; k < 10; k++)
+		estimator.feedData(AWPolyElement(Vector(2, (double)k), 0.1 * k));
+
+	// only the last elements of the window are retained
+	AWPolyList list = estimator.getList();
+	ASSERT_EQ(list.size(), (size_t)4);
+	for (size_t j = 0; j < list.size(); j++)
+	{
+		EXPECT_DOUBLE_EQ(list[j].time, 0.1 * (6 + j));
+		EXPECT_EQ(list[j].data[1], (double)(6 + j));
+	}
+
+	// a ramp with unit slope over 0.1 s
+	Vector v = estimator.estimate();
+	EXPECT_NEAR(v[0], 10.0, 1e-9);
+	EXPECT_NEAR(v[1], 10.0, 1e-9);
+
+	// after a reset the output is zero until the window fills up again
+	estimator.reset();
+	EXPECT_EQ(estimator.getList().size(), (size_t)0);
+	for (int k = 0; k < 3; k++)
+		EXPECT_EQ(estimator.estimate(AWPolyElement(Vector(2, 1.0), (double)k))[0], 0.0);
+	EXPECT_NEAR(estimator.estimate(AWPolyElement(Vector(2, 1.0), 3.0))[0], 0.0, 1e-12);
+}
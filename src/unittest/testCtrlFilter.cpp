@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include <yarp/sig/Vector.h>
+
+#include <iCub/ctrl/filters.h>
+
+#include "allocationCounter.h"
+#include "gtest/gtest.h"
+#include "randomData.h"
+#include "referenceFilters.h"
+
+using namespace yarp::sig;
+using namespace iCub::ctrl;
+using namespace referenceFilters;
+
+namespace
+{
+// the former median filter, sorting a copy of each window; for even
+// windows the lower middle element is searched in the lower half only,
+// since partitioning the whole window again may move the upper one
+class DequeMedianFilter
+{
+	std::deque<std::deque<double>> uold;
+	Vector y;
+	size_t n;
+
+	static double median(std::deque<double> &v)
+	{
+		size_t L = v.size() >> 1;
+		std::nth_element(v.begin(), v.begin() + L, v.end());
+		if (v.size() & 0x01)
+			return v[L];
+		std::nth_element(v.begin(), v.begin() + L - 1, v.begin() + L);
+		return 0.5 * (v[L] + v[L - 1]);
+	}
+
+public:
+	DequeMedianFilter(const size_t n, const Vector &y0) : uold(y0.length()), y(y0), n(n) {}
+
+	const Vector &filt(const Vector &u)
+	{
+		for (size_t i = 0; i < y.length(); i++)
+			uold[i].push_front(u[i]);
+		if (uold[0].size() > n)
+		{
+			for (size_t i = 0; i < y.length(); i++)
+			{
+				std::deque<double> tmp = uold[i];
+				y[i] = median(tmp);
+				uold[i].pop_back();
+			}
+		}
+		return y;
+	}
+};
+
+std::vector<Vector> randomInputs(const size_t channels, const size_t samples)
+{
+	randomData::Generator gen;
+	std::vector<Vector> inputs;
+	for (size_t k = 0; k < samples; k++)
+		inputs.push_back(gen.uniformVector(channels, -1.0, 1.0));
+	return inputs;
+}
+
+void compareWithDequeFilter(const size_t channels)
+{
+	Vector num, den;
+	butterworth(num, den);
+	Vector y0(channels, 0.0);
+
+	const size_t n = 2000;
+	std::vector<Vector> inputs = randomInputs(channels, n);
+
+	DequeFilter reference(num, den, y0);
+	Filter filter(num, den, y0);
+	for (size_t k = 0; k < 1000; k++)
+	{
+		const Vector &y_ref = reference.filt(inputs[k]);
+		const Vector &y = filter.filt(inputs[k]);
+		for (size_t j = 0; j < channels; j++)
+			ASSERT_EQ(y_ref[j], y[j]) << channels << " channels, sample " << k << ", channel " << j;
+	}
+
+	std::deque<Vector> u_states, y_states;
+	filter.getStates(u_states, y_states);
+	ASSERT_EQ(u_states.size(), reference.getInputStates().size());
+	ASSERT_EQ(y_states.size(), reference.getOutputStates().size());
+	for (size_t i = 0; i < u_states.size(); i++)
+		for (size_t j = 0; j < channels; j++)
+			EXPECT_EQ(u_states[i][j], reference.getInputStates()[i][j]);
+	for (size_t i = 0; i < y_states.size(); i++)
+		for (size_t j = 0; j < channels; j++)
+			EXPECT_EQ(y_states[i][j], reference.getOutputStates()[i][j]);
+
+	// no heap allocation in filt()
+	allocationCounter::count = 0;
+	allocationCounter::enabled = true;
+	for (size_t k = 1000; k < n; k++)
+		filter.filt(inputs[k]);
+	allocationCounter::enabled = false;
+
+	EXPECT_EQ(allocationCounter::count.load(), (size_t)0) << channels << " channels: heap allocations in filt()";
+}
+}  // namespace
+
+TEST(ctrlFilter, circular_vs_deque_6_001)
+{
+	compareWithDequeFilter(6);
+}
+
+TEST(ctrlFilter, circular_vs_deque_16_001)
+{
+	compareWithDequeFilter(16);
+}
+
+TEST(ctrlFilter, circular_vs_deque_64_001)
+{
+	compareWithDequeFilter(64);
+}
+
+TEST(ctrlFilter, init_and_set_coeffs_001)
+{
+	Vector num, den;
+	butterworth(num, den);
+	Vector y0(3, 2.0);
+
+	// a unity-gain filter initialized at y0 stays there for a constant input equal to y0
+	Filter filter(num, den, y0);
+	for (int k = 0; k < 10; k++)
+	{
+		const Vector &y = filter.filt(y0);
+		for (size_t j = 0; j < y.length(); j++)
+			EXPECT_NEAR(y[j], 2.0, 1e-9);
+	}
+
+	// changing the order resets the histories
+	Vector num2(2, 0.5), den2(1, 1.0);
+	filter.setCoeffs(num2, den2);
+	std::deque<Vector> u_states, y_states;
+	filter.getStates(u_states, y_states);
+	EXPECT_EQ(u_states.size(), (size_t)1);
+	EXPECT_EQ(y_states.size(), (size_t)0);
+
+	Vector u(3, 1.0);
+	filter.filt(u);
+	const Vector &y = filter.filt(u);
+	for (size_t j = 0; j < y.length(); j++)
+		EXPECT_DOUBLE_EQ(y[j], 1.0);
+}
+
+TEST(ctrlFilter, median_vs_deque_001)
+{
+	// coarse values to exercise ties in the windows
+	randomData::Generator gen(1);
+	const size_t channels = 6;
+	std::vector<Vector> inputs(2000, Vector(channels));
+	for (auto &u : inputs)
+		for (size_t j = 0; j < channels; j++)
+			u[j] = 0.25 * gen.uniformInt(-20, 20);
+	// spikes
+	for (size_t k = 0; k < inputs.size(); k += 37)
+		inputs[k][k % channels] = 1e3;
+
+	for (size_t order : {0, 1, 2, 3, 4, 7, 10, 31, 64})
+	{
+		Vector y0(channels, -1.0);
+		DequeMedianFilter reference(order, y0);
+		MedianFilter filter(order, y0);
+		for (size_t k = 0; k < inputs.size(); k++)
+		{
+			const Vector &y_ref = reference.filt(inputs[k]);
+			const Vector &y = filter.filt(inputs[k]);
+			for (size_t j = 0; j < channels; j++)
+				ASSERT_EQ(y_ref[j], y[j]) << "order " << order << ", sample " << k << ", channel " << j;
+		}
+	}
+}
+
+TEST(ctrlFilter, median_even_window_001)
+{
+	MedianFilter filter(3, Vector(1, 0.0));
+	for (double u : {4.0, 1.0, 3.0})
+		filter.filt(Vector(1, u));
+	EXPECT_EQ(filter.filt(Vector(1, 2.0))[0], 2.5);
+	EXPECT_EQ(filter.filt(Vector(1, 10.0))[0], 2.5);
+	EXPECT_EQ(filter.filt(Vector(1, 10.0))[0], 6.5);
+}
+
+TEST(ctrlFilter, median_set_order_001)
+{
+	std::vector<Vector> inputs = randomInputs(16, 5000);
+	Vector y0(16, 0.0);
+	MedianFilter filter(5, y0);
+	for (size_t k = 0; k < 100; k++)
+		filter.filt(inputs[k]);
+
+	// the window is emptied: the output is held until it fills up again
+	filter.setOrder(24);
+	EXPECT_EQ(filter.getOrder(), (size_t)24);
+	DequeMedianFilter reference(24, filter.output());
+	for (size_t k = 100; k < inputs.size(); k++)
+	{
+		const Vector &y_ref = reference.filt(inputs[k]);
+		const Vector &y = filter.filt(inputs[k]);
+		for (size_t j = 0; j < 16; j++)
+			ASSERT_EQ(y_ref[j], y[j]) << "sample " << k << ", channel " << j;
+	}
+}
+
+TEST(ctrlFilter, median_no_allocations_001)
+{
+	const size_t channels = 16, n = 2000;
+	std::vector<Vector> inputs = randomInputs(channels, n);
+	Vector y0(channels, 0.0);
+
+	for (size_t order : {4, 50})
+	{
+		MedianFilter filter(order, y0);
+
+		allocationCounter::count = 0;
+		allocationCounter::enabled = true;
+		for (size_t k = 0; k < n; k++)
+			filter.filt(inputs[k]);
+		allocationCounter::enabled = false;
+
+		EXPECT_EQ(allocationCounter::count.load(), (size_t)0) << "order " << order << ": heap allocations in filt()";
+	}
+}
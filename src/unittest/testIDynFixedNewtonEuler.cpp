@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <string>
+
+#include <yarp/sig/Matrix.h>
+#include <yarp/sig/Vector.h>
+
+#include <iCub/iDyn/iDyn.h>
+#include <iCub/iDyn/iDynInv.h>
+
+#include "allocationCounter.h"
+#include "gtest/gtest.h"
+#include "randomData.h"
+
+using namespace yarp::sig;
+using namespace iCub::iDyn;
+
+namespace
+{
+void setRandomState(iDynChain &chain, randomData::Generator &gen)
+{
+	chain.setAng(gen.configuration(chain));
+	chain.setDAng(gen.uniformVector(chain.getDOF(), -1.0, 1.0));
+	chain.setD2Ang(gen.uniformVector(chain.getDOF(), -1.0, 1.0));
+}
+
+void compareWithClassicPath(iDynChain &chain, const std::string &name, const NewEulMode mode)
+{
+	chain.prepareNewtonEuler(mode);
+
+	Vector w0(3, 0.0), dw0(3, 0.0), ddp0(3, 0.0), Fend(3, 0.0), Muend(3, 0.0);
+	ddp0[2] = 9.81;
+	Fend[0] = 1.0; Fend[1] = -2.0; Fend[2] = 0.5;
+	Muend[0] = 0.1; Muend[1] = 0.2; Muend[2] = -0.3;
+
+	randomData::Generator gen;
+	for (int k = 0; k < 100; k++)
+	{
+		setRandomState(chain, gen);
+		w0[0] = 0.01 * k; dw0[1] = -0.02 * k;
+
+		chain.setFixedSizeNewtonEuler(false);
+		ASSERT_TRUE(chain.computeNewtonEuler(w0, dw0, ddp0, Fend, Muend));
+		Vector tau_classic = chain.getTorquesNewtonEuler();
+		Matrix F_classic = chain.getForcesNewtonEuler();
+		Matrix Mu_classic = chain.getMomentsNewtonEuler();
+
+		chain.setFixedSizeNewtonEuler(true);
+		ASSERT_TRUE(chain.computeNewtonEuler(w0, dw0, ddp0, Fend, Muend));
+		Vector tau_fixed = chain.getTorquesNewtonEuler();
+		Matrix F_fixed = chain.getForcesNewtonEuler();
+		Matrix Mu_fixed = chain.getMomentsNewtonEuler();
+
+		for (size_t i = 0; i < tau_classic.length(); i++)
+			EXPECT_NEAR(tau_classic[i], tau_fixed[i], 1e-9) << name << " torque " << i;
+
+		for (size_t r = 0; r < F_classic.rows(); r++)
+		{
+			for (size_t c = 0; c < F_classic.cols(); c++)
+			{
+				EXPECT_NEAR(F_classic(r, c), F_fixed(r, c), 1e-9) << name << " force " << c;
+				EXPECT_NEAR(Mu_classic(r, c), Mu_fixed(r, c), 1e-9) << name << " moment " << c;
+			}
+		}
+	}
+
+	// no heap allocation once the base/end values are initialized
+	chain.initNewtonEuler(w0, dw0, ddp0, Fend, Muend);
+	chain.setFixedSizeNewtonEuler(true);
+	chain.computeNewtonEuler();
+	allocationCounter::count = 0;
+	allocationCounter::enabled = true;
+	for (int i = 0; i < 100; i++)
+		chain.computeNewtonEuler();
+	allocationCounter::enabled = false;
+
+	EXPECT_EQ(allocationCounter::count.load(), (size_t)0) << name << ": heap allocations in the fixed-size path";
+}
+}  // namespace
+
+TEST(iDynFixedNewtonEuler, arm_fixed_vs_classic_001)
+{
+	iCubArmDyn arm("right");
+	compareWithClassicPath(arm, "iCubArmDyn", DYNAMIC);
+	compareWithClassicPath(arm, "iCubArmDyn", DYNAMIC_CORIOLIS_GRAVITY);
+	compareWithClassicPath(arm, "iCubArmDyn", STATIC);
+}
+
+TEST(iDynFixedNewtonEuler, leg_fixed_vs_classic_001)
+{
+	iCubLegDyn leg("left");
+	compareWithClassicPath(leg, "iCubLegDyn", DYNAMIC);
+	compareWithClassicPath(leg, "iCubLegDyn", DYNAMIC_CORIOLIS_GRAVITY);
+	compareWithClassicPath(leg, "iCubLegDyn", STATIC);
+}
+
+TEST(iDynFixedNewtonEuler, rotor_mode_falls_back_001)
+{
+	iCubArmDyn arm("left");
+	arm.prepareNewtonEuler(DYNAMIC_W_ROTOR);
+	arm.initNewtonEuler();
+	EXPECT_TRUE(arm.getFixedSizeNewtonEuler());
+	EXPECT_TRUE(arm.computeNewtonEuler());
+}
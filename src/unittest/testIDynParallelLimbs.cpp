@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <string>
+
+#include <yarp/sig/Matrix.h>
+#include <yarp/sig/Vector.h>
+
+#include <iCub/iDyn/iDyn.h>
+#include <iCub/iDyn/iDynBody.h>
+
+#include "gtest/gtest.h"
+#include "randomData.h"
+
+using namespace yarp::sig;
+using namespace iCub::iDyn;
+
+namespace
+{
+const std::string upperLimbs[] = {"head", "left_arm", "right_arm"};
+const std::string lowerLimbs[] = {"torso", "left_leg", "right_leg"};
+
+void setRandomState(iDynSensorTorsoNode &node, const std::string &limb, randomData::Generator &gen)
+{
+	const unsigned int n = node.getNLinks(limb);
+	node.setAng(limb, gen.uniformVector(n, -0.5, 0.5));
+	node.setDAng(limb, gen.uniformVector(n, -1.0, 1.0));
+	node.setD2Ang(limb, gen.uniformVector(n, -1.0, 1.0));
+}
+
+// same sequence as the inverseDynamics thread of wholeBodyDynamics
+void solve(iCubWholeBody &body, const unsigned int seed)
+{
+	randomData::Generator gen(seed);
+	for (const std::string &limb : upperLimbs)
+		setRandomState(*body.upperTorso, limb, gen);
+	for (const std::string &limb : lowerLimbs)
+		setRandomState(*body.lowerTorso, limb, gen);
+
+	Vector w0 = gen.uniformVector(3, -0.5, 0.5);
+	Vector dw0 = gen.uniformVector(3, -0.5, 0.5);
+	Vector ddp0 = gen.uniformVector(3, -1.0, 1.0);
+	ddp0[2] += 9.81;
+	Vector F_RArm = gen.uniformVector(6, -2.0, 2.0);
+	Vector F_LArm = gen.uniformVector(6, -2.0, 2.0);
+	Vector F_up(6, 0.0);
+	Vector F_RLeg = gen.uniformVector(6, -10.0, 10.0);
+	Vector F_LLeg = gen.uniformVector(6, -10.0, 10.0);
+
+	body.upperTorso->setInertialMeasure(w0, dw0, ddp0);
+	body.upperTorso->setSensorMeasurement(F_RArm, F_LArm, F_up);
+	ASSERT_TRUE(body.upperTorso->solveKinematics());
+	ASSERT_TRUE(body.upperTorso->solveWrench());
+
+	body.attachLowerTorso(F_RLeg, F_LLeg);
+	ASSERT_TRUE(body.lowerTorso->solveKinematics());
+	ASSERT_TRUE(body.lowerTorso->solveWrench());
+}
+
+void expectEqual(const Vector &a, const Vector &b, const std::string &what)
+{
+	ASSERT_EQ(a.size(), b.size()) << what;
+	for (size_t i = 0; i < a.size(); i++)
+		EXPECT_EQ(a[i], b[i]) << what << " [" << i << "]";
+}
+
+void expectEqual(const Matrix &a, const Matrix &b, const std::string &what)
+{
+	ASSERT_EQ(a.rows(), b.rows()) << what;
+	ASSERT_EQ(a.cols(), b.cols()) << what;
+	for (size_t r = 0; r < a.rows(); r++)
+		for (size_t c = 0; c < a.cols(); c++)
+			EXPECT_EQ(a(r, c), b(r, c)) << what << " (" << r << "," << c << ")";
+}
+
+void expectSameLimb(iDynLimb *a, iDynLimb *b, const std::string &name)
+{
+	for (unsigned int i = 0; i < a->getN(); i++)
+	{
+		const std::string link = name + " link " + std::to_string(i);
+		expectEqual(a->getAngVel(i), b->getAngVel(i), link + " angular velocity");
+		expectEqual(a->getAngAcc(i), b->getAngAcc(i), link + " angular acceleration");
+		expectEqual(a->getLinAcc(i), b->getLinAcc(i), link + " linear acceleration");
+	}
+	expectEqual(a->getForces(), b->getForces(), name + " forces");
+	expectEqual(a->getMoments(), b->getMoments(), name + " moments");
+	expectEqual(a->getTorques(), b->getTorques(), name + " torques");
+}
+
+void expectSameNode(iDynSensorTorsoNode &a, iDynSensorTorsoNode &b, const std::string &name)
+{
+	expectEqual(a.getTorsoForce(), b.getTorsoForce(), name + " force");
+	expectEqual(a.getTorsoMoment(), b.getTorsoMoment(), name + " moment");
+	expectEqual(a.getTorsoAngVel(), b.getTorsoAngVel(), name + " angular velocity");
+	expectEqual(a.getTorsoAngAcc(), b.getTorsoAngAcc(), name + " angular acceleration");
+	expectEqual(a.getTorsoLinAcc(), b.getTorsoLinAcc(), name + " linear acceleration");
+	expectSameLimb(a.up, b.up, name + " " + a.up_name);
+	expectSameLimb(a.left, b.left, name + " " + a.left_name);
+	expectSameLimb(a.right, b.right, name + " " + a.right_name);
+}
+}  // namespace
+
+TEST(iDynParallelLimbs, pool_on_vs_off_001)
+{
+	version_tag tag;
+	iCubWholeBody serial(tag, DYNAMIC, iCub::skinDynLib::NO_VERBOSE);
+	iCubWholeBody parallel(tag, DYNAMIC, iCub::skinDynLib::NO_VERBOSE);
+	parallel.upperTorso->setParallelLimbs(4);
+	parallel.lowerTorso->setParallelLimbs(4);
+	ASSERT_EQ(serial.upperTorso->getParallelLimbs(), 1u);
+	ASSERT_EQ(parallel.upperTorso->getParallelLimbs(), 4u);
+
+	// the pool is reused across calls, the node wrench is summed in the order of the limbs
+	for (unsigned int k = 0; k < 50; k++)
+	{
+		solve(serial, k);
+		solve(parallel, k);
+		expectSameNode(*serial.upperTorso, *parallel.upperTorso, "upper torso");
+		expectSameNode(*serial.lowerTorso, *parallel.lowerTorso, "lower torso");
+		if (HasFailure())
+			FAIL() << "step " << k;
+	}
+
+	// back to serial computation
+	parallel.upperTorso->setParallelLimbs(0);
+	parallel.lowerTorso->setParallelLimbs(1);
+	EXPECT_EQ(parallel.upperTorso->getParallelLimbs(), 1u);
+	solve(serial, 100);
+	solve(parallel, 100);
+	expectSameNode(*serial.upperTorso, *parallel.upperTorso, "upper torso");
+	expectSameNode(*serial.lowerTorso, *parallel.lowerTorso, "lower torso");
+}
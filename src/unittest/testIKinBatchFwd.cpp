@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <string>
+
+#include <yarp/sig/Matrix.h>
+#include <yarp/sig/Vector.h>
+
+#include <iCub/iKin/iKinFwd.h>
+
+#include "gtest/gtest.h"
+#include "randomData.h"
+
+using namespace yarp::sig;
+using namespace iCub::iKin;
+
+namespace
+{
+void compareWithScalarPath(iKinChain &chain, const std::string &name)
+{
+	const size_t n = 2000;
+	Matrix Q = randomData::Generator().configurations(chain, n);
+
+	// scalar path
+	Matrix P_scalar(7, n);
+	Matrix J_scalar(6 * chain.getDOF(), n);
+	for (size_t i = 0; i < n; i++)
+	{
+		Vector p = chain.EndEffPose(Q.getRow(i));
+		Matrix J = chain.GeoJacobian();
+		P_scalar.setCol(i, p);
+		for (int r = 0; r < 6; r++)
+			for (unsigned int c = 0; c < chain.getDOF(); c++)
+				J_scalar(r * chain.getDOF() + c, i) = J(r, c);
+	}
+
+	// batch path
+	Matrix P_batch, J_batch;
+	ASSERT_TRUE(chain.EndEffPoseBatch(Q, P_batch, J_batch));
+
+	Matrix P_mt, J_mt;
+	ASSERT_TRUE(chain.EndEffPoseBatch(Q, P_mt, J_mt, true, 4));
+
+	for (size_t r = 0; r < P_scalar.rows(); r++)
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			EXPECT_NEAR(P_scalar(r, i), P_batch(r, i), 1e-9) << name << " pose " << i;
+			EXPECT_EQ(P_batch(r, i), P_mt(r, i)) << name << " pose " << i;
+		}
+	}
+
+	for (size_t r = 0; r < J_scalar.rows(); r++)
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			EXPECT_NEAR(J_scalar(r, i), J_batch(r, i), 1e-9) << name << " Jacobian " << i;
+			EXPECT_EQ(J_batch(r, i), J_mt(r, i)) << name << " Jacobian " << i;
+		}
+	}
+}
+}  // namespace
+
+TEST(iKinBatchFwd, arm_batch_vs_scalar_001)
+{
+	iCubArm arm("right_v2");
+	arm.releaseLink(0);
+	arm.releaseLink(1);
+	arm.releaseLink(2);
+	compareWithScalarPath(arm, "iCubArm");
+}
+
+TEST(iKinBatchFwd, eye_batch_vs_scalar_001)
+{
+	iCubEye eye("left_v2");
+	compareWithScalarPath(eye, "iCubEye");
+}
+
+TEST(iKinBatchFwd, wrong_size_negative_001)
+{
+	iCubArm arm("right_v2");
+	Matrix Q(10, arm.getDOF() + 1), P;
+	EXPECT_FALSE(arm.EndEffPoseBatch(Q, P));
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <cmath>
+
+#include <yarp/sig/Matrix.h>
+#include <yarp/sig/Vector.h>
+
+#include <iCub/learningMachine/LSSVMLearner.h>
+
+#include "gtest/gtest.h"
+#include "randomData.h"
+
+using namespace yarp::sig;
+using namespace iCub::learningmachine;
+
+namespace
+{
+// noisy smooth mapping with cod outputs
+void randomDataset(const size_t n, const size_t dom, const size_t cod, Matrix &X, Matrix &Y)
+{
+	randomData::Generator gen;
+	X = gen.uniformMatrix(n, dom, -1.0, 1.0);
+	Y.resize(n, cod);
+	for (size_t k = 0; k < n; k++)
+	{
+		double sum = 0.0;
+		for (size_t j = 0; j < dom; j++)
+			sum += X(k, j);
+		for (size_t i = 0; i < cod; i++)
+			Y(k, i) = std::sin((i + 1) * sum) + gen.normal(0.0, 0.05);
+	}
+}
+
+LSSVMLearner makeLearner(const size_t dom, const size_t cod, const bool online)
+{
+	LSSVMLearner lssvm(dom, cod, 10.0);
+	lssvm.getKernel()->setGamma(2.0);
+	lssvm.setOnline(online);
+	return lssvm;
+}
+
+void expectSamePredictions(LSSVMLearner &a, LSSVMLearner &b, const Matrix &X, const size_t cod)
+{
+	for (size_t k = 0; k < X.rows(); k++)
+	{
+		Vector y_a = a.predict(X.getRow(k)).getPrediction();
+		Vector y_b = b.predict(X.getRow(k)).getPrediction();
+		ASSERT_EQ(y_a.size(), cod);
+		ASSERT_EQ(y_b.size(), cod);
+		for (size_t i = 0; i < cod; i++)
+			EXPECT_NEAR(y_a[i], y_b[i], 1e-8) << "sample " << k << ", output " << i;
+	}
+}
+}  // namespace
+
+TEST(learningMachineLSSVM, online_vs_batch_001)
+{
+	const size_t dom = 4, cod = 2, n = 600, every = 25;
+	Matrix X, Y;
+	randomDataset(n, dom, cod, X, Y);
+
+	// retraining from scratch every few samples
+	LSSVMLearner batch = makeLearner(dom, cod, false);
+	for (size_t k = 0; k < n; k++)
+	{
+		batch.feedSample(X.getRow(k), Y.getRow(k));
+		if ((k % every) == every - 1)
+		{
+			batch.train();
+			batch.predict(X.getRow(k));
+		}
+	}
+
+	// bordered updates, predicting at the same pace
+	LSSVMLearner online = makeLearner(dom, cod, true);
+	for (size_t k = 0; k < n; k++)
+	{
+		online.feedSample(X.getRow(k), Y.getRow(k));
+		if ((k % every) == every - 1)
+			online.predict(X.getRow(k));
+	}
+
+	Matrix Xtest, Ytest;
+	randomDataset(100, dom, cod, Xtest, Ytest);
+	expectSamePredictions(batch, online, Xtest, cod);
+
+	// training an online machine only solves what is still pending
+	online.train();
+	expectSamePredictions(batch, online, Xtest, cod);
+}
+
+TEST(learningMachineLSSVM, budget_drops_oldest_001)
+{
+	const size_t dom = 3, cod = 2, n = 400, budget = 150;
+	Matrix X, Y;
+	randomDataset(n, dom, cod, X, Y);
+
+	LSSVMLearner online = makeLearner(dom, cod, true);
+	online.setBudget(budget);
+	for (size_t k = 0; k < n; k++)
+		online.feedSample(X.getRow(k), Y.getRow(k));
+
+	// a batch machine trained on the most recent samples only
+	LSSVMLearner batch = makeLearner(dom, cod, false);
+	for (size_t k = n - budget; k < n; k++)
+		batch.feedSample(X.getRow(k), Y.getRow(k));
+	batch.train();
+
+	expectSamePredictions(batch, online, X, cod);
+
+	// a change of the hyperparameters recomputes the inverse
+	online.setC(2.0);
+	batch.setC(2.0);
+	batch.train();
+	expectSamePredictions(batch, online, X, cod);
+
+	// shrinking the budget drops the oldest samples right away
+	online.setBudget(50);
+	LSSVMLearner recent = makeLearner(dom, cod, false);
+	recent.setC(2.0);
+	for (size_t k = n - 50; k < n; k++)
+		recent.feedSample(X.getRow(k), Y.getRow(k));
+	recent.train();
+	expectSamePredictions(recent, online, X, cod);
+}
+
+TEST(learningMachineLSSVM, switch_to_online_001)
+{
+	const size_t dom = 2, cod = 1, n = 200;
+	Matrix X, Y;
+	randomDataset(n, dom, cod, X, Y);
+
+	LSSVMLearner batch = makeLearner(dom, cod, false);
+	LSSVMLearner late = makeLearner(dom, cod, false);
+	for (size_t k = 0; k < n; k++)
+	{
+		batch.feedSample(X.getRow(k), Y.getRow(k));
+		late.feedSample(X.getRow(k), Y.getRow(k));
+	}
+	batch.train();
+
+	// enabling online learning factorizes the collected samples, copies keep it
+	late.setOnline(true);
+	LSSVMLearner copy(late);
+	expectSamePredictions(batch, copy, X, cod);
+	EXPECT_TRUE(copy.getOnline());
+
+	// back to batch mode the last solution is kept
+	copy.setOnline(false);
+	expectSamePredictions(batch, copy, X, cod);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <yarp/sig/Matrix.h>
+#include <yarp/sig/Vector.h>
+
+#include <iCub/learningMachine/RLSLearner.h>
+
+#include "gtest/gtest.h"
+#include "randomData.h"
+
+using namespace yarp::sig;
+using namespace iCub::learningmachine;
+
+namespace
+{
+// noisy linear mapping with cod outputs
+void randomDataset(const size_t n, const size_t dom, const size_t cod, Matrix &X, Matrix &Y)
+{
+	randomData::Generator gen;
+	Matrix A = gen.normalMatrix(cod, dom);
+	X = gen.normalMatrix(n, dom);
+	Y.resize(n, cod);
+	for (size_t k = 0; k < n; k++)
+	{
+		for (size_t i = 0; i < cod; i++)
+		{
+			double y = gen.normal(0.0, 0.1);
+			for (size_t j = 0; j < dom; j++)
+				y += A(i, j) * X(k, j);
+			Y(k, i) = y;
+		}
+	}
+}
+
+void compareWithSampleWise(const size_t dom, const size_t batch)
+{
+	const size_t cod = 3, n = 2000;
+	Matrix X, Y;
+	randomDataset(n, dom, cod, X, Y);
+
+	// sample-wise feeding, predicting every 100 samples
+	RLSLearner single(dom, cod, 1.0);
+	for (size_t k = 0; k < n; k++)
+	{
+		single.feedSample(X.getRow(k), Y.getRow(k));
+		if ((k % 100) == 99)
+			single.predict(X.getRow(k));
+	}
+
+	// batches of rank-k updates, predicting at the same pace
+	RLSLearner batched(dom, cod, 1.0);
+	for (size_t k = 0; k < n; k += batch)
+	{
+		size_t last = std::min(k + batch, n) - 1;
+		batched.feedSamples(X.submatrix(k, last, 0, dom - 1), Y.submatrix(k, last, 0, cod - 1));
+		if (((last + 1) / 100) != (k / 100))
+			batched.predict(X.getRow(last));
+	}
+
+	for (size_t k = 0; k < 50; k++)
+	{
+		Vector y_single = single.predict(X.getRow(k)).getPrediction();
+		Vector y_batched = batched.predict(X.getRow(k)).getPrediction();
+		for (size_t i = 0; i < cod; i++)
+			EXPECT_NEAR(y_single[i], y_batched[i], 1e-8 * std::max(1.0, std::fabs(y_single[i])))
+				<< "dom " << dom << ", batch " << batch << ", sample " << k << ", output " << i;
+	}
+}
+}  // namespace
+
+TEST(learningMachineRLS, batched_vs_sample_wise_001)
+{
+	compareWithSampleWise(10, 1);
+	compareWithSampleWise(10, 7);
+	compareWithSampleWise(100, 50);
+	compareWithSampleWise(300, 100);
+}
+
+TEST(learningMachineRLS, batch_size_mismatch_negative_001)
+{
+	RLSLearner rls(4, 2, 1.0);
+	EXPECT_THROW(rls.feedSamples(Matrix(3, 4), Matrix(2, 2)), std::runtime_error);
+	EXPECT_THROW(rls.feedSamples(Matrix(3, 5), Matrix(3, 2)), std::runtime_error);
+	EXPECT_THROW(rls.feedSamples(Matrix(3, 4), Matrix(3, 1)), std::runtime_error);
+}
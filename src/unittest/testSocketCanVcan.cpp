@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <net/if.h>
+#include <string.h>
+
+#include <vector>
+
+#include <yarp/os/Property.h>
+#include <yarp/os/Value.h>
+#include <yarp/os/Time.h>
+
+#include "SocketCan.h"
+
+#include "gtest/gtest.h"
+
+using namespace yarp::os;
+using namespace yarp::dev;
+
+namespace
+{
+const char *vcanName = "vcan0";
+
+bool openOnVcan(SocketCan &bus, bool timestamps = false)
+{
+	Property config;
+	config.put("canDeviceName", vcanName);
+	config.put("canTimestamps", Value(timestamps));
+	return bus.open(config);
+}
+
+std::vector<unsigned int> readIds(SocketCan &bus, CanBuffer &buffer, unsigned int size, unsigned int expected)
+{
+	// frames travel through the kernel loopback: give them some time
+	std::vector<unsigned int> ids;
+	for (int attempt = 0; (attempt < 100) && (ids.size() < expected); attempt++)
+	{
+		unsigned int read = 0;
+		EXPECT_TRUE(bus.canRead(buffer, size, &read));
+		for (unsigned int i = 0; i < read; i++)
+			ids.push_back(buffer[i].getId());
+		if (ids.size() < expected)
+			Time::delay(0.001);
+	}
+	return ids;
+}
+
+// registrations are installed by the next read
+void installFilters(SocketCan &bus, CanBuffer &buffer, unsigned int size)
+{
+	unsigned int read = 0;
+	EXPECT_TRUE(bus.canRead(buffer, size, &read));
+}
+}  // namespace
+
+TEST(SocketCanVcan, batched_write_read_001)
+{
+	if (if_nametoindex(vcanName) == 0)
+		GTEST_SKIP() << vcanName << " not available";
+
+	SocketCan tx, rx;
+	ASSERT_TRUE(openOnVcan(tx));
+	ASSERT_TRUE(openOnVcan(rx, true));
+
+	const unsigned int n = 300;  // more than one recvmmsg()/sendmmsg() batch
+	CanBuffer out = tx.createBuffer(n);
+	CanBuffer in = rx.createBuffer(n);
+	for (unsigned int i = 0; i < n; i++)
+	{
+		out[i].setId(0x100 + (i % 16));
+		out[i].setLen(8);
+		for (int j = 0; j < 8; j++)
+			out[i].getData()[j] = (unsigned char)(i + j);
+	}
+
+	unsigned int sent = 0;
+	ASSERT_TRUE(tx.canWrite(out, n, &sent));
+	EXPECT_EQ(sent, n);
+
+	unsigned int read = 0;
+	for (int attempt = 0; (attempt < 100) && (read < n); attempt++)
+	{
+		unsigned int r = 0;
+		ASSERT_TRUE(rx.canRead(in, n - read, &r));
+		for (unsigned int i = 0; i < r; i++)
+		{
+			EXPECT_EQ(in[i].getId(), out[read + i].getId());
+			EXPECT_EQ(in[i].getLen(), 8);
+			EXPECT_EQ(memcmp(in[i].getData(), out[read + i].getData(), 8), 0);
+			EXPECT_GT(rx.getRxTimestamp(i), 0.0);
+		}
+		read += r;
+		if (read < n)
+			Time::delay(0.001);
+	}
+	EXPECT_EQ(read, n);
+
+	tx.destroyBuffer(out);
+	rx.destroyBuffer(in);
+	EXPECT_TRUE(tx.close());
+	EXPECT_TRUE(rx.close());
+}
+
+TEST(SocketCanVcan, kernel_filters_001)
+{
+	if (if_nametoindex(vcanName) == 0)
+		GTEST_SKIP() << vcanName << " not available";
+
+	SocketCan tx, rx;
+	ASSERT_TRUE(openOnVcan(tx));
+	ASSERT_TRUE(openOnVcan(rx));
+	ASSERT_TRUE(rx.canIdAdd(0x101));
+	ASSERT_TRUE(rx.canIdAdd(0x103));
+
+	const unsigned int n = 8;
+	CanBuffer out = tx.createBuffer(n);
+	CanBuffer in = rx.createBuffer(n);
+	installFilters(rx, in, n);
+	for (unsigned int i = 0; i < n; i++)
+	{
+		out[i].setId(0x100 + i);
+		out[i].setLen(1);
+		out[i].getData()[0] = (unsigned char)i;
+	}
+
+	unsigned int sent = 0;
+	ASSERT_TRUE(tx.canWrite(out, n, &sent));
+	EXPECT_EQ(sent, n);
+
+	std::vector<unsigned int> ids = readIds(rx, in, n, 2);
+	ASSERT_EQ(ids.size(), 2u);
+	EXPECT_EQ(ids[0], 0x101u);
+	EXPECT_EQ(ids[1], 0x103u);
+
+	// nothing else got through the filters
+	Time::delay(0.01);
+	unsigned int extra = 0;
+	EXPECT_TRUE(rx.canRead(in, n, &extra));
+	EXPECT_EQ(extra, 0u);
+
+	// with no registered ids every frame is accepted again
+	ASSERT_TRUE(rx.canIdDelete(0x101));
+	ASSERT_TRUE(rx.canIdDelete(0x103));
+	installFilters(rx, in, n);
+	ASSERT_TRUE(tx.canWrite(out, n, &sent));
+	EXPECT_EQ(readIds(rx, in, n, n).size(), n);
+
+	tx.destroyBuffer(out);
+	rx.destroyBuffer(in);
+	EXPECT_TRUE(tx.close());
+	EXPECT_TRUE(rx.close());
+}
+
+TEST(SocketCanVcan, kernel_filter_ranges_001)
+{
+	if (if_nametoindex(vcanName) == 0)
+		GTEST_SKIP() << vcanName << " not available";
+
+	SocketCan tx, rx;
+	ASSERT_TRUE(openOnVcan(tx));
+	ASSERT_TRUE(openOnVcan(rx));
+
+	// more ids than CAN_RAW_FILTER_MAX, merged into a few mask filters
+	for (unsigned int id = 0x000; id < 0x3fc; id++)
+		ASSERT_TRUE(rx.canIdAdd(id));
+	ASSERT_TRUE(rx.canIdAdd(0x500));
+
+	const unsigned int ids_out[] = {0x3fa, 0x3fb, 0x3fc, 0x4ff, 0x500, 0x501};
+	const unsigned int n = sizeof(ids_out) / sizeof(ids_out[0]);
+	CanBuffer out = tx.createBuffer(n);
+	CanBuffer in = rx.createBuffer(n);
+	installFilters(rx, in, n);
+	for (unsigned int i = 0; i < n; i++)
+	{
+		out[i].setId(ids_out[i]);
+		out[i].setLen(0);
+	}
+
+	unsigned int sent = 0;
+	ASSERT_TRUE(tx.canWrite(out, n, &sent));
+	EXPECT_EQ(sent, n);
+
+	std::vector<unsigned int> ids = readIds(rx, in, n, 3);
+	ASSERT_EQ(ids.size(), 3u);
+	EXPECT_EQ(ids[0], 0x3fau);
+	EXPECT_EQ(ids[1], 0x3fbu);
+	EXPECT_EQ(ids[2], 0x500u);
+
+	Time::delay(0.01);
+	unsigned int extra = 0;
+	EXPECT_TRUE(rx.canRead(in, n, &extra));
+	EXPECT_EQ(extra, 0u);
+
+	tx.destroyBuffer(out);
+	rx.destroyBuffer(in);
+	EXPECT_TRUE(tx.close());
+	EXPECT_TRUE(rx.close());
+}